@@ -0,0 +1,223 @@
+#include "batchcheck.h"
+#include "spellchecker.h"
+#include "fileio.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BATCH_FILES_PER_RUN 64   // Files mapped and checked per thread-pool run
+
+typedef struct {
+    char path[MAX_PATH];
+    HANDLE file;
+    HANDLE mapping;
+    const char *view;
+    DWORD size;
+} MappedLog;
+
+typedef struct {
+    int jobs;
+    BOOL suggestions;
+    FILE *out;
+    BOOL failed;     // Some pattern or file could not be processed
+    BOOL found;      // At least one misspelling was reported
+} BatchOptions;
+
+// Expand one pattern; FindFirstFile only matches wildcards in the last
+// component, so the directory part is carried over to each result
+static BOOL ExpandPattern(PathList *list, const char *pattern) {
+    const char *slash = strrchr(pattern, '\\');
+    const char *forward = strrchr(pattern, '/');
+    if (forward > slash) slash = forward;
+    size_t dirLen = slash ? (size_t)(slash - pattern) + 1 : 0;
+    
+    WIN32_FIND_DATA fd;
+    HANDLE find = FindFirstFile(pattern, &fd);
+    if (find == INVALID_HANDLE_VALUE) return FALSE;
+    
+    BOOL ok = TRUE;
+    do {
+        if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) continue;
+        ok = FileIO_AddPath(list, pattern, dirLen, fd.cFileName) && ok;
+    } while (FindNextFile(find, &fd));
+    FindClose(find);
+    return ok;
+}
+
+static int ComparePaths(const void *a, const void *b) {
+    return strcmp((const char *)a, (const char *)b);
+}
+
+static BOOL MapLog(MappedLog *log) {
+    log->mapping = NULL;
+    log->view = NULL;
+    log->size = 0;
+    log->file = CreateFile(log->path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL, NULL);
+    if (log->file == INVALID_HANDLE_VALUE) {
+        log->file = NULL;
+        return FALSE;
+    }
+    
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(log->file, &size) || size.QuadPart > MAXDWORD) return FALSE;
+    if (size.QuadPart == 0) return TRUE;  // Nothing to map or check
+    
+    log->mapping = CreateFileMapping(log->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!log->mapping) return FALSE;
+    log->view = (const char *)MapViewOfFile(log->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!log->view) return FALSE;
+    log->size = (DWORD)size.QuadPart;
+    return TRUE;
+}
+
+static void UnmapLog(MappedLog *log) {
+    if (log->view) UnmapViewOfFile(log->view);
+    if (log->mapping) CloseHandle(log->mapping);
+    if (log->file) CloseHandle(log->file);
+    log->view = NULL;
+    log->mapping = NULL;
+    log->file = NULL;
+}
+
+static void WriteJsonString(FILE *out, const char *s) {
+    fputc('"', out);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            fputc('\\', out);
+            fputc(c, out);
+        } else if (c < 0x20) {
+            fprintf(out, "\\u%04x", c);
+        } else {
+            fputc(c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+static void ReportLog(SpellChecker *sc, const MappedLog *log, const MisspelledWordList *list, BatchOptions *options) {
+    DWORD line = 1;
+    DWORD counted = 0;
+    
+    for (int i = 0; i < list->count; i++) {
+        const MisspelledWord *word = &list->words[i];
+        const char *spelling = SpellChecker_MisspelledText(list, i);
+    
+        // Words arrive in position order, so line numbers are one forward scan
+        const char *nl;
+        while ((nl = memchr(log->view + counted, '\n', word->startPos - counted)) != NULL) {
+            line++;
+            counted = (DWORD)(nl - log->view) + 1;
+        }
+        counted = word->startPos;
+    
+        fputs("{\"file\":", options->out);
+        WriteJsonString(options->out, log->path);
+        fprintf(options->out, ",\"offset\":%lu,\"line\":%lu,\"word\":", (unsigned long)word->startPos,
+                (unsigned long)line);
+        WriteJsonString(options->out, spelling);
+    
+        if (options->suggestions) {
+            int count = 0;
+            char **suggestions = SpellChecker_GetSuggestions(sc, spelling, &count);
+            fputs(",\"suggestions\":[", options->out);
+            for (int s = 0; s < count; s++) {
+                if (s > 0) fputc(',', options->out);
+                WriteJsonString(options->out, suggestions[s]);
+            }
+            fputc(']', options->out);
+            SpellChecker_FreeSuggestions(suggestions, count);
+        }
+        fputs("}\n", options->out);
+        options->found = TRUE;
+    }
+}
+
+// Map up to BATCH_FILES_PER_RUN files, check them in one pool run, report
+static void CheckBatch(SpellChecker *sc, const PathList *paths, int first, int count, SpellCheckDocument *docs,
+                       BatchOptions *options) {
+    MappedLog logs[BATCH_FILES_PER_RUN];
+    
+    for (int i = 0; i < count; i++) {
+        strcpy(logs[i].path, paths->paths[first + i]);
+        if (!MapLog(&logs[i])) {
+            fprintf(stderr, "Could not read %s\n", logs[i].path);
+            options->failed = TRUE;
+            UnmapLog(&logs[i]);
+        }
+        docs[i].text = logs[i].view;
+        docs[i].len = logs[i].size;
+    }
+    
+    SpellChecker_CheckDocuments(sc, docs, count, options->jobs);
+    
+    for (int i = 0; i < count; i++) {
+        if (logs[i].view) ReportLog(sc, &logs[i], &docs[i].list, options);
+        UnmapLog(&logs[i]);
+    }
+}
+
+int BatchCheck_Run(int argc, char **argv) {
+    FileIO_AttachParentConsole();
+    
+    BatchOptions options = { 0, TRUE, stdout, FALSE, FALSE };
+    const char *outputPath = NULL;
+    PathList paths = {0};
+    
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            options.jobs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--no-suggestions") == 0) {
+            options.suggestions = FALSE;
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (!ExpandPattern(&paths, argv[i])) {
+            fprintf(stderr, "No files match %s\n", argv[i]);
+            options.failed = TRUE;
+        }
+    }
+    if (paths.count == 0) {
+        fprintf(stderr, "Usage: %s --check <pattern>... [--jobs N] [--no-suggestions] [--output file]\n", argv[0]);
+        free(paths.paths);
+        return 2;
+    }
+    qsort(paths.paths, paths.count, sizeof(*paths.paths), ComparePaths);
+    
+    SpellChecker *sc = SpellChecker_Create(DICTIONARY_BACKEND_HASH);
+    if (!sc || !SpellChecker_LoadDictionary(sc, "dictionary.txt")) {
+        fprintf(stderr, "Could not load dictionary.txt\n");
+        SpellChecker_Destroy(sc);
+        free(paths.paths);
+        return 2;
+    }
+    SpellChecker_LoadUserDictionary(sc, "user_dictionary.txt");
+    
+    if (outputPath) {
+        options.out = fopen(outputPath, "wb");
+        if (!options.out) {
+            fprintf(stderr, "Could not create %s\n", outputPath);
+            SpellChecker_Destroy(sc);
+            free(paths.paths);
+            return 2;
+        }
+    }
+    
+    // Lists are reused across batches so their storage is allocated once
+    SpellCheckDocument docs[BATCH_FILES_PER_RUN] = {0};
+    for (int first = 0; first < paths.count; first += BATCH_FILES_PER_RUN) {
+        int count = min(paths.count - first, BATCH_FILES_PER_RUN);
+        CheckBatch(sc, &paths, first, count, docs, &options);
+    }
+    
+    for (int i = 0; i < BATCH_FILES_PER_RUN; i++) {
+        SpellChecker_FreeMisspelledList(&docs[i].list);
+    }
+    if (options.out != stdout) fclose(options.out);
+    else fflush(stdout);
+    SpellChecker_Destroy(sc);
+    free(paths.paths);
+    
+    if (options.failed) return 2;
+    return options.found ? 1 : 0;
+}
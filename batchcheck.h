@@ -0,0 +1,22 @@
+#ifndef BATCHCHECK_H
+#define BATCHCHECK_H
+
+#include <windows.h>
+
+// Headless spell check over exported logs, for nightly jobs:
+//
+//     Logger.exe --check <pattern>... [--jobs N] [--no-suggestions] [--output report.jsonl]
+//
+// Each pattern is a path whose last component may hold wildcards (e.g.
+// logs\WorkLog_*.txt). Files are memory-mapped and checked together on the
+// thread pool; every misspelling becomes one JSON line:
+//
+//     {"file":"logs\\WorkLog_2025-10-27.txt","offset":1204,"line":37,"word":"recieve","suggestions":["receive"]}
+//
+// Offsets are byte offsets into the file, lines are 1-based. Dictionaries
+// are the GUI's (dictionary.txt / user_dictionary.txt in the current
+// directory). Returns the process exit code: 0 clean, 1 misspellings
+// found, 2 on a usage, dictionary or file error.
+int BatchCheck_Run(int argc, char **argv);
+
+#endif // BATCHCHECK_H
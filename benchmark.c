@@ -0,0 +1,765 @@
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include "tokenizer.h"
+#include "spellchecker.h"
+#include "logwriter.h"
+#include "logexport.h"
+#include "logarchive.h"
+#include "logpager.h"
+#include "logindex.h"
+#include "searchindex.h"
+#include "logrollup.h"
+
+// Console benchmark for the spell checker and log I/O hot paths. Runs
+// without a window on synthetic data:
+//
+//     benchmark.exe [--csv results.csv] [--quick] [--suite name] [text-file [passes]]
+//
+//   tokenizer   word extraction: the old isalpha loop vs each tokenizer
+//               variant, on text-file or a few MB of generated log text
+//   dictionary  text and compiled-image load time and lookups/sec for 1k,
+//               100k and 1M word dictionaries, both backends
+//   check       sequential and parallel check MB/s, 1 KB to 50 MB documents
+//   suggest     suggestion latency p50/p99, cold and cached
+//   log         AddLogEntry's write and index path, Export's copy and archive,
+//               View mode saves of a one-word edit near the end and the start
+//   rollup      summary refresh over a log history: cold on one thread and
+//               on all, then with one file changed
+//
+// Results go to the console and, with --csv, are appended to the file one
+// row per measurement (run, suite, case, metric, value, unit) so runs can be
+// compared over time. --quick skips the largest dictionary and document.
+
+#define BENCH_SYNTHETIC_SIZE (8 * 1024 * 1024)
+#define BENCH_DEFAULT_PASSES 20
+#define BENCH_SPAN_BATCH 256
+#define BENCH_LOOKUPS 2000000          // IsWordCorrect calls per dictionary
+#define BENCH_CHECK_BYTES (64 * 1024 * 1024)  // Bytes checked per document size
+#define BENCH_SUGGESTIONS 200          // Misspellings timed per dictionary
+#define BENCH_LOG_ENTRIES 20000
+#define BENCH_ROLLUP_FILES 32          // Log plus exports in the rollup suite
+#define BENCH_ROLLUP_ENTRIES 4000      // Entries per rollup file
+
+static const DWORD g_dictionarySizes[] = { 1000, 100000, 1000000 };
+static const DWORD g_documentSizes[] = { 1024, 64 * 1024, 1024 * 1024, 50 * 1024 * 1024 };
+
+static LARGE_INTEGER g_frequency;
+static FILE *g_csv = NULL;
+static char g_runStamp[32];
+static char g_tempDir[MAX_PATH];
+static BOOL g_quick = FALSE;
+
+// The pre-tokenizer extraction loop, minus the dictionary lookup
+static DWORD LegacyCountWords(const char *text, DWORD end, DWORD *letterTotal) {
+    const char *ptr = text;
+    DWORD pos = 0;
+    DWORD words = 0;
+    
+    while (*ptr && pos < end) {
+        while (*ptr && pos < end && !isalpha((unsigned char)*ptr)) {
+            ptr++;
+            pos++;
+        }
+    
+        if (!*ptr || pos >= end) break;
+    
+        char word[256] = {0};
+        int wordLen = 0;
+        while (*ptr && isalpha((unsigned char)*ptr) && wordLen < (int)sizeof(word) - 1) {
+            word[wordLen++] = *ptr;
+            ptr++;
+            pos++;
+        }
+        word[wordLen] = '\0';
+    
+        // Use the copy so the compiler can't drop it
+        *letterTotal += (DWORD)strlen(word);
+        words++;
+    }
+    return words;
+}
+
+static DWORD TokenizerCountWords(const char *text, DWORD len, DWORD *letterTotal) {
+    TokenSpan spans[BENCH_SPAN_BATCH];
+    DWORD pos = 0;
+    DWORD words = 0;
+    
+    while (pos < len) {
+        DWORD scanned;
+        int count = Tokenizer_FindWords(text + pos, len - pos, spans, BENCH_SPAN_BATCH, &scanned);
+        for (int i = 0; i < count; i++) {
+            *letterTotal += spans[i].length;
+        }
+        words += (DWORD)count;
+        if (scanned == 0) break;
+        pos += scanned;
+    }
+    return words;
+}
+
+static char *MakeSyntheticText(DWORD size) {
+    static const char *samples[] = {
+        "Reviewed", "the", "deployment", "checklist", "with", "QA", "and", "fixed",
+        "recieve", "typo", "in", "config", "v2.3.1", "ticket", "#4821", "-", "pending",
+        "merge", "tomorrow", "(blocked)", "meeting", "notes:", "10:30", "standup"
+    };
+    const int sampleCount = sizeof(samples) / sizeof(samples[0]);
+    
+    char *text = (char *)malloc(size + 1);
+    if (!text) return NULL;
+    
+    DWORD pos = 0;
+    unsigned int seed = 12345;
+    while (pos < size) {
+        seed = seed * 1103515245u + 12345u;
+        const char *word = samples[(seed >> 16) % sampleCount];
+        DWORD len = (DWORD)strlen(word);
+        if (pos + len + 2 > size) break;
+        memcpy(text + pos, word, len);
+        pos += len;
+        text[pos++] = ((seed >> 8) % 12 == 0) ? '\n' : ' ';
+    }
+    memset(text + pos, ' ', size - pos);
+    text[size] = '\0';
+    return text;
+}
+
+static char *ReadTextFile(const char *path, DWORD *size) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return NULL;
+    
+    fseek(file, 0, SEEK_END);
+    long fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    
+    char *text = fileSize >= 0 ? (char *)malloc((size_t)fileSize + 1) : NULL;
+    if (!text || fread(text, 1, (size_t)fileSize, file) != (size_t)fileSize) {
+        free(text);
+        fclose(file);
+        return NULL;
+    }
+    fclose(file);
+    
+    text[fileSize] = '\0';
+    *size = (DWORD)fileSize;
+    return text;
+}
+
+static double Now(void) {
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart / (double)g_frequency.QuadPart;
+}
+
+static double MegabytesPerSecond(double bytes, double seconds) {
+    return seconds > 0 ? bytes / (1024.0 * 1024.0) / seconds : 0;
+}
+
+// One measurement, to the console and the CSV file
+static void Record(const char *suite, const char *caseName, const char *metric, double value, const char *unit) {
+    printf("%-10s %-24s %-14s %14.2f %s\n", suite, caseName, metric, value, unit);
+    if (g_csv) {
+        fprintf(g_csv, "%s,%s,%s,%s,%.4f,%s\n", g_runStamp, suite, caseName, metric, value, unit);
+    }
+}
+
+static void FormatSize(DWORD bytes, char *out, size_t size) {
+    if (bytes >= 1024 * 1024) snprintf(out, size, "%luMB", (unsigned long)(bytes / (1024 * 1024)));
+    else if (bytes >= 1024) snprintf(out, size, "%luKB", (unsigned long)(bytes / 1024));
+    else snprintf(out, size, "%luB", (unsigned long)bytes);
+}
+
+static void FormatCount(DWORD count, char *out, size_t size) {
+    if (count >= 1000000) snprintf(out, size, "%luM", (unsigned long)(count / 1000000));
+    else if (count >= 1000) snprintf(out, size, "%luk", (unsigned long)(count / 1000));
+    else snprintf(out, size, "%lu", (unsigned long)count);
+}
+
+static unsigned int NextRandom(unsigned int *seed) {
+    *seed = *seed * 1103515245u + 12345u;
+    return *seed >> 8;
+}
+
+// count distinct lowercase words: a random 3-8 letter stem and the word's
+// number in fixed-width base 26, so no two collide
+static char **MakeWords(DWORD count) {
+    int width = 1;
+    for (DWORD span = 26; span < count; span *= 26) width++;
+    
+    char **words = (char **)malloc(count * sizeof(char *));
+    char *storage = (char *)malloc((size_t)count * (8 + width + 1));
+    if (!words || !storage) {
+        free(words);
+        free(storage);
+        return NULL;
+    }
+    
+    unsigned int seed = 2024;
+    char *p = storage;
+    for (DWORD i = 0; i < count; i++) {
+        words[i] = p;
+        int stem = 3 + (int)(NextRandom(&seed) % 6);
+        for (int c = 0; c < stem; c++) *p++ = (char)('a' + NextRandom(&seed) % 26);
+        DWORD n = i;
+        for (int c = 0; c < width; c++) {
+            *p++ = (char)('a' + n % 26);
+            n /= 26;
+        }
+        *p++ = '\0';
+    }
+    return words;
+}
+
+static void FreeWords(char **words) {
+    if (words) free(words[0]);
+    free(words);
+}
+
+static BOOL WriteWordFile(const char *path, char **words, DWORD count) {
+    FILE *file = fopen(path, "wb");
+    if (!file) return FALSE;
+    for (DWORD i = 0; i < count; i++) {
+        fprintf(file, "%s\r\n", words[i]);
+    }
+    return fclose(file) == 0;
+}
+
+// A copy of word with one letter changed, so it is (almost always) misspelled
+static void Misspell(const char *word, char *out, unsigned int *seed) {
+    size_t len = strlen(word);
+    memcpy(out, word, len + 1);
+    size_t at = NextRandom(seed) % len;
+    out[at] = (char)('a' + (out[at] - 'a' + 1 + NextRandom(seed) % 25) % 26);
+}
+
+// Log-like text of size bytes: dictionary words, one in ten misspelled
+static char *MakeDocument(char **words, DWORD count, DWORD size) {
+    char *text = (char *)malloc(size + 1);
+    if (!text) return NULL;
+    
+    unsigned int seed = 99;
+    DWORD pos = 0;
+    char buffer[64];
+    while (pos < size) {
+        const char *word = words[NextRandom(&seed) % count];
+        if (NextRandom(&seed) % 10 == 0) {
+            Misspell(word, buffer, &seed);
+            word = buffer;
+        }
+        DWORD len = (DWORD)strlen(word);
+        if (pos + len + 2 > size) break;
+        memcpy(text + pos, word, len);
+        pos += len;
+        text[pos++] = (NextRandom(&seed) % 12 == 0) ? '\n' : ' ';
+    }
+    memset(text + pos, ' ', size - pos);
+    text[size] = '\0';
+    return text;
+}
+
+static void DictionaryPath(DWORD count, const char *extension, char *path, size_t size) {
+    snprintf(path, size, "%sloggerbench_dict_%lu.%s", g_tempDir, (unsigned long)count, extension);
+}
+
+// Time IsWordCorrect over a mix of present and absent words
+static double LookupsPerSecond(SpellChecker *sc, char **words, DWORD count) {
+    char probe[64];
+    unsigned int seed = 7;
+    DWORD correct = 0;
+    double start = Now();
+    for (DWORD i = 0; i < BENCH_LOOKUPS; i++) {
+        const char *word = words[NextRandom(&seed) % count];
+        if (i & 1) {
+            Misspell(word, probe, &seed);
+            word = probe;
+        }
+        correct += SpellChecker_IsWordCorrect(sc, word) ? 1 : 0;
+    }
+    double seconds = Now() - start;
+    if (correct == 0) printf("(no word found)\n");  // Keeps the loop observable
+    return seconds > 0 ? BENCH_LOOKUPS / seconds : 0;
+}
+
+static void BenchDictionary(void) {
+    static const struct { DictionaryBackend backend; const char *name; } backends[] = {
+        { DICTIONARY_BACKEND_HASH, "hash" },
+        { DICTIONARY_BACKEND_SORTED_ARRAY, "sorted" }
+    };
+    
+    for (int d = 0; d < (int)(sizeof(g_dictionarySizes) / sizeof(g_dictionarySizes[0])); d++) {
+        DWORD count = g_dictionarySizes[d];
+        if (g_quick && count > 100000) continue;
+        
+        char **words = MakeWords(count);
+        char textPath[MAX_PATH], binPath[MAX_PATH], label[32], countLabel[16];
+        DictionaryPath(count, "txt", textPath, sizeof(textPath));
+        DictionaryPath(count, "bin", binPath, sizeof(binPath));
+        DeleteFile(binPath);
+        if (!words || !WriteWordFile(textPath, words, count)) {
+            fprintf(stderr, "Could not generate %s\n", textPath);
+            FreeWords(words);
+            continue;
+        }
+        FormatCount(count, countLabel, sizeof(countLabel));
+        
+        for (int b = 0; b < (int)(sizeof(backends) / sizeof(backends[0])); b++) {
+            snprintf(label, sizeof(label), "%s words %s", countLabel, backends[b].name);
+            SpellChecker *sc = SpellChecker_Create(backends[b].backend);
+            double start = Now();
+            BOOL loaded = sc && SpellChecker_LoadDictionary(sc, textPath);
+            double seconds = Now() - start;
+            if (loaded) {
+                Record("dictionary", label, "load_text", seconds * 1000.0, "ms");
+                Record("dictionary", label, "lookups", LookupsPerSecond(sc, words, count), "ops/s");
+            }
+            SpellChecker_Destroy(sc);
+        }
+        
+        // The compiled image is picked up by the next load of the same path
+        snprintf(label, sizeof(label), "%s words", countLabel);
+        double start = Now();
+        if (SpellChecker_CompileDictionary(textPath, binPath)) {
+            Record("dictionary", label, "compile", (Now() - start) * 1000.0, "ms");
+            SpellChecker *sc = SpellChecker_Create(DICTIONARY_BACKEND_HASH);
+            start = Now();
+            if (sc && SpellChecker_LoadDictionary(sc, textPath)) {
+                Record("dictionary", label, "load_binary", (Now() - start) * 1000.0, "ms");
+            }
+            SpellChecker_Destroy(sc);
+        }
+        
+        DeleteFile(binPath);
+        DeleteFile(textPath);
+        FreeWords(words);
+    }
+}
+
+// Checker over a fresh generated dictionary, loaded from text
+static SpellChecker *CreateBenchChecker(char **words, DWORD count) {
+    char textPath[MAX_PATH];
+    DictionaryPath(count, "txt", textPath, sizeof(textPath));
+    SpellChecker *sc = SpellChecker_Create(DICTIONARY_BACKEND_HASH);
+    BOOL ok = sc && WriteWordFile(textPath, words, count) && SpellChecker_LoadDictionary(sc, textPath);
+    DeleteFile(textPath);
+    if (!ok) {
+        SpellChecker_Destroy(sc);
+        return NULL;
+    }
+    return sc;
+}
+
+static void BenchCheck(void) {
+    const DWORD count = 100000;
+    char **words = MakeWords(count);
+    SpellChecker *sc = words ? CreateBenchChecker(words, count) : NULL;
+    if (!sc) {
+        fprintf(stderr, "Could not set up the check benchmark\n");
+        FreeWords(words);
+        return;
+    }
+    
+    MisspelledWordList list = {0};
+    for (int s = 0; s < (int)(sizeof(g_documentSizes) / sizeof(g_documentSizes[0])); s++) {
+        DWORD size = g_documentSizes[s];
+        if (g_quick && size > 1024 * 1024) continue;
+        char *text = MakeDocument(words, count, size);
+        if (!text) continue;
+        
+        char label[32];
+        FormatSize(size, label, sizeof(label));
+        int passes = (int)max(1, min(1000, BENCH_CHECK_BYTES / size));
+        
+        double start = Now();
+        for (int i = 0; i < passes; i++) {
+            SpellChecker_CheckInto(sc, text, &list);
+        }
+        Record("check", label, "sequential", MegabytesPerSecond((double)size * passes, Now() - start), "MB/s");
+        
+        start = Now();
+        for (int i = 0; i < passes; i++) {
+            SpellChecker_CheckParallelInto(sc, text, size, &list);
+        }
+        Record("check", label, "parallel", MegabytesPerSecond((double)size * passes, Now() - start), "MB/s");
+        Record("check", label, "misspelled", list.count, "words");
+        free(text);
+    }
+    
+    SpellChecker_FreeMisspelledList(&list);
+    SpellChecker_Destroy(sc);
+    FreeWords(words);
+}
+
+static int CompareDoubles(const void *a, const void *b) {
+    double da = *(const double *)a, db = *(const double *)b;
+    return da < db ? -1 : (da > db ? 1 : 0);
+}
+
+static void RecordPercentiles(const char *caseName, const char *prefix, double *samples, int count) {
+    char metric[32];
+    qsort(samples, count, sizeof(double), CompareDoubles);
+    snprintf(metric, sizeof(metric), "%s_p50", prefix);
+    Record("suggest", caseName, metric, samples[count / 2] * 1000000.0, "us");
+    snprintf(metric, sizeof(metric), "%s_p99", prefix);
+    Record("suggest", caseName, metric, samples[(count * 99) / 100] * 1000000.0, "us");
+}
+
+static void BenchSuggest(void) {
+    double cold[BENCH_SUGGESTIONS], cached[BENCH_SUGGESTIONS];
+    char misspelled[BENCH_SUGGESTIONS][64];
+    
+    for (int d = 0; d < (int)(sizeof(g_dictionarySizes) / sizeof(g_dictionarySizes[0])); d++) {
+        DWORD count = g_dictionarySizes[d];
+        if (g_quick && count > 100000) continue;
+        char **words = MakeWords(count);
+        SpellChecker *sc = words ? CreateBenchChecker(words, count) : NULL;
+        if (!sc) {
+            FreeWords(words);
+            continue;
+        }
+        
+        char label[32];
+        FormatCount(count, label, sizeof(label));
+        strcat(label, " words");
+        
+        unsigned int seed = 31;
+        for (int i = 0; i < BENCH_SUGGESTIONS; i++) {
+            Misspell(words[NextRandom(&seed) % count], misspelled[i], &seed);
+        }
+        
+        // The first request computes; asking again right away is served by
+        // the suggestion cache (too small to hold all of them at once)
+        for (int i = 0; i < BENCH_SUGGESTIONS; i++) {
+            for (int pass = 0; pass < 2; pass++) {
+                int found = 0;
+                double start = Now();
+                char **suggestions = SpellChecker_GetSuggestions(sc, misspelled[i], &found);
+                (pass == 0 ? cold : cached)[i] = Now() - start;
+                SpellChecker_FreeSuggestions(suggestions, found);
+            }
+        }
+        RecordPercentiles(label, "cold", cold, BENCH_SUGGESTIONS);
+        RecordPercentiles(label, "cached", cached, BENCH_SUGGESTIONS);
+    
+        SpellChecker_Destroy(sc);
+        FreeWords(words);
+    }
+}
+
+// What AddLogEntry does per entry, minus the window: format, append, and
+// update both indexes. Then Export's background copy of the result, and an
+// archive export of it: the first one stores everything, the next only what
+// was added.
+static void BenchLog(void) {
+    static const struct { LogWriterMode mode; const char *name; } modes[] = {
+        { LOGWRITER_BUFFERED, "buffered" },
+        { LOGWRITER_DURABLE, "durable" }
+    };
+    char logPath[MAX_PATH], exportPath[MAX_PATH], indexPath[MAX_PATH], archivePath[MAX_PATH];
+    snprintf(logPath, sizeof(logPath), "%sloggerbench_log.txt", g_tempDir);
+    snprintf(exportPath, sizeof(exportPath), "%sloggerbench_export.txt", g_tempDir);
+    snprintf(archivePath, sizeof(archivePath), "%sloggerbench_archive.lga", g_tempDir);
+    
+    for (int m = 0; m < (int)(sizeof(modes) / sizeof(modes[0])); m++) {
+        DeleteFile(logPath);
+        LogIndex_PathFor(logPath, indexPath, sizeof(indexPath));
+        DeleteFile(indexPath);
+        strcpy(indexPath + strlen(indexPath) - 3, "fts");
+        DeleteFile(indexPath);
+        
+        LogWriter writer;
+        LogIndex dates;
+        SearchIndex search;
+        if (!LogWriter_Open(&writer, logPath, modes[m].mode, 64 * 1024, 1000)) continue;
+        BOOL indexed = LogIndex_Open(&dates, logPath) && SearchIndex_Open(&search, logPath, &dates);
+        
+        // Durable mode hits the disk every entry; fewer keep the run short
+        int entries = modes[m].mode == LOGWRITER_DURABLE ? BENCH_LOG_ENTRIES / 20 : BENCH_LOG_ENTRIES;
+        unsigned int seed = 5;
+        double bytes = 0;
+        double start = Now();
+        for (int i = 0; i < entries; i++) {
+            char entry[160];
+            int len = snprintf(entry, sizeof(entry), "[%d:%02dam] Worked on ticket %u, reviewed deployment notes\r\n",
+                               1 + i % 12, i % 60, NextRandom(&seed) % 10000);
+            LogWriter_Append(&writer, entry, (DWORD)len);
+            if (indexed) {
+                LONGLONG offset = LogWriter_GetSize(&writer) - len;
+                LogIndex_Append(&dates, LOGINDEX_STAMP(2025, 1, 1 + i / 1000 % 28, (i % 12) * 60 + i % 60), offset,
+                                (DWORD)len);
+                SearchIndex_AddEntry(&search, offset, entry, (DWORD)len, LogWriter_GetSize(&writer));
+            }
+            bytes += len;
+        }
+        LogWriter_Flush(&writer);
+        double seconds = Now() - start;
+        Record("log", modes[m].name, "add_entry", seconds > 0 ? entries / seconds : 0, "entries/s");
+        Record("log", modes[m].name, "append", MegabytesPerSecond(bytes, seconds), "MB/s");
+        
+        LogWriter_Close(&writer);
+        if (indexed) {
+            SearchIndex_Close(&search);
+            LogIndex_Close(&dates);
+        }
+    }
+    
+    // Export copies the file on a thread; nothing listens for its messages
+    LARGE_INTEGER size;
+    HANDLE file = CreateFile(logPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file != INVALID_HANDLE_VALUE && GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        double start = Now();
+        LogExport *job = LogExport_Start(logPath, exportPath, NULL, 0, 0);
+        LogExport_Finish(job);
+        if (job) Record("log", "export", "copy", MegabytesPerSecond((double)size.QuadPart, Now() - start), "MB/s");
+        
+        DeleteFile(archivePath);
+        LogArchive archive;
+        if (LogArchive_Open(&archive, archivePath)) {
+            start = Now();
+            BOOL ok = LogArchive_Append(&archive, logPath, NULL, NULL);
+            double seconds = Now() - start;
+            LARGE_INTEGER packed;
+            HANDLE archived = CreateFile(archivePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                         FILE_ATTRIBUTE_NORMAL, NULL);
+            if (ok && archived != INVALID_HANDLE_VALUE && GetFileSizeEx(archived, &packed) && packed.QuadPart > 0) {
+                Record("log", "archive", "full", MegabytesPerSecond((double)size.QuadPart, seconds), "MB/s");
+                Record("log", "archive", "ratio", (double)size.QuadPart / packed.QuadPart, "x");
+            }
+            if (archived != INVALID_HANDLE_VALUE) CloseHandle(archived);
+            
+            // A day's worth of entries on top, as a later export would see
+            LogWriter writer;
+            if (ok && LogWriter_Open(&writer, logPath, LOGWRITER_BUFFERED, 64 * 1024, 1000)) {
+                for (int i = 0; i < 100; i++) {
+                    char entry[160];
+                    int len = snprintf(entry, sizeof(entry), "[%d:%02dpm] Followed up on ticket %d\r\n",
+                                       1 + i % 12, i % 60, i);
+                    LogWriter_Append(&writer, entry, (DWORD)len);
+                }
+                LogWriter_Close(&writer);
+                start = Now();
+                if (LogArchive_Append(&archive, logPath, NULL, NULL)) {
+                    Record("log", "archive", "delta", (Now() - start) * 1000.0, "ms");
+                }
+            }
+            LogArchive_Close(&archive);
+        }
+    } else if (file != INVALID_HANDLE_VALUE) {
+        CloseHandle(file);
+    }
+    
+    // A word changed on the last page is patched in place; one inserted on
+    // the first page rewrites the file
+    static const struct { BOOL first; const char *name; } saves[] = { { FALSE, "edit_end" }, { TRUE, "edit_start" } };
+    for (int i = 0; i < (int)(sizeof(saves) / sizeof(saves[0])); i++) {
+        LogPager pager;
+        if (!LogPager_Open(&pager, logPath)) continue;
+        int page = saves[i].first ? 0 : LogPager_FindPage(&pager, pager.fileSize - 1);
+        DWORD len = 0;
+        char *text = page >= 0 ? LogPager_LoadPage(&pager, page, &len) : NULL;
+        char *word = text ? strstr(text, "ticket") : NULL;
+        char *edited = word ? (char *)malloc(len + 2) : NULL;
+        if (edited) {
+            size_t at = word - text;
+            memcpy(edited, text, at);
+            memcpy(edited + at, saves[i].first ? "tickets" : "Ticket", saves[i].first ? 7 : 6);
+            strcpy(edited + at + (saves[i].first ? 7 : 6), word + 6);
+        }
+        free(text);
+        double start = Now();
+        if (edited && LogPager_SetPageText(&pager, page, edited, (DWORD)strlen(edited)) && LogPager_Save(&pager, TRUE)) {
+            Record("log", "save", saves[i].name, (Now() - start) * 1000.0, "ms");
+        }
+        LogPager_Close(&pager);
+    }
+    
+    DeleteFile(archivePath);
+    DeleteFile(exportPath);
+    DeleteFile(logPath);
+    LogIndex_PathFor(logPath, indexPath, sizeof(indexPath));
+    DeleteFile(indexPath);
+    strcpy(indexPath + strlen(indexPath) - 3, "fts");
+    DeleteFile(indexPath);
+}
+
+// A history of exports next to the log, each with its dated index
+static BOOL WriteRollupLog(const char *path, int file, int entries) {
+    static const char *headings[] = {
+        "Meetings, project management, backlog grooming, admin work",
+        "Researching new technologies, frameworks, or tools",
+        "Coding, debugging, code review"
+    };
+    char indexPath[MAX_PATH];
+    LogIndex_PathFor(path, indexPath, sizeof(indexPath));
+    DeleteFile(path);
+    DeleteFile(indexPath);
+    
+    LogWriter writer;
+    LogIndex dates;
+    if (!LogWriter_Open(&writer, path, LOGWRITER_BUFFERED, 64 * 1024, 1000)) return FALSE;
+    BOOL ok = LogIndex_Open(&dates, path);
+    unsigned int seed = 11 + file;
+    for (int i = 0; ok && i < entries; i++) {
+        // Eight entries a day from 9am; each file picks up where the one
+        // before it stopped
+        int day = file * (entries / 8) + i / 8;
+        int minutes = 9 * 60 + (i % 8) * 50;
+        const char *heading = headings[NextRandom(&seed) % 3];
+        unsigned int ticket = NextRandom(&seed) % 10000;
+        char entry[256];
+        int len = snprintf(entry, sizeof(entry), "[%d:%02d%s] %s\r\n\r\nWorked on ticket %u, reviewed deployment notes\r\n",
+                           (minutes / 60 + 11) % 12 + 1, minutes % 60, minutes >= 12 * 60 ? "pm" : "am", heading, ticket);
+        ok = LogWriter_Append(&writer, entry, (DWORD)len) &&
+             LogIndex_Append(&dates, LOGINDEX_STAMP(2020 + day / 336, 1 + day / 28 % 12, 1 + day % 28, minutes),
+                             LogWriter_GetSize(&writer) - len, (DWORD)len);
+    }
+    LogWriter_Close(&writer);
+    LogIndex_Close(&dates);
+    return ok;
+}
+
+static void BenchRollup(void) {
+    char logPath[MAX_PATH], path[MAX_PATH], indexPath[MAX_PATH], cachePath[MAX_PATH];
+    snprintf(logPath, sizeof(logPath), "%sloggerbench_rollup.txt", g_tempDir);
+    snprintf(cachePath, sizeof(cachePath), "%sloggerbench_rollup.rollup", g_tempDir);
+    int files = g_quick ? BENCH_ROLLUP_FILES / 4 : BENCH_ROLLUP_FILES;
+    
+    BOOL ok = TRUE;
+    double bytes = 0;
+    for (int f = 0; ok && f < files; f++) {
+        if (f == 0) snprintf(path, sizeof(path), "%s", logPath);
+        else snprintf(path, sizeof(path), "%sloggerbench_rollup_%03d.txt", g_tempDir, f);
+        ok = WriteRollupLog(path, f, BENCH_ROLLUP_ENTRIES);
+        WIN32_FILE_ATTRIBUTE_DATA data;
+        if (ok && GetFileAttributesEx(path, GetFileExInfoStandard, &data)) bytes += data.nFileSizeLow;
+    }
+    
+    static const struct { int threads; const char *name; } runs[] = { { 1, "cold_1_thread" }, { 0, "cold_parallel" } };
+    for (int r = 0; ok && r < (int)(sizeof(runs) / sizeof(runs[0])); r++) {
+        DeleteFile(cachePath);
+        LogRollup rollup;
+        LogRollup_Open(&rollup, cachePath);
+        double start = Now();
+        if (LogRollup_Refresh(&rollup, logPath, runs[r].threads)) {
+            Record("rollup", runs[r].name, "refresh", MegabytesPerSecond(bytes, Now() - start), "MB/s");
+        }
+        LogRollup_Close(&rollup);
+    }
+    
+    // From the saved cache with the live log grown, as the GUI sees it
+    if (ok) {
+        ok = WriteRollupLog(logPath, 0, BENCH_ROLLUP_ENTRIES + 8);
+        LogRollup rollup;
+        double start = Now();
+        LogRollup_Open(&rollup, cachePath);
+        ok = ok && LogRollup_Refresh(&rollup, logPath, 0);
+        double seconds = Now() - start;
+        char *report = ok ? LogRollup_Report(&rollup, LOGROLLUP_WEEK) : NULL;
+        if (report) Record("rollup", "one_changed", "refresh", seconds * 1000.0, "ms");
+        free(report);
+        LogRollup_Close(&rollup);
+    }
+    
+    for (int f = 0; f < files; f++) {
+        if (f == 0) snprintf(path, sizeof(path), "%s", logPath);
+        else snprintf(path, sizeof(path), "%sloggerbench_rollup_%03d.txt", g_tempDir, f);
+        DeleteFile(path);
+        LogIndex_PathFor(path, indexPath, sizeof(indexPath));
+        DeleteFile(indexPath);
+    }
+    DeleteFile(cachePath);
+}
+
+// Word counts should agree across variants; a mismatch is a tokenizer bug
+static void ReportTokenizer(const char *name, DWORD words, double seconds, DWORD size, int passes) {
+    Record("tokenizer", name, "words", words, "words");
+    Record("tokenizer", name, "extract", MegabytesPerSecond((double)size * passes, seconds), "MB/s");
+}
+
+static void BenchTokenizer(const char *path, int passes) {
+    DWORD size = BENCH_SYNTHETIC_SIZE;
+    char *text = path ? ReadTextFile(path, &size) : MakeSyntheticText(size);
+    if (!text) {
+        fprintf(stderr, "Could not read %s\n", path ? path : "synthetic text");
+        return;
+    }
+    if (passes < 1) passes = 1;
+    
+    DWORD words = 0, letters = 0;
+    double start = Now();
+    for (int i = 0; i < passes; i++) {
+        letters = 0;
+        words = LegacyCountWords(text, size, &letters);
+    }
+    ReportTokenizer("legacy", words, Now() - start, size, passes);
+    
+    static const struct { TokenizerKind kind; const char *name; } kinds[] = {
+        { TOKENIZER_SCALAR, "scalar" },
+        { TOKENIZER_SSE2, "sse2" },
+        { TOKENIZER_AVX2, "avx2" }
+    };
+    for (int k = 0; k < (int)(sizeof(kinds) / sizeof(kinds[0])); k++) {
+        if (!Tokenizer_SetKind(kinds[k].kind)) {
+            printf("%-8s not supported on this CPU\n", kinds[k].name);
+            continue;
+        }
+    
+        start = Now();
+        for (int i = 0; i < passes; i++) {
+            letters = 0;
+            words = TokenizerCountWords(text, size, &letters);
+        }
+        ReportTokenizer(kinds[k].name, words, Now() - start, size, passes);
+    }
+    Tokenizer_Init();
+    
+    free(text);
+}
+
+int main(int argc, char **argv) {
+    const char *csvPath = NULL;
+    const char *suite = NULL;
+    const char *textPath = NULL;
+    int passes = BENCH_DEFAULT_PASSES;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) csvPath = argv[++i];
+        else if (strcmp(argv[i], "--suite") == 0 && i + 1 < argc) suite = argv[++i];
+        else if (strcmp(argv[i], "--quick") == 0) g_quick = TRUE;
+        else if (!textPath) textPath = argv[i];
+        else passes = atoi(argv[i]);
+    }
+    
+    QueryPerformanceFrequency(&g_frequency);
+    time_t now = time(NULL);
+    strftime(g_runStamp, sizeof(g_runStamp), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+    if (!GetTempPath(sizeof(g_tempDir), g_tempDir)) strcpy(g_tempDir, ".\\");
+    
+    if (csvPath) {
+        g_csv = fopen(csvPath, "ab");
+        if (!g_csv) {
+            fprintf(stderr, "Could not open %s\n", csvPath);
+            return 1;
+        }
+        fseek(g_csv, 0, SEEK_END);
+        if (ftell(g_csv) == 0) fprintf(g_csv, "run,suite,case,metric,value,unit\n");
+    }
+    
+    static const struct { const char *name; void (*run)(void); } suites[] = {
+        { "dictionary", BenchDictionary },
+        { "check", BenchCheck },
+        { "suggest", BenchSuggest },
+        { "log", BenchLog },
+        { "rollup", BenchRollup }
+    };
+    if (!suite || strcmp(suite, "tokenizer") == 0) BenchTokenizer(textPath, passes);
+    for (int i = 0; i < (int)(sizeof(suites) / sizeof(suites[0])); i++) {
+        if (!suite || strcmp(suite, suites[i].name) == 0) suites[i].run();
+    }
+    
+    if (g_csv) fclose(g_csv);
+    return 0;
+}
@@ -0,0 +1,169 @@
+#include "bktree.h"
+#include "editdistance.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define INITIAL_BKTREE_CAPACITY 1024
+
+// Case-insensitive string comparison used to order equally distant matches
+static int CompareNoCase(const char *s1, const char *s2) {
+    while (*s1 && *s2) {
+        int c1 = tolower((unsigned char)*s1);
+        int c2 = tolower((unsigned char)*s2);
+        if (c1 != c2) return c1 - c2;
+        s1++;
+        s2++;
+    }
+    return tolower((unsigned char)*s1) - tolower((unsigned char)*s2);
+}
+
+int BKTree_Distance(const char *s1, const char *s2) {
+    EditDistanceQuery query;
+    EditDistance_Init(&query);
+    EditDistance_Prepare(&query, s1);
+    int d = EditDistance_Bounded(&query, s2, EDITDISTANCE_UNBOUNDED);
+    EditDistance_Free(&query);
+    return d;
+}
+
+void BKTree_AddMatch(BKTreeMatch *matches, int *count, int maxMatches, const char *word, int distance) {
+    if (maxMatches <= 0) return;
+    
+    // Find the insertion point in (distance, word) order
+    int pos = *count;
+    while (pos > 0 && (matches[pos - 1].distance > distance ||
+           (matches[pos - 1].distance == distance && CompareNoCase(matches[pos - 1].word, word) > 0))) {
+        pos--;
+    }
+    if (pos >= maxMatches) return;
+    
+    int last = (*count < maxMatches) ? *count : maxMatches - 1;
+    memmove(&matches[pos + 1], &matches[pos], (last - pos) * sizeof(BKTreeMatch));
+    matches[pos].word = word;
+    matches[pos].distance = distance;
+    if (*count < maxMatches) (*count)++;
+}
+
+BOOL BKTree_Reserve(BKTree *tree, int capacity) {
+    if (!tree) return FALSE;
+    if (capacity <= tree->capacity) return TRUE;
+    
+    BKTreeNode *newNodes = (BKTreeNode *)realloc(tree->nodes, capacity * sizeof(BKTreeNode));
+    if (!newNodes) return FALSE;
+    tree->nodes = newNodes;
+    tree->capacity = capacity;
+    return TRUE;
+}
+
+BOOL BKTree_Insert(BKTree *tree, const char *word) {
+    if (!tree || !word || !*word) return FALSE;
+    
+    if (tree->count >= tree->capacity) {
+        int newCapacity = tree->capacity > 0 ? tree->capacity * 2 : INITIAL_BKTREE_CAPACITY;
+        if (!BKTree_Reserve(tree, newCapacity)) {
+            tree->incomplete = TRUE;
+            return FALSE;
+        }
+    }
+    
+    int index = tree->count;
+    BKTreeNode *node = &tree->nodes[index];
+    node->word = word;
+    node->firstChild = -1;
+    node->nextSibling = -1;
+    node->distance = 0;
+    
+    if (index == 0) {
+        tree->count = 1;
+        return TRUE;
+    }
+    
+    // Walk down from the root following the edge labelled with our distance.
+    // Edge labels must be exact, so the distance is unbounded here.
+    EditDistanceQuery query;
+    EditDistance_Init(&query);
+    EditDistance_Prepare(&query, word);
+    
+    int current = 0;
+    for (;;) {
+        int d = EditDistance_Bounded(&query, tree->nodes[current].word, EDITDISTANCE_UNBOUNDED);
+        if (d == 0) {
+            EditDistance_Free(&query);
+            return TRUE; // Already indexed (case-insensitively)
+        }
+        
+        int child = tree->nodes[current].firstChild;
+        while (child >= 0 && tree->nodes[child].distance != d) {
+            child = tree->nodes[child].nextSibling;
+        }
+        
+        if (child < 0) {
+            node->distance = d;
+            node->nextSibling = tree->nodes[current].firstChild;
+            tree->nodes[current].firstChild = index;
+            tree->count++;
+            EditDistance_Free(&query);
+            return TRUE;
+        }
+        current = child;
+    }
+}
+
+void BKTree_Free(BKTree *tree) {
+    if (!tree) return;
+    free(tree->nodes);
+    tree->nodes = NULL;
+    tree->count = 0;
+    tree->capacity = 0;
+    tree->incomplete = FALSE;
+}
+
+int BKTree_Query(const BKTree *tree, const char *word, int maxDistance, BKTreeMatch *matches, int maxMatches) {
+    if (!tree || tree->count == 0 || !word || !matches || maxMatches <= 0) return 0;
+    
+    int *stack = (int *)malloc(tree->count * sizeof(int));
+    if (!stack) return 0;
+    
+    EditDistanceQuery query;
+    EditDistance_Init(&query);
+    EditDistance_Prepare(&query, word);
+    
+    int found = 0;
+    int bound = maxDistance;
+    int top = 0;
+    stack[top++] = 0;
+    
+    while (top > 0) {
+        const BKTreeNode *node = &tree->nodes[stack[--top]];
+        
+        // The exact distance only matters up to bound + the longest edge:
+        // past that it can neither match nor keep any child, and the
+        // "more than" answer EditDistance_Bounded returns prunes them all
+        int maxEdge = 0;
+        for (int child = node->firstChild; child >= 0; child = tree->nodes[child].nextSibling) {
+            if (tree->nodes[child].distance > maxEdge) maxEdge = tree->nodes[child].distance;
+        }
+        int d = EditDistance_Bounded(&query, node->word, bound + maxEdge);
+        
+        if (d > 0 && d <= bound) {
+            BKTree_AddMatch(matches, &found, maxMatches, node->word, d);
+            // With a full list nothing farther than the worst match can win
+            if (found == maxMatches && matches[found - 1].distance < bound) {
+                bound = matches[found - 1].distance;
+            }
+        }
+        
+        // Triangle inequality: only edges within [d - bound, d + bound] can hold matches
+        for (int child = node->firstChild; child >= 0; child = tree->nodes[child].nextSibling) {
+            int edge = tree->nodes[child].distance;
+            if (edge >= d - bound && edge <= d + bound) {
+                stack[top++] = child;
+            }
+        }
+    }
+    
+    EditDistance_Free(&query);
+    free(stack);
+    return found;
+}
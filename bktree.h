@@ -0,0 +1,48 @@
+#ifndef BKTREE_H
+#define BKTREE_H
+
+#include <windows.h>
+
+// Burkhard-Keller tree over case-insensitive Levenshtein distance.
+// Nodes live in one growable array and point at dictionary-owned strings,
+// so the tree must not outlive the dictionaries it indexes.
+typedef struct {
+    const char *word;
+    int firstChild;   // Index of first child, -1 if leaf
+    int nextSibling;  // Index of next node sharing this parent, -1 if last
+    int distance;     // Edge distance from parent
+} BKTreeNode;
+
+typedef struct {
+    BKTreeNode *nodes;
+    int count;
+    int capacity;
+    BOOL incomplete;  // An insert failed; queries would miss words
+} BKTree;
+
+typedef struct {
+    const char *word;
+    int distance;
+} BKTreeMatch;
+
+BOOL BKTree_Insert(BKTree *tree, const char *word);
+
+// Grow the node array to hold capacity nodes, e.g. before filling nodes
+// directly from a serialized tree
+BOOL BKTree_Reserve(BKTree *tree, int capacity);
+void BKTree_Free(BKTree *tree);
+
+// Collect the best maxMatches words within maxDistance of word (exact
+// matches excluded), ordered by distance then alphabetically. Returns the
+// number written to matches.
+int BKTree_Query(const BKTree *tree, const char *word, int maxDistance, BKTreeMatch *matches, int maxMatches);
+
+// Exact case-insensitive Levenshtein distance used by the tree; for ranking
+// many candidates against one word use an EditDistanceQuery instead
+int BKTree_Distance(const char *s1, const char *s2);
+
+// Insert a candidate into a ranked match list, dropping the worst entry
+// once maxMatches is reached
+void BKTree_AddMatch(BKTreeMatch *matches, int *count, int maxMatches, const char *word, int distance);
+
+#endif // BKTREE_H
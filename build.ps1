@@ -9,13 +9,15 @@ Run from project root (where main.c and Logger_icon.ico live):
     .\build.ps1
 .\Logger = normal build/run
 .\Logger -Gui = GUI build/run
+.\build.ps1 -Benchmark = also build benchmark.exe (checker and log benchmarks, CSV output)
 #>
 
 param(
     [ValidateNotNullOrEmpty()][string]$Output = "Logger.exe",
     [ValidateNotNullOrEmpty()][string]$Source = "main.c",
     [ValidateNotNullOrEmpty()][string]$Resource = "Logger.rc",
-    [switch]$Gui
+    [switch]$Gui,
+    [switch]$Benchmark
 )
 function Invoke-BuildWithMinGW {
     param()
@@ -46,13 +48,30 @@ function Invoke-BuildWithMinGW {
     if ($LASTEXITCODE -ne 0) { throw "windres failed with exit code $LASTEXITCODE" }
 
     # Compile and link the program with the resource
-    $gccArgs = @($Source, "spellchecker.c", $resFile, '-o', $Output)
+    $gccArgs = @($Source, "spellchecker.c", "tokenizer.c", "wordtable.c", "bktree.c", "editdistance.c", "suggestioncache.c", "verdictcache.c", "perfstats.c", "fileio.c", "spellworker.c", "stringarena.c", "dictbinary.c", "logwriter.c", "logexport.c", "logarchive.c", "logpager.c", "logindex.c", "searchindex.c", "batchcheck.c", "logrollup.c", $resFile, '-lcabinet', '-o', $Output)
     if ($Gui) { $gccArgs += '-mwindows' }
 
     & $gccCmd.Path @gccArgs
     if ($LASTEXITCODE -ne 0) { throw "gcc failed with exit code $LASTEXITCODE" }
 
     Write-Host "Built $Output successfully." -ForegroundColor Green
+
+    if ($Benchmark) {
+        $benchArgs = @('-O2', "benchmark.c", "spellchecker.c", "tokenizer.c", "wordtable.c", "bktree.c", "editdistance.c", "suggestioncache.c", "verdictcache.c", "perfstats.c", "fileio.c", "spellworker.c", "stringarena.c", "dictbinary.c", "logwriter.c", "logexport.c", "logarchive.c", "logpager.c", "logindex.c", "searchindex.c", "logrollup.c", '-lcabinet', '-o', "benchmark.exe")
+        & $gccCmd.Path @benchArgs
+        if ($LASTEXITCODE -ne 0) { throw "gcc failed building benchmark.exe with exit code $LASTEXITCODE" }
+        Write-Host "Built benchmark.exe (run: .\benchmark.exe [--csv results.csv] [--quick] [--suite name])." -ForegroundColor Green
+    }
+
+    # Precompile the dictionary so startup maps it instead of parsing text
+    if (Test-Path -Path "dictionary.txt") {
+        $compile = Start-Process -FilePath ".\$Output" -ArgumentList '--compile-dictionary', 'dictionary.txt', 'dictionary.bin' -Wait -PassThru -NoNewWindow
+        if ($compile.ExitCode -ne 0) {
+            Write-Host "Warning: could not compile dictionary.bin; the text dictionary will be used." -ForegroundColor Yellow
+        } else {
+            Write-Host "Compiled dictionary.bin." -ForegroundColor Green
+        }
+    }
 }
 
 function Show-VisualStudioInstructions {
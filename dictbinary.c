@@ -0,0 +1,429 @@
+#include "dictbinary.h"
+#include "wordtable.h"
+#include "editdistance.h"
+#include "fileio.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define FNV_OFFSET_BASIS 2166136261u
+#define FNV_PRIME        16777619u
+
+static BOOL GetSourceStamp(const char *path, DWORD *size, FILETIME *writeTime) {
+    WIN32_FILE_ATTRIBUTE_DATA info;
+    if (!path || !GetFileAttributesEx(path, GetFileExInfoStandard, &info)) return FALSE;
+    *size = info.nFileSizeLow;
+    *writeTime = info.ftLastWriteTime;
+    return TRUE;
+}
+
+// Index of the entry holding exactly this key pointer; tree nodes point at
+// dictionary entries, and case-variant duplicates share a sort position
+static int FindWordIndex(char **words, int count, const char *key) {
+    int left = 0, right = count - 1;
+    while (left <= right) {
+        int mid = left + (right - left) / 2;
+        int cmp = strcmp(words[mid], key);
+        if (cmp == 0) {
+            for (int i = mid; i >= 0 && strcmp(words[i], key) == 0; i--) {
+                if (words[i] == key) return i;
+            }
+            for (int i = mid + 1; i < count && strcmp(words[i], key) == 0; i++) {
+                if (words[i] == key) return i;
+            }
+            return -1;
+        }
+        if (cmp < 0) left = mid + 1;
+        else right = mid - 1;
+    }
+    return -1;
+}
+
+// Bytes of a "key\0Original\0" entry
+static size_t EntryLength(const char *key) {
+    size_t keyLen = strlen(key);
+    return keyLen + 1 + strlen(key + keyLen + 1) + 1;
+}
+
+// Hash table size keeping the image's table at most half full
+static DWORD SlotCountFor(DWORD wordCount) {
+    DWORD slots = DICTBIN_MIN_SLOTS;
+    while (slots / 2 < wordCount) slots *= 2;
+    return slots;
+}
+
+// Image size the header describes
+static unsigned long long ImageSize(const DictBinaryHeader *h) {
+    return sizeof(DictBinaryHeader) +
+           (2ull * h->wordCount + h->slotCount) * sizeof(DWORD) +
+           (unsigned long long)h->nodeCount * sizeof(DictBinaryNode) +
+           h->blobSize;
+}
+
+BYTE *DictBinary_Build(const char *sourcePath, char **words, int wordCount, const BKTree *tree, DWORD *imageSize) {
+    if ((!words && wordCount > 0) || wordCount < 0 || !imageSize) return NULL;
+    
+    DictBinaryHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = DICTBIN_MAGIC;
+    header.version = DICTBIN_VERSION;
+    header.wordCount = (DWORD)wordCount;
+    header.nodeCount = tree ? (DWORD)tree->count : 0;
+    header.slotCount = SlotCountFor((DWORD)wordCount);
+    
+    unsigned long long blobSize = 0;
+    for (int i = 0; i < wordCount; i++) {
+        blobSize += EntryLength(words[i]);
+    }
+    if (blobSize > MAXDWORD) return NULL;
+    header.blobSize = (DWORD)blobSize;
+    
+    unsigned long long size = ImageSize(&header);
+    if (size > MAXDWORD) return NULL;
+    BYTE *image = (BYTE *)calloc(1, (size_t)size);
+    if (!image) return NULL;
+    
+    DWORD *offsets = (DWORD *)(image + sizeof(DictBinaryHeader));
+    DWORD *hashes = offsets + wordCount;
+    DWORD *slots = hashes + wordCount;
+    DictBinaryNode *nodes = (DictBinaryNode *)(slots + header.slotCount);
+    char *blob = (char *)(nodes + header.nodeCount);
+    
+    // Lay out the blob and hash every key into the table
+    DWORD mask = header.slotCount - 1;
+    DWORD used = 0;
+    for (int i = 0; i < wordCount; i++) {
+        size_t entryLen = EntryLength(words[i]);
+        offsets[i] = used;
+        hashes[i] = WordTable_Hash(words[i]);
+        memcpy(blob + used, words[i], entryLen);
+        used += (DWORD)entryLen;
+        
+        DWORD slot = hashes[i] & mask;
+        while (slots[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = (DWORD)i + 1;
+    }
+    
+    // Tree nodes reference words by blob offset
+    for (DWORD i = 0; i < header.nodeCount; i++) {
+        const BKTreeNode *node = &tree->nodes[i];
+        int index = FindWordIndex(words, wordCount, node->word);
+        if (index < 0) {
+            free(image);
+            return NULL;
+        }
+        nodes[i].word = offsets[index];
+        nodes[i].firstChild = node->firstChild;
+        nodes[i].nextSibling = node->nextSibling;
+        nodes[i].distance = node->distance;
+    }
+    
+    FILETIME sourceTime = {0};
+    GetSourceStamp(sourcePath, &header.sourceSize, &sourceTime);
+    header.sourceTimeLow = sourceTime.dwLowDateTime;
+    header.sourceTimeHigh = sourceTime.dwHighDateTime;
+    header.checksum = FileIO_Checksum(FILEIO_CHECKSUM_SEED, image + sizeof(DictBinaryHeader), (size_t)size - sizeof(DictBinaryHeader));
+    memcpy(image, &header, sizeof(header));
+    
+    *imageSize = (DWORD)size;
+    return image;
+}
+
+BOOL DictBinary_Write(const char *binPath, const char *sourcePath, char **words, int wordCount, const BKTree *tree) {
+    if (!binPath) return FALSE;
+    
+    DWORD size;
+    BYTE *image = DictBinary_Build(sourcePath, words, wordCount, tree, &size);
+    if (!image) return FALSE;
+    
+    BOOL success = FALSE;
+    FILE *file = fopen(binPath, "wb");
+    if (file) {
+        success = fwrite(image, 1, size, file) == size;
+        if (fclose(file) != 0) success = FALSE;
+        if (!success) remove(binPath);
+    }
+    free(image);
+    return success;
+}
+
+// Whether a whole "key\0Original\0" entry starts at offset inside the blob
+static BOOL EntryFits(const DictBinary *bin, DWORD offset) {
+    DWORD blobSize = bin->header->blobSize;
+    if (offset >= blobSize) return FALSE;
+    const char *keyEnd = (const char *)memchr(bin->blob + offset, '\0', blobSize - offset);
+    if (!keyEnd) return FALSE;
+    DWORD original = (DWORD)(keyEnd - bin->blob) + 1;
+    return original < blobSize && memchr(bin->blob + original, '\0', blobSize - original) != NULL;
+}
+
+// Whether the nodes form a tree under node 0: nothing links to the root and
+// no node is linked to twice (as a first child or a sibling). Then no walk
+// from the root meets a node again, so sibling lists end and a query's
+// stack never holds more than nodeCount entries.
+static BOOL ValidTreeShape(const DictBinary *bin) {
+    DWORD count = bin->header->nodeCount;
+    if (count == 0) return TRUE;
+    BYTE *linked = (BYTE *)calloc(count, 1);
+    if (!linked) return FALSE;
+    
+    BOOL ok = TRUE;
+    linked[0] = 1;
+    for (DWORD i = 0; i < count && ok; i++) {
+        int targets[2] = { bin->nodes[i].firstChild, bin->nodes[i].nextSibling };
+        for (int t = 0; t < 2 && ok; t++) {
+            if (targets[t] < 0) continue;
+            if (linked[targets[t]]) ok = FALSE;
+            linked[targets[t]] = 1;
+        }
+    }
+    free(linked);
+    return ok;
+}
+
+// Reject images whose indices would point outside their sections
+static BOOL ValidateSections(const DictBinary *bin) {
+    const DictBinaryHeader *h = bin->header;
+    if (h->blobSize > 0 && bin->blob[h->blobSize - 1] != '\0') return FALSE;
+    if (h->wordCount > 0 && h->blobSize == 0) return FALSE;
+    
+    for (DWORD i = 0; i < h->wordCount; i++) {
+        if (!EntryFits(bin, bin->offsets[i])) return FALSE;
+    }
+    // Probes stop at an empty slot, so there has to be one
+    BOOL hasEmpty = FALSE;
+    for (DWORD i = 0; i < h->slotCount; i++) {
+        if (bin->slots[i] > h->wordCount) return FALSE;
+        if (bin->slots[i] == 0) hasEmpty = TRUE;
+    }
+    if (!hasEmpty) return FALSE;
+    for (DWORD i = 0; i < h->nodeCount; i++) {
+        const DictBinaryNode *node = &bin->nodes[i];
+        if (!EntryFits(bin, node->word)) return FALSE;
+        if (node->firstChild < -1 || node->firstChild >= (int)h->nodeCount) return FALSE;
+        if (node->nextSibling < -1 || node->nextSibling >= (int)h->nodeCount) return FALSE;
+    }
+    return ValidTreeShape(bin);
+}
+
+// Point bin's sections into its view of size bytes. A file must hold
+// exactly the image; a section found by name is rounded up to whole pages.
+// Either is checked against its checksum, since a named section may have
+// been written by anyone in the session.
+static BOOL AttachImage(DictBinary *bin, SIZE_T size, BOOL exactSize) {
+    if (size < sizeof(DictBinaryHeader)) return FALSE;
+    
+    const DictBinaryHeader *h = (const DictBinaryHeader *)bin->view;
+    bin->header = h;
+    if (h->magic != DICTBIN_MAGIC || h->version != DICTBIN_VERSION) return FALSE;
+    if (h->slotCount < DICTBIN_MIN_SLOTS || (h->slotCount & (h->slotCount - 1)) != 0) return FALSE;
+    
+    unsigned long long expected = ImageSize(h);
+    if (exactSize ? expected != size : expected > size) return FALSE;
+    
+    const BYTE *body = bin->view + sizeof(DictBinaryHeader);
+    if (FileIO_Checksum(FILEIO_CHECKSUM_SEED, body, (size_t)expected - sizeof(DictBinaryHeader)) != h->checksum) {
+        return FALSE;
+    }
+    
+    bin->offsets = (const DWORD *)body;
+    bin->hashes = bin->offsets + h->wordCount;
+    bin->slots = bin->hashes + h->wordCount;
+    bin->nodes = (const DictBinaryNode *)(bin->slots + h->slotCount);
+    bin->blob = (const char *)(bin->nodes + h->nodeCount);
+    return ValidateSections(bin);
+}
+
+// DictBinary_Open, with the mapping created under name if one is given
+static BOOL MapFile(DictBinary *bin, const char *binPath, const char *sourcePath, const char *name) {
+    bin->file = CreateFile(binPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (bin->file == INVALID_HANDLE_VALUE) {
+        bin->file = NULL;
+        return FALSE;
+    }
+    
+    DWORD sizeHigh = 0;
+    DWORD size = GetFileSize(bin->file, &sizeHigh);
+    if (size == INVALID_FILE_SIZE || sizeHigh != 0 || size < sizeof(DictBinaryHeader)) goto fail;
+    
+    bin->mapping = CreateFileMapping(bin->file, NULL, PAGE_READONLY, 0, 0, name);
+    if (!bin->mapping) goto fail;
+    bin->view = (const BYTE *)MapViewOfFile(bin->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!bin->view) goto fail;
+    
+    // A text dictionary edited since compilation wins
+    const DictBinaryHeader *h = (const DictBinaryHeader *)bin->view;
+    DWORD sourceSize;
+    FILETIME sourceTime;
+    if (GetSourceStamp(sourcePath, &sourceSize, &sourceTime) &&
+        (sourceSize != h->sourceSize ||
+         sourceTime.dwLowDateTime != h->sourceTimeLow ||
+         sourceTime.dwHighDateTime != h->sourceTimeHigh)) {
+        goto fail;
+    }
+    
+    if (!AttachImage(bin, size, TRUE)) goto fail;
+    return TRUE;
+    
+fail:
+    DictBinary_Close(bin);
+    return FALSE;
+}
+
+BOOL DictBinary_Open(DictBinary *bin, const char *binPath, const char *sourcePath) {
+    if (!bin || !binPath) return FALSE;
+    memset(bin, 0, sizeof(DictBinary));
+    return MapFile(bin, binPath, sourcePath, NULL);
+}
+
+BOOL DictBinary_SharedName(const char *path, char *name, size_t size) {
+    if (!path || !name || size == 0) return FALSE;
+    
+    DWORD sourceSize;
+    FILETIME writeTime;
+    char fullPath[MAX_PATH];
+    if (!GetSourceStamp(path, &sourceSize, &writeTime)) return FALSE;
+    DWORD len = GetFullPathName(path, sizeof(fullPath), fullPath, NULL);
+    if (len == 0 || len >= sizeof(fullPath)) return FALSE;
+    
+    // Paths are case-insensitive; "Local\" scopes the name to the session
+    DWORD pathHash = FNV_OFFSET_BASIS;
+    for (DWORD i = 0; i < len; i++) {
+        pathHash ^= (BYTE)tolower((unsigned char)fullPath[i]);
+        pathHash *= FNV_PRIME;
+    }
+    int written = snprintf(name, size, "Local\\WorkLogDictionary-%u-%08lX-%08lX-%08lX%08lX",
+                           DICTBIN_VERSION, (unsigned long)pathHash, (unsigned long)sourceSize,
+                           (unsigned long)writeTime.dwHighDateTime, (unsigned long)writeTime.dwLowDateTime);
+    return written > 0 && (size_t)written < size;
+}
+
+HANDLE DictBinary_LockShared(const char *name) {
+    char lockName[MAX_PATH];
+    snprintf(lockName, sizeof(lockName), "%s-lock", name);
+    
+    // An abandoned mutex is still ours; its holder died before publishing
+    HANDLE lock = CreateMutex(NULL, FALSE, lockName);
+    if (lock) WaitForSingleObject(lock, INFINITE);
+    return lock;
+}
+
+void DictBinary_UnlockShared(HANDLE lock) {
+    if (!lock) return;
+    ReleaseMutex(lock);
+    CloseHandle(lock);
+}
+
+BOOL DictBinary_OpenShared(DictBinary *bin, const char *name, const char *binPath, const char *sourcePath) {
+    if (!bin || !name) return FALSE;
+    memset(bin, 0, sizeof(DictBinary));
+    
+    bin->mapping = OpenFileMapping(FILE_MAP_READ, FALSE, name);
+    if (!bin->mapping) {
+        return binPath && MapFile(bin, binPath, sourcePath, name);
+    }
+    
+    MEMORY_BASIC_INFORMATION info;
+    bin->view = (const BYTE *)MapViewOfFile(bin->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!bin->view || VirtualQuery(bin->view, &info, sizeof(info)) != sizeof(info) ||
+        !AttachImage(bin, info.RegionSize, FALSE)) {
+        DictBinary_Close(bin);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+BOOL DictBinary_Publish(DictBinary *bin, const char *name, const BYTE *image, DWORD size) {
+    if (!bin || !name || !image) return FALSE;
+    memset(bin, 0, sizeof(DictBinary));
+    
+    // Someone else's object under the name can't be trusted to be an image
+    bin->mapping = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, size, name);
+    if (!bin->mapping || GetLastError() == ERROR_ALREADY_EXISTS) goto fail;
+    
+    BYTE *fill = (BYTE *)MapViewOfFile(bin->mapping, FILE_MAP_WRITE, 0, 0, size);
+    if (!fill) goto fail;
+    memcpy(fill, image, size);
+    UnmapViewOfFile(fill);
+    
+    bin->view = (const BYTE *)MapViewOfFile(bin->mapping, FILE_MAP_READ, 0, 0, size);
+    if (!bin->view || !AttachImage(bin, size, TRUE)) goto fail;
+    return TRUE;
+    
+fail:
+    DictBinary_Close(bin);
+    return FALSE;
+}
+
+BOOL DictBinary_Lookup(const DictBinary *bin, const char *word, size_t len) {
+    if (!bin || !bin->header || !word || len == 0) return FALSE;
+    
+    DWORD hash = WordTable_HashView(word, len);
+    DWORD mask = bin->header->slotCount - 1;
+    for (DWORD slot = hash & mask; bin->slots[slot] != 0; slot = (slot + 1) & mask) {
+        DWORD index = bin->slots[slot] - 1;
+        if (bin->hashes[index] == hash && WordTable_KeyEquals(bin->blob + bin->offsets[index], word, len)) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+int DictBinary_Query(const DictBinary *bin, const char *word, int maxDistance, BKTreeMatch *matches, int maxMatches) {
+    if (!bin || !bin->header || bin->header->nodeCount == 0 || !word || !matches || maxMatches <= 0) return 0;
+    
+    const DictBinaryNode *nodes = bin->nodes;
+    int *stack = (int *)malloc(bin->header->nodeCount * sizeof(int));
+    if (!stack) return 0;
+    
+    EditDistanceQuery query;
+    EditDistance_Init(&query);
+    EditDistance_Prepare(&query, word);
+    
+    // Same walk and pruning as BKTree_Query
+    int found = 0;
+    int bound = maxDistance;
+    int top = 0;
+    stack[top++] = 0;
+    
+    while (top > 0) {
+        const DictBinaryNode *node = &nodes[stack[--top]];
+        const char *key = bin->blob + node->word;
+        
+        int maxEdge = 0;
+        for (int child = node->firstChild; child >= 0; child = nodes[child].nextSibling) {
+            if (nodes[child].distance > maxEdge) maxEdge = nodes[child].distance;
+        }
+        int d = EditDistance_Bounded(&query, key, bound + maxEdge);
+        
+        if (d > 0 && d <= bound) {
+            BKTree_AddMatch(matches, &found, maxMatches, key, d);
+            if (found == maxMatches && matches[found - 1].distance < bound) {
+                bound = matches[found - 1].distance;
+            }
+        }
+        
+        for (int child = node->firstChild; child >= 0; child = nodes[child].nextSibling) {
+            int edge = nodes[child].distance;
+            if (edge >= d - bound && edge <= d + bound && top < (int)bin->header->nodeCount) {
+                stack[top++] = child;
+            }
+        }
+    }
+    
+    EditDistance_Free(&query);
+    free(stack);
+    return found;
+}
+
+void DictBinary_Close(DictBinary *bin) {
+    if (!bin) return;
+    if (bin->view) UnmapViewOfFile(bin->view);
+    if (bin->mapping) CloseHandle(bin->mapping);
+    if (bin->file) CloseHandle(bin->file);
+    memset(bin, 0, sizeof(DictBinary));
+}
@@ -0,0 +1,96 @@
+#ifndef DICTBINARY_H
+#define DICTBINARY_H
+
+#include <windows.h>
+#include "bktree.h"
+
+// Compiled dictionary image (dictionary.bin), produced from dictionary.txt by
+// "Logger.exe --compile-dictionary". Layout, all little-endian:
+//
+//   DictBinaryHeader
+//   DWORD          offsets[wordCount]   blob offset of each key, in sorted order
+//   DWORD          hashes[wordCount]    WordTable_Hash of each key
+//   DWORD          slots[slotCount]     hash table: word index + 1, 0 = empty
+//   DictBinaryNode nodes[nodeCount]     serialized suggestion BK-tree
+//   char           blob[blobSize]       "key\0Original\0" pairs
+//
+// The blob uses the same entry layout as the in-memory dictionaries, and
+// lookups and suggestion searches run against the image itself, so a mapped
+// image is used in place with nothing copied into the process. Published
+// under a name (DictBinary_OpenShared), one copy serves every Logger running
+// in the session.
+#define DICTBIN_MAGIC   0x4E494244u  // "DBIN"
+#define DICTBIN_VERSION 4            // 2: keys fold letters outside ASCII; 3: hash table; 4: Latin Extended-B folds
+#define DICTBIN_MIN_SLOTS 16
+
+typedef struct {
+    DWORD magic;
+    DWORD version;
+    DWORD wordCount;
+    DWORD nodeCount;
+    DWORD blobSize;
+    DWORD checksum;          // FNV-1a over everything after the header
+    DWORD sourceSize;        // Size of the text dictionary it was built from
+    DWORD sourceTimeLow;     // Last write time of that file
+    DWORD sourceTimeHigh;
+    DWORD slotCount;         // Power of two, at least twice wordCount
+} DictBinaryHeader;
+
+typedef struct {
+    DWORD word;              // Blob offset of the node's key
+    int firstChild;
+    int nextSibling;
+    int distance;
+} DictBinaryNode;
+
+typedef struct {
+    HANDLE file;
+    HANDLE mapping;
+    const BYTE *view;
+    const DictBinaryHeader *header;
+    const DWORD *offsets;
+    const DWORD *hashes;
+    const DWORD *slots;
+    const DictBinaryNode *nodes;
+    const char *blob;
+} DictBinary;
+
+// Lay out an image for the sorted keys in words[] and the tree indexing
+// them, stamped with the size and write time of sourcePath. Returns the
+// malloc'd image and its size, or NULL.
+BYTE *DictBinary_Build(const char *sourcePath, char **words, int wordCount, const BKTree *tree, DWORD *imageSize);
+
+// DictBinary_Build straight to binPath
+BOOL DictBinary_Write(const char *binPath, const char *sourcePath, char **words, int wordCount, const BKTree *tree);
+
+// Map an image read-only. Fails if it is missing, corrupt, from another
+// format version, or older than sourcePath (when sourcePath exists).
+BOOL DictBinary_Open(DictBinary *bin, const char *binPath, const char *sourcePath);
+void DictBinary_Close(DictBinary *bin);
+
+// Name other processes find the image of path under; it changes whenever
+// the file does, so an edited dictionary is never served stale. FALSE if
+// path doesn't exist.
+BOOL DictBinary_SharedName(const char *path, char *name, size_t size);
+
+// Serialize DictBinary_OpenShared/DictBinary_Publish for name across
+// processes, so none maps an image another is still filling in
+HANDLE DictBinary_LockShared(const char *name);
+void DictBinary_UnlockShared(HANDLE lock);
+
+// Map the image published under name, or else binPath (as DictBinary_Open
+// would) published under name for the processes that come after
+BOOL DictBinary_OpenShared(DictBinary *bin, const char *name, const char *binPath, const char *sourcePath);
+
+// Publish an image built in memory (DictBinary_Build) under name, backed by
+// the paging file, and map it read-only. It lives until the last process
+// mapping it closes it.
+BOOL DictBinary_Publish(DictBinary *bin, const char *name, const BYTE *image, DWORD size);
+
+// Whether the first len bytes of word (any case) are a key in the image
+BOOL DictBinary_Lookup(const DictBinary *bin, const char *word, size_t len);
+
+// BKTree_Query over the image's serialized tree
+int DictBinary_Query(const DictBinary *bin, const char *word, int maxDistance, BKTreeMatch *matches, int maxMatches);
+
+#endif // DICTBINARY_H
@@ -0,0 +1,139 @@
+#include "editdistance.h"
+#include <stdlib.h>
+#include <string.h>
+
+static __inline unsigned char FoldCase(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') ? (unsigned char)(c + ('a' - 'A')) : c;
+}
+
+void EditDistance_Init(EditDistanceQuery *query) {
+    if (!query) return;
+    memset(query, 0, sizeof(EditDistanceQuery));
+}
+
+void EditDistance_Free(EditDistanceQuery *query) {
+    if (!query) return;
+    free(query->row);
+    EditDistance_Init(query);
+}
+
+void EditDistance_Prepare(EditDistanceQuery *query, const char *word) {
+    if (!query) return;
+    
+    // Clear what the previous query set rather than the whole 2 KB table
+    int previous = query->len < EDITDISTANCE_MAX_PATTERN ? query->len : EDITDISTANCE_MAX_PATTERN;
+    for (int i = 0; i < previous; i++) {
+        unsigned char c = query->folded[i];
+        query->peq[c] = 0;
+        if (c >= 'a' && c <= 'z') query->peq[c - ('a' - 'A')] = 0;
+    }
+    
+    query->word = word ? word : "";
+    query->len = (int)strlen(query->word);
+    if (query->len > EDITDISTANCE_MAX_PATTERN) return;  // Banded DP reads word directly
+    
+    for (int i = 0; i < query->len; i++) {
+        unsigned char c = FoldCase((unsigned char)query->word[i]);
+        query->folded[i] = c;
+        query->peq[c] |= 1ULL << i;
+        if (c >= 'a' && c <= 'z') query->peq[c - ('a' - 'A')] |= 1ULL << i;
+    }
+}
+
+// Myers/Hyyro bit-vector edit distance. Column j of the DP is kept as the
+// vertical +1/-1 deltas pv/mv; score tracks the bottom cell D[m][j].
+static int MyersDistance(const EditDistanceQuery *query, const char *candidate, int candidateLen, int maxDistance) {
+    ULONGLONG pv = ~0ULL;
+    ULONGLONG mv = 0;
+    ULONGLONG high = 1ULL << (query->len - 1);
+    int score = query->len;
+    
+    for (int j = 0; j < candidateLen; j++) {
+        ULONGLONG eq = query->peq[(unsigned char)candidate[j]];
+        ULONGLONG xv = eq | mv;
+        ULONGLONG xh = (((eq & pv) + pv) ^ pv) | eq;
+        ULONGLONG ph = mv | ~(xh | pv);
+        ULONGLONG mh = pv & xh;
+    
+        if (ph & high) score++;
+        else if (mh & high) score--;
+    
+        // Each remaining candidate character lowers the score by at most one
+        if (score - (candidateLen - 1 - j) > maxDistance) return maxDistance + 1;
+    
+        // Row 0 of a global alignment grows by one per column
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+    }
+    return score <= maxDistance ? score : maxDistance + 1;
+}
+
+// Ukkonen's band: only cells with |i - j| <= maxDistance can stay within the
+// bound, everything outside is pinned at maxDistance + 1
+static int BandedDistance(EditDistanceQuery *query, const char *candidate, int candidateLen, int maxDistance) {
+    int limit = maxDistance + 1;
+    if (candidateLen + 1 > query->rowCapacity) {
+        int *newRow = (int *)realloc(query->row, (candidateLen + 1) * sizeof(int));
+        if (!newRow) return limit;
+        query->row = newRow;
+        query->rowCapacity = candidateLen + 1;
+    }
+    
+    int *d = query->row;
+    for (int j = 0; j <= candidateLen; j++) {
+        d[j] = j < limit ? j : limit;
+    }
+    
+    for (int i = 1; i <= query->len; i++) {
+        unsigned char c1 = FoldCase((unsigned char)query->word[i - 1]);
+        int lo = i - maxDistance > 1 ? i - maxDistance : 1;
+        int hi = maxDistance < candidateLen - i ? i + maxDistance : candidateLen;
+    
+        // The cell left of the band is outside it from this row on
+        int prevDiag = d[lo - 1];
+        d[lo - 1] = (lo == 1 && i < limit) ? i : limit;
+    
+        int rowMin = d[lo - 1];
+        for (int j = lo; j <= hi; j++) {
+            int cost = (c1 == FoldCase((unsigned char)candidate[j - 1])) ? 0 : 1;
+            int best = prevDiag + cost;
+            if (d[j] + 1 < best) best = d[j] + 1;
+            if (d[j - 1] + 1 < best) best = d[j - 1] + 1;
+            prevDiag = d[j];
+            d[j] = best < limit ? best : limit;
+            if (d[j] < rowMin) rowMin = d[j];
+        }
+        if (rowMin >= limit) return limit;
+    }
+    return d[candidateLen];
+}
+
+int EditDistance_Bounded(EditDistanceQuery *query, const char *candidate, int maxDistance) {
+    if (!query || !candidate || maxDistance < 0) return maxDistance + 1;
+    
+    int candidateLen = (int)strlen(candidate);
+    int lengthGap = candidateLen > query->len ? candidateLen - query->len : query->len - candidateLen;
+    if (lengthGap > maxDistance) return maxDistance + 1;
+    
+    if (query->len == 0) return candidateLen;
+    if (candidateLen == 0) return query->len;
+    
+    if (query->len <= EDITDISTANCE_MAX_PATTERN) {
+        return MyersDistance(query, candidate, candidateLen, maxDistance);
+    }
+    return BandedDistance(query, candidate, candidateLen, maxDistance);
+}
+
+int EditDistance_Batch(EditDistanceQuery *query, const char * const *candidates, int count, int maxDistance,
+                       int *distances) {
+    if (!query || !candidates || !distances) return 0;
+    
+    int within = 0;
+    for (int i = 0; i < count; i++) {
+        distances[i] = EditDistance_Bounded(query, candidates[i], maxDistance);
+        if (distances[i] <= maxDistance) within++;
+    }
+    return within;
+}
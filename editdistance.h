@@ -0,0 +1,44 @@
+#ifndef EDITDISTANCE_H
+#define EDITDISTANCE_H
+
+#include <windows.h>
+
+// Bounded, case-insensitive Levenshtein distance for suggestion ranking.
+// A query is prepared once and then scored against many candidates:
+// queries up to EDITDISTANCE_MAX_PATTERN characters use Myers' bit-parallel
+// algorithm (one 64-bit step per candidate character), longer ones a banded
+// DP in a row buffer the query keeps between calls. Both stop as soon as
+// the distance is known to exceed the bound.
+
+#define EDITDISTANCE_MAX_PATTERN 64
+#define EDITDISTANCE_UNBOUNDED 0x3FFFFFFF  // maxDistance for an exact answer
+
+typedef struct {
+    ULONGLONG peq[256];    // Bit i set for the bytes matching query[i] in either case
+    unsigned char folded[EDITDISTANCE_MAX_PATTERN];  // Lowercased query, to reset peq
+    const char *word;      // The prepared query; must stay valid while in use
+    int len;
+    int *row;              // Banded DP scratch for long queries, grown on demand
+    int rowCapacity;
+} EditDistanceQuery;
+
+// Zero a query before its first Prepare
+void EditDistance_Init(EditDistanceQuery *query);
+
+// Release the scratch row
+void EditDistance_Free(EditDistanceQuery *query);
+
+// Make word the query scored by the calls below. Cheap to repeat; only the
+// previous query's entries are cleared.
+void EditDistance_Prepare(EditDistanceQuery *query, const char *word);
+
+// Distance from the query to candidate, or maxDistance + 1 if it is larger.
+// Candidates whose length differs by more than maxDistance cost a strlen.
+int EditDistance_Bounded(EditDistanceQuery *query, const char *candidate, int maxDistance);
+
+// Score candidates[0, count) into distances[] (same convention as
+// EditDistance_Bounded). Returns how many are within maxDistance.
+int EditDistance_Batch(EditDistanceQuery *query, const char * const *candidates, int count, int maxDistance,
+                       int *distances);
+
+#endif // EDITDISTANCE_H
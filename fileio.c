@@ -0,0 +1,68 @@
+#include "fileio.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+BOOL FileIO_ReadAt(HANDLE file, LONGLONG offset, void *buffer, DWORD len, DWORD *bytesRead) {
+    LARGE_INTEGER pos;
+    pos.QuadPart = offset;
+    *bytesRead = 0;
+    if (!SetFilePointerEx(file, pos, NULL, FILE_BEGIN)) return FALSE;
+    
+    while (*bytesRead < len) {
+        DWORD got = 0;
+        if (!ReadFile(file, (char *)buffer + *bytesRead, len - *bytesRead, &got, NULL)) return FALSE;
+        if (got == 0) break;
+        *bytesRead += got;
+    }
+    return TRUE;
+}
+
+BOOL FileIO_Write(HANDLE file, const void *data, DWORD len, DWORD *written) {
+    *written = 0;
+    while (*written < len) {
+        DWORD done = 0;
+        if (!WriteFile(file, (const char *)data + *written, len - *written, &done, NULL) || done == 0) {
+            return FALSE;
+        }
+        *written += done;
+    }
+    return TRUE;
+}
+
+BOOL FileIO_WriteAll(HANDLE file, const void *data, DWORD len) {
+    DWORD written;
+    return FileIO_Write(file, data, len, &written);
+}
+
+DWORD FileIO_Checksum(DWORD hash, const void *data, size_t len) {
+    const BYTE *p = (const BYTE *)data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+BOOL FileIO_AddPath(PathList *list, const char *dir, size_t dirLen, const char *name) {
+    if (list->count >= list->capacity) {
+        int newCapacity = list->capacity > 0 ? list->capacity * 2 : 64;
+        char (*newPaths)[MAX_PATH] = realloc(list->paths, newCapacity * sizeof(*newPaths));
+        if (!newPaths) return FALSE;
+        list->paths = newPaths;
+        list->capacity = newCapacity;
+    }
+    if (dirLen + strlen(name) >= MAX_PATH) return FALSE;
+    
+    memcpy(list->paths[list->count], dir, dirLen);
+    strcpy(list->paths[list->count] + dirLen, name);
+    list->count++;
+    return TRUE;
+}
+
+void FileIO_AttachParentConsole(void) {
+    if (GetStdHandle(STD_OUTPUT_HANDLE) == NULL && AttachConsole(ATTACH_PARENT_PROCESS)) {
+        freopen("CONOUT$", "w", stdout);
+        freopen("CONOUT$", "w", stderr);
+    }
+}
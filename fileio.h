@@ -0,0 +1,40 @@
+#ifndef FILEIO_H
+#define FILEIO_H
+
+#include <windows.h>
+
+// File and console helpers shared by the log, archive, index and
+// dictionary modules and the command-line modes.
+#define FILEIO_CHECKSUM_SEED 2166136261u  // FNV-1a offset basis
+
+// Read up to len bytes at offset; *bytesRead comes up short only at the end
+// of the file
+BOOL FileIO_ReadAt(HANDLE file, LONGLONG offset, void *buffer, DWORD len, DWORD *bytesRead);
+
+// Write len bytes at the file pointer. *written counts the bytes that made
+// it, also when the write fails partway.
+BOOL FileIO_Write(HANDLE file, const void *data, DWORD len, DWORD *written);
+
+// FileIO_Write for callers that only care whether everything made it
+BOOL FileIO_WriteAll(HANDLE file, const void *data, DWORD len);
+
+// FNV-1a of data, chained across pieces by passing the previous result;
+// start from FILEIO_CHECKSUM_SEED
+DWORD FileIO_Checksum(DWORD hash, const void *data, size_t len);
+
+// Growable list of paths; free paths when done
+typedef struct {
+    char (*paths)[MAX_PATH];
+    int count;
+    int capacity;
+} PathList;
+
+// Append the first dirLen bytes of dir followed by name. FALSE if out of
+// memory or the result would not fit in MAX_PATH.
+BOOL FileIO_AddPath(PathList *list, const char *dir, size_t dirLen, const char *name);
+
+// A GUI-subsystem build has no console of its own; borrow the caller's so
+// reports and errors are visible when not redirected
+void FileIO_AttachParentConsole(void);
+
+#endif // FILEIO_H
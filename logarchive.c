@@ -0,0 +1,408 @@
+#include "logarchive.h"
+#include "fileio.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LOGARCHIVE_ALGORITHM (COMPRESS_ALGORITHM_XPRESS_HUFF | COMPRESS_RAW)
+
+static BOOL AddBlock(LogArchive *archive, const LogArchiveBlock *block) {
+    if (archive->blockCount >= archive->blockCapacity) {
+        int newCapacity = archive->blockCapacity > 0 ? archive->blockCapacity * 2 : 64;
+        LogArchiveBlock *grown = (LogArchiveBlock *)realloc(archive->blocks, newCapacity * sizeof(LogArchiveBlock));
+        if (!grown) return FALSE;
+        archive->blocks = grown;
+        archive->blockCapacity = newCapacity;
+    }
+    archive->blocks[archive->blockCount++] = *block;
+    return TRUE;
+}
+
+// Whether block, found at archive offset pos after prev (NULL for the
+// first), is one an export could have written: its data follows its header
+// and ends by limit, its sizes fit a block buffer, and its log bytes carry on
+// from prev's or start a newer generation at offset 0
+static BOOL ValidBlock(const LogArchiveBlock *block, const LogArchiveBlock *prev, LONGLONG pos, LONGLONG limit) {
+    if (block->magic != LOGARCHIVE_BLOCK_MAGIC || block->dataOffset != pos + (LONGLONG)sizeof(LogArchiveBlock) ||
+        block->rawSize == 0 || block->rawSize > LOGARCHIVE_BLOCK_SIZE || block->storedSize > block->rawSize ||
+        block->dataOffset + block->storedSize > limit) {
+        return FALSE;
+    }
+    if (prev && block->generation == prev->generation) {
+        return block->logOffset == prev->logOffset + prev->rawSize;
+    }
+    return block->logOffset == 0 && (!prev || block->generation > prev->generation);
+}
+
+// Recover the block list after a torn export: blocks are taken in file order
+// while each is valid and its data fits in the file
+static void WalkBlocks(LogArchive *archive, HANDLE file, LONGLONG fileSize) {
+    LONGLONG pos = sizeof(LogArchiveHeader);
+    LogArchiveBlock block;
+    DWORD got;
+    while (FileIO_ReadAt(file, pos, &block, sizeof(block), &got) && got == sizeof(block)) {
+        const LogArchiveBlock *prev = archive->blockCount > 0 ? &archive->blocks[archive->blockCount - 1] : NULL;
+        if (!ValidBlock(&block, prev, pos, fileSize) || !AddBlock(archive, &block)) break;
+        pos = block.dataOffset + block.storedSize;
+    }
+    archive->indexOffset = pos;
+}
+
+// Check a loaded index entry by entry, as WalkBlocks would find the blocks;
+// the last one has to end where the index starts
+static BOOL ValidIndex(const LogArchive *archive, LONGLONG indexOffset) {
+    LONGLONG pos = sizeof(LogArchiveHeader);
+    for (int i = 0; i < archive->blockCount; i++) {
+        const LogArchiveBlock *block = &archive->blocks[i];
+        if (!ValidBlock(block, i > 0 ? &archive->blocks[i - 1] : NULL, pos, indexOffset)) return FALSE;
+        pos = block->dataOffset + block->storedSize;
+    }
+    return pos == indexOffset;
+}
+
+static BOOL LoadBlocks(LogArchive *archive, HANDLE file) {
+    LogArchiveHeader header;
+    LARGE_INTEGER size;
+    DWORD got;
+    if (!GetFileSizeEx(file, &size) || !FileIO_ReadAt(file, 0, &header, sizeof(header), &got)) return FALSE;
+    if (got != sizeof(header) || header.magic != LOGARCHIVE_MAGIC || header.version != LOGARCHIVE_VERSION ||
+        header.blockSize != LOGARCHIVE_BLOCK_SIZE) {
+        return FALSE;
+    }
+    archive->algorithm = header.algorithm;
+    
+    // The footer is trusted only when the index it points at ends right at
+    // it, matches its checksum, and describes blocks laid out as written
+    LogArchiveFooter footer;
+    LONGLONG footerOffset = size.QuadPart - (LONGLONG)sizeof(footer);
+    BOOL indexed = footerOffset >= (LONGLONG)sizeof(header) &&
+                   FileIO_ReadAt(file, footerOffset, &footer, sizeof(footer), &got) && got == sizeof(footer) &&
+                   footer.magic == LOGARCHIVE_FOOTER_MAGIC && footer.indexOffset >= (LONGLONG)sizeof(header) &&
+                   footer.blockCount <= MAXDWORD / sizeof(LogArchiveBlock) &&
+                   footer.indexOffset + (LONGLONG)footer.blockCount * (LONGLONG)sizeof(LogArchiveBlock) == footerOffset;
+    if (indexed && footer.blockCount > 0) {
+        DWORD bytes = footer.blockCount * (DWORD)sizeof(LogArchiveBlock);
+        archive->blocks = (LogArchiveBlock *)malloc(bytes);
+        if (!archive->blocks) return FALSE;
+        archive->blockCapacity = (int)footer.blockCount;
+        indexed = FileIO_ReadAt(file, footer.indexOffset, archive->blocks, bytes, &got) && got == bytes &&
+                  FileIO_Checksum(FILEIO_CHECKSUM_SEED, archive->blocks, bytes) == footer.indexChecksum;
+        archive->blockCount = indexed ? (int)footer.blockCount : 0;
+    }
+    if (indexed && !ValidIndex(archive, footer.indexOffset)) {
+        indexed = FALSE;
+        archive->blockCount = 0;
+    }
+    if (indexed) {
+        archive->indexOffset = footer.indexOffset;
+        archive->logFileId = footer.logFileId;
+        archive->logVolume = footer.logVolume;
+    } else {
+        // Without the footer the log's identity is unknown, so the next
+        // export starts a new generation
+        WalkBlocks(archive, file, size.QuadPart);
+    }
+    
+    archive->firstCurrent = archive->blockCount;
+    while (archive->firstCurrent > 0 &&
+           archive->blocks[archive->firstCurrent - 1].generation == archive->blocks[archive->blockCount - 1].generation) {
+        archive->firstCurrent--;
+    }
+    return TRUE;
+}
+
+BOOL LogArchive_Open(LogArchive *archive, const char *path) {
+    if (!archive || !path) return FALSE;
+    memset(archive, 0, sizeof(LogArchive));
+    snprintf(archive->path, sizeof(archive->path), "%s", path);
+    archive->indexOffset = sizeof(LogArchiveHeader);
+    archive->algorithm = LOGARCHIVE_ALGORITHM;
+    archive->cachedBlock = -1;
+    
+    HANDLE file = CreateFile(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return GetLastError() == ERROR_FILE_NOT_FOUND;
+    
+    BOOL ok = LoadBlocks(archive, file);
+    CloseHandle(file);
+    if (!ok) {
+        free(archive->blocks);
+        archive->blocks = NULL;
+        archive->blockCount = archive->blockCapacity = 0;
+    }
+    return ok;
+}
+
+// Drop the read handle and cached block, e.g. before the file is written
+static void CloseReader(LogArchive *archive) {
+    if (archive->file) CloseHandle(archive->file);
+    if (archive->decompressor) CloseDecompressor(archive->decompressor);
+    free(archive->cache);
+    archive->file = NULL;
+    archive->decompressor = NULL;
+    archive->cache = NULL;
+    archive->cachedBlock = -1;
+}
+
+void LogArchive_Close(LogArchive *archive) {
+    if (!archive) return;
+    CloseReader(archive);
+    free(archive->blocks);
+    archive->blocks = NULL;
+    archive->blockCount = archive->blockCapacity = 0;
+}
+
+LONGLONG LogArchive_Size(const LogArchive *archive) {
+    if (!archive || archive->blockCount == 0) return 0;
+    const LogArchiveBlock *last = &archive->blocks[archive->blockCount - 1];
+    return last->logOffset + last->rawSize;
+}
+
+// Whether the log still starts with everything the newest generation holds:
+// the same file, no shorter, and every archived block unchanged. A View mode
+// save can patch the log in place, keeping its file ID, so any block may
+// have changed; checking them reads the log but compresses nothing.
+static BOOL ExtendsArchive(LogArchive *archive, HANDLE log, const BY_HANDLE_FILE_INFORMATION *info,
+                           LONGLONG logSize, char *scratch) {
+    if (archive->blockCount == 0) return FALSE;
+    ULONGLONG fileId = ((ULONGLONG)info->nFileIndexHigh << 32) | info->nFileIndexLow;
+    if (fileId != archive->logFileId || info->dwVolumeSerialNumber != archive->logVolume) return FALSE;
+    if (logSize < LogArchive_Size(archive)) return FALSE;
+    
+    for (int i = archive->firstCurrent; i < archive->blockCount; i++) {
+        const LogArchiveBlock *block = &archive->blocks[i];
+        DWORD got;
+        if (!FileIO_ReadAt(log, block->logOffset, scratch, block->rawSize, &got) || got != block->rawSize ||
+            FileIO_Checksum(FILEIO_CHECKSUM_SEED, scratch, got) != block->checksum) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+static BOOL WriteIndex(LogArchive *archive, HANDLE file) {
+    LARGE_INTEGER pos;
+    pos.QuadPart = archive->indexOffset;
+    if (!SetFilePointerEx(file, pos, NULL, FILE_BEGIN)) return FALSE;
+    if (archive->blockCount > 0 &&
+        !FileIO_WriteAll(file, archive->blocks, archive->blockCount * (DWORD)sizeof(LogArchiveBlock))) {
+        return FALSE;
+    }
+    
+    LogArchiveFooter footer = {0};
+    footer.magic = LOGARCHIVE_FOOTER_MAGIC;
+    footer.blockCount = (DWORD)archive->blockCount;
+    footer.indexOffset = archive->indexOffset;
+    footer.logFileId = archive->logFileId;
+    footer.logVolume = archive->logVolume;
+    footer.indexChecksum = FileIO_Checksum(FILEIO_CHECKSUM_SEED, archive->blocks,
+                                           archive->blockCount * sizeof(LogArchiveBlock));
+    return FileIO_WriteAll(file, &footer, sizeof(footer)) && SetEndOfFile(file) && FlushFileBuffers(file);
+}
+
+BOOL LogArchive_Append(LogArchive *archive, const char *logPath, LogArchiveProgress progress, void *context) {
+    if (!archive || !logPath) return FALSE;
+    
+    HANDLE log = CreateFile(logPath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (log == INVALID_HANDLE_VALUE) return FALSE;
+    
+    BY_HANDLE_FILE_INFORMATION info;
+    LARGE_INTEGER size;
+    char *raw = (char *)malloc(LOGARCHIVE_BLOCK_SIZE);
+    char *packed = (char *)malloc(LOGARCHIVE_BLOCK_SIZE);
+    if (!raw || !packed || !GetFileInformationByHandle(log, &info) || !GetFileSizeEx(log, &size)) {
+        free(raw);
+        free(packed);
+        CloseHandle(log);
+        return FALSE;
+    }
+    
+    LONGLONG start = 0;
+    DWORD generation = archive->blockCount > 0 ? archive->blocks[archive->blockCount - 1].generation : 0;
+    if (ExtendsArchive(archive, log, &info, size.QuadPart, raw)) {
+        start = LogArchive_Size(archive);
+    } else {
+        generation++;
+    }
+    if (start == size.QuadPart && archive->blockCount > 0) {
+        // Nothing new since the last export
+        free(raw);
+        free(packed);
+        CloseHandle(log);
+        return TRUE;
+    }
+    
+    CloseReader(archive);
+    HANDLE file = CreateFile(archive->path, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_ALWAYS,
+                             FILE_ATTRIBUTE_NORMAL, NULL);
+    COMPRESSOR_HANDLE compressor = NULL;
+    BOOL ok = file != INVALID_HANDLE_VALUE && CreateCompressor(archive->algorithm, NULL, &compressor);
+    if (ok && archive->blockCount == 0) {
+        LogArchiveHeader header = { LOGARCHIVE_MAGIC, LOGARCHIVE_VERSION, archive->algorithm, LOGARCHIVE_BLOCK_SIZE };
+        LARGE_INTEGER zero;
+        zero.QuadPart = 0;
+        archive->indexOffset = sizeof(header);
+        ok = SetFilePointerEx(file, zero, NULL, FILE_BEGIN) && FileIO_WriteAll(file, &header, sizeof(header));
+    }
+    if (start == 0) archive->firstCurrent = archive->blockCount;
+    
+    // Blocks go where the old index was; the index is rewritten after them
+    BOOL cancelled = FALSE;
+    LARGE_INTEGER pos;
+    pos.QuadPart = archive->indexOffset;
+    ok = ok && SetFilePointerEx(file, pos, NULL, FILE_BEGIN);
+    for (LONGLONG offset = start; ok && offset < size.QuadPart; ) {
+        DWORD want = (DWORD)min(size.QuadPart - offset, (LONGLONG)LOGARCHIVE_BLOCK_SIZE);
+        DWORD got;
+        if (!FileIO_ReadAt(log, offset, raw, want, &got) || got == 0) break;
+    
+        LogArchiveBlock block = {0};
+        block.magic = LOGARCHIVE_BLOCK_MAGIC;
+        block.generation = generation;
+        block.logOffset = offset;
+        block.dataOffset = archive->indexOffset + sizeof(block);
+        block.rawSize = got;
+        block.checksum = FileIO_Checksum(FILEIO_CHECKSUM_SEED, raw, got);
+    
+        // Compress fails when the output doesn't fit, i.e. didn't shrink
+        SIZE_T packedSize = 0;
+        const char *data = packed;
+        if (Compress(compressor, raw, got, packed, got, &packedSize) && packedSize < got) {
+            block.storedSize = (DWORD)packedSize;
+        } else {
+            block.storedSize = got;
+            block.flags = LOGARCHIVE_STORED;
+            data = raw;
+        }
+    
+        ok = FileIO_WriteAll(file, &block, sizeof(block)) && FileIO_WriteAll(file, data, block.storedSize) &&
+             AddBlock(archive, &block);
+        if (!ok) break;
+        archive->indexOffset = block.dataOffset + block.storedSize;
+        offset += got;
+    
+        if (progress && !progress(offset - start, size.QuadPart - start, context)) {
+            cancelled = TRUE;
+            break;
+        }
+    }
+    
+    // Whatever blocks made it are indexed, so a cancelled or failed export
+    // leaves a consistent archive for the next one to extend
+    archive->logFileId = ((ULONGLONG)info.nFileIndexHigh << 32) | info.nFileIndexLow;
+    archive->logVolume = info.dwVolumeSerialNumber;
+    if (file != INVALID_HANDLE_VALUE) {
+        ok = WriteIndex(archive, file) && ok;
+        CloseHandle(file);
+    }
+    if (compressor) CloseCompressor(compressor);
+    free(raw);
+    free(packed);
+    CloseHandle(log);
+    
+    if (cancelled) {
+        SetLastError(ERROR_REQUEST_ABORTED);
+        return FALSE;
+    }
+    return ok;
+}
+
+// Newest-generation block holding log offset, or -1
+static int FindBlock(const LogArchive *archive, LONGLONG offset) {
+    int lo = archive->firstCurrent, hi = archive->blockCount - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        const LogArchiveBlock *block = &archive->blocks[mid];
+        if (offset < block->logOffset) {
+            hi = mid - 1;
+        } else if (offset >= block->logOffset + block->rawSize) {
+            lo = mid + 1;
+        } else {
+            return mid;
+        }
+    }
+    return -1;
+}
+
+// Decompress block index into archive->cache, unless it is already there
+static BOOL LoadBlock(LogArchive *archive, int index) {
+    if (archive->cachedBlock == index) return TRUE;
+    
+    if (!archive->file) {
+        HANDLE file = CreateFile(archive->path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                 FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) return FALSE;
+        archive->file = file;
+    }
+    if (!archive->cache) {
+        archive->cache = (char *)malloc(LOGARCHIVE_BLOCK_SIZE);
+        if (!archive->cache) return FALSE;
+    }
+    
+    const LogArchiveBlock *block = &archive->blocks[index];
+    archive->cachedBlock = -1;
+    DWORD got;
+    if (block->flags & LOGARCHIVE_STORED) {
+        if (!FileIO_ReadAt(archive->file, block->dataOffset, archive->cache, block->rawSize, &got) || got != block->rawSize) {
+            return FALSE;
+        }
+    } else {
+        if (!archive->decompressor && !CreateDecompressor(archive->algorithm, NULL, &archive->decompressor)) {
+            archive->decompressor = NULL;
+            return FALSE;
+        }
+        char *packed = (char *)malloc(block->storedSize);
+        if (!packed) return FALSE;
+        SIZE_T rawSize = 0;
+        BOOL ok = FileIO_ReadAt(archive->file, block->dataOffset, packed, block->storedSize, &got) &&
+                  got == block->storedSize &&
+                  Decompress(archive->decompressor, packed, block->storedSize, archive->cache, block->rawSize,
+                             &rawSize) &&
+                  rawSize == block->rawSize;
+        free(packed);
+        if (!ok) return FALSE;
+    }
+    
+    if (FileIO_Checksum(FILEIO_CHECKSUM_SEED, archive->cache, block->rawSize) != block->checksum) return FALSE;
+    archive->cachedBlock = index;
+    return TRUE;
+}
+
+int LogArchive_Read(LogArchive *archive, LONGLONG offset, char *out, DWORD len) {
+    if (!archive || !out || offset < 0) return -1;
+    
+    DWORD copied = 0;
+    while (copied < len) {
+        int index = FindBlock(archive, offset + copied);
+        if (index < 0) break;
+        if (!LoadBlock(archive, index)) return -1;
+    
+        const LogArchiveBlock *block = &archive->blocks[index];
+        DWORD at = (DWORD)(offset + copied - block->logOffset);
+        DWORD n = min(len - copied, block->rawSize - at);
+        memcpy(out + copied, archive->cache + at, n);
+        copied += n;
+    }
+    return (int)copied;
+}
+
+BOOL LogArchive_Extract(const char *archivePath, const char *outPath) {
+    LogArchive archive;
+    if (!LogArchive_Open(&archive, archivePath)) return FALSE;
+    
+    HANDLE out = CreateFile(outPath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    char *chunk = (char *)malloc(LOGARCHIVE_BLOCK_SIZE);
+    BOOL ok = out != INVALID_HANDLE_VALUE && chunk;
+    LONGLONG total = LogArchive_Size(&archive);
+    for (LONGLONG offset = 0; ok && offset < total; ) {
+        int got = LogArchive_Read(&archive, offset, chunk, LOGARCHIVE_BLOCK_SIZE);
+        ok = got > 0 && FileIO_WriteAll(out, chunk, (DWORD)got);
+        offset += got;
+    }
+    
+    free(chunk);
+    if (out != INVALID_HANDLE_VALUE) CloseHandle(out);
+    LogArchive_Close(&archive);
+    if (!ok) DeleteFile(outPath);
+    return ok;
+}
@@ -0,0 +1,101 @@
+#ifndef LOGARCHIVE_H
+#define LOGARCHIVE_H
+
+#include <windows.h>
+#include <compressapi.h>
+
+// Compressed monthly archive of the log (WorkLog_YYYY-MM.lga), written by
+// Export in --archive-exports mode instead of a full daily copy. Each export
+// appends only the log bytes added since the previous one, compressed in
+// independent blocks with the Windows Compression API (XPRESS + Huffman), so
+// a read decompresses only the blocks it touches. Layout, all little-endian:
+//
+//   LogArchiveHeader
+//   per block: LogArchiveBlock, BYTE data[storedSize]
+//   LogArchiveBlock index[blockCount]   copy of the block headers
+//   LogArchiveFooter
+//
+// A month's segment stands alone: its first export stores the whole log, so
+// older months can be deleted freely. When the log was replaced (View mode
+// saves a new file) or any of its archived bytes changed (View mode patched
+// it in place), the next export stores it again as a new generation and
+// reads use the newest. Every export checksums the archived prefix. An export
+// writes its blocks over the old index, then a fresh index and footer; if
+// that was cut short, or the index fails its checksum or doesn't describe
+// the blocks as they were laid out, opening walks the block headers instead.
+#define LOGARCHIVE_MAGIC        0x41474C57u  // "WLGA"
+#define LOGARCHIVE_BLOCK_MAGIC  0x42474C57u  // "WLGB"
+#define LOGARCHIVE_FOOTER_MAGIC 0x49474C57u  // "WLGI"
+#define LOGARCHIVE_VERSION      1
+#define LOGARCHIVE_BLOCK_SIZE   (256 * 1024) // Log bytes per block
+#define LOGARCHIVE_STORED       1            // Block flag: data is raw, compression didn't pay
+
+typedef struct {
+    DWORD magic;
+    DWORD version;
+    DWORD algorithm;         // COMPRESS_ALGORITHM_*
+    DWORD blockSize;
+} LogArchiveHeader;
+
+typedef struct {
+    DWORD magic;
+    DWORD generation;
+    LONGLONG logOffset;      // Where the block's bytes sit in the log
+    LONGLONG dataOffset;     // Where its data sits in the archive
+    DWORD rawSize;
+    DWORD storedSize;
+    DWORD checksum;          // FNV-1a of the raw bytes
+    DWORD flags;             // LOGARCHIVE_STORED
+} LogArchiveBlock;
+
+typedef struct {
+    DWORD magic;
+    DWORD blockCount;
+    LONGLONG indexOffset;
+    ULONGLONG logFileId;     // Identity of the log file archived last, to
+    DWORD logVolume;         // notice it being replaced
+    DWORD indexChecksum;     // FNV-1a of the index
+} LogArchiveFooter;
+
+// Callback for LogArchive_Append: done of total log bytes written so far;
+// returning FALSE stops the export (blocks already written are kept)
+typedef BOOL (*LogArchiveProgress)(LONGLONG done, LONGLONG total, void *context);
+
+typedef struct {
+    char path[MAX_PATH];
+    LogArchiveBlock *blocks;
+    int blockCount;
+    int blockCapacity;
+    int firstCurrent;        // First block of the newest generation
+    LONGLONG indexOffset;    // Where the next export starts writing
+    ULONGLONG logFileId;
+    DWORD logVolume;
+    DWORD algorithm;
+    HANDLE file;             // Opened for reads on first use
+    DECOMPRESSOR_HANDLE decompressor;
+    char *cache;             // Last block decompressed by LogArchive_Read
+    int cachedBlock;
+} LogArchive;
+
+// Load the archive at path; a missing file opens as an empty archive
+BOOL LogArchive_Open(LogArchive *archive, const char *path);
+
+void LogArchive_Close(LogArchive *archive);
+
+// Append what logPath gained since the last export, or all of it as a new
+// generation when it no longer extends the archived bytes. FALSE with
+// GetLastError() == ERROR_REQUEST_ABORTED if progress cancelled.
+BOOL LogArchive_Append(LogArchive *archive, const char *logPath, LogArchiveProgress progress, void *context);
+
+// Log bytes held by the newest generation
+LONGLONG LogArchive_Size(const LogArchive *archive);
+
+// Copy up to len log bytes starting at offset into out, decompressing only
+// the blocks that hold them. Returns the bytes copied (short at the end of
+// the archive), or -1 on a read or decompression error.
+int LogArchive_Read(LogArchive *archive, LONGLONG offset, char *out, DWORD len);
+
+// Write the newest generation out as a plain log file
+BOOL LogArchive_Extract(const char *archivePath, const char *outPath);
+
+#endif // LOGARCHIVE_H
@@ -0,0 +1,117 @@
+#include "logexport.h"
+#include "perfstats.h"
+#include "logarchive.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct LogExport {
+    char sourcePath[MAX_PATH];
+    char destPath[MAX_PATH];
+    HWND hwndNotify;
+    UINT progressMsg;
+    UINT doneMsg;
+    HANDLE thread;
+    volatile BOOL cancel;    // Polled by CopyFileEx between chunks
+    int lastPercent;
+    BOOL archive;            // destPath is a LogArchive to append to
+};
+
+static void PostPercent(LogExport *job, LONGLONG done, LONGLONG total) {
+    // Only post when the visible percentage moves
+    int percent = total > 0 ? (int)(done * 100 / total) : 100;
+    if (percent != job->lastPercent) {
+        job->lastPercent = percent;
+        PostMessage(job->hwndNotify, job->progressMsg, (WPARAM)percent, 0);
+    }
+}
+
+static DWORD CALLBACK CopyProgress(LARGE_INTEGER totalSize, LARGE_INTEGER transferred,
+                                   LARGE_INTEGER streamSize, LARGE_INTEGER streamTransferred,
+                                   DWORD streamNumber, DWORD reason, HANDLE source, HANDLE dest, LPVOID data) {
+    LogExport *job = (LogExport *)data;
+    (void)streamSize; (void)streamTransferred; (void)streamNumber; (void)reason; (void)source; (void)dest;
+    
+    if (job->cancel) return PROGRESS_CANCEL;
+    PostPercent(job, transferred.QuadPart, totalSize.QuadPart);
+    return PROGRESS_CONTINUE;
+}
+
+static BOOL ArchiveProgress(LONGLONG done, LONGLONG total, void *context) {
+    LogExport *job = (LogExport *)context;
+    if (job->cancel) return FALSE;
+    PostPercent(job, done, total);
+    return TRUE;
+}
+
+// Append to the archive; the thread's result uses CopyFileEx's conventions
+static BOOL ArchiveLog(LogExport *job) {
+    LogArchive archive;
+    if (!LogArchive_Open(&archive, job->destPath)) return FALSE;
+    BOOL ok = LogArchive_Append(&archive, job->sourcePath, ArchiveProgress, job);
+    DWORD error = GetLastError();
+    LogArchive_Close(&archive);
+    SetLastError(error);
+    return ok;
+}
+
+static DWORD WINAPI LogExportThread(LPVOID param) {
+    LogExport *job = (LogExport *)param;
+    
+    // A plain export is a block-level copy; the OS picks large unbuffered transfers
+    LogExportStatus status = LOGEXPORT_SUCCEEDED;
+    LONGLONG start = PerfStats_Start();
+    BOOL ok = job->archive ? ArchiveLog(job)
+                           : CopyFileEx(job->sourcePath, job->destPath, CopyProgress, job, (LPBOOL)&job->cancel, 0);
+    if (!ok) {
+        status = (job->cancel || GetLastError() == ERROR_REQUEST_ABORTED) ? LOGEXPORT_CANCELLED : LOGEXPORT_FAILED;
+    } else {
+        PerfStats_Stop(PERF_LOG_EXPORT, start);
+    }
+    
+    PostMessage(job->hwndNotify, job->doneMsg, (WPARAM)status, (LPARAM)job);
+    return 0;
+}
+
+static LogExport* StartJob(const char *sourcePath, const char *destPath, BOOL archive, HWND hwndNotify,
+                           UINT progressMsg, UINT doneMsg) {
+    if (!sourcePath || !destPath) return NULL;
+    
+    LogExport *job = (LogExport *)calloc(1, sizeof(LogExport));
+    if (!job) return NULL;
+    
+    snprintf(job->sourcePath, sizeof(job->sourcePath), "%s", sourcePath);
+    snprintf(job->destPath, sizeof(job->destPath), "%s", destPath);
+    job->hwndNotify = hwndNotify;
+    job->progressMsg = progressMsg;
+    job->doneMsg = doneMsg;
+    job->lastPercent = -1;
+    job->archive = archive;
+    
+    job->thread = CreateThread(NULL, 0, LogExportThread, job, 0, NULL);
+    if (!job->thread) {
+        free(job);
+        return NULL;
+    }
+    return job;
+}
+
+LogExport* LogExport_Start(const char *sourcePath, const char *destPath, HWND hwndNotify, UINT progressMsg, UINT doneMsg) {
+    return StartJob(sourcePath, destPath, FALSE, hwndNotify, progressMsg, doneMsg);
+}
+
+LogExport* LogExport_StartArchive(const char *sourcePath, const char *archivePath, HWND hwndNotify, UINT progressMsg,
+                                  UINT doneMsg) {
+    return StartJob(sourcePath, archivePath, TRUE, hwndNotify, progressMsg, doneMsg);
+}
+
+void LogExport_Cancel(LogExport *job) {
+    if (job) job->cancel = TRUE;
+}
+
+void LogExport_Finish(LogExport *job) {
+    if (!job) return;
+    WaitForSingleObject(job->thread, INFINITE);
+    CloseHandle(job->thread);
+    free(job);
+}
@@ -0,0 +1,33 @@
+#ifndef LOGEXPORT_H
+#define LOGEXPORT_H
+
+#include <windows.h>
+
+typedef enum {
+    LOGEXPORT_SUCCEEDED,
+    LOGEXPORT_CANCELLED,
+    LOGEXPORT_FAILED
+} LogExportStatus;
+
+// Background file copy for Export. Runs CopyFileEx on its own thread and
+// posts to hwndNotify:
+//   progressMsg  wParam = percent copied (0-100), sent when it changes
+//   doneMsg      wParam = LogExportStatus, lParam = LogExport*
+// The receiver of doneMsg calls LogExport_Finish to release the job.
+typedef struct LogExport LogExport;
+
+LogExport* LogExport_Start(const char *sourcePath, const char *destPath, HWND hwndNotify, UINT progressMsg, UINT doneMsg);
+
+// Same notifications for an archive export: appends what sourcePath gained
+// since the last one to the compressed archive at archivePath
+// (logarchive.h). A cancelled archive export keeps the blocks it wrote.
+LogExport* LogExport_StartArchive(const char *sourcePath, const char *archivePath, HWND hwndNotify, UINT progressMsg,
+                                  UINT doneMsg);
+
+// Ask the copy to stop; a partial destination file is removed
+void LogExport_Cancel(LogExport *job);
+
+// Wait for the thread to exit and free the job
+void LogExport_Finish(LogExport *job);
+
+#endif // LOGEXPORT_H
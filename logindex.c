@@ -0,0 +1,404 @@
+#include "logindex.h"
+#include "fileio.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define LOGINDEX_REALIGN_WINDOW 8   // Deleted entries skipped when matching a rewritten log
+
+// An entry header found while scanning the log
+typedef struct {
+    LONGLONG offset;
+    int minutes;
+} EntryHeader;
+
+static int CompareByStamp(const void *a, const void *b) {
+    const LogIndexRecord *ra = (const LogIndexRecord *)a;
+    const LogIndexRecord *rb = (const LogIndexRecord *)b;
+    if (ra->stamp != rb->stamp) return ra->stamp < rb->stamp ? -1 : 1;
+    if (ra->offset != rb->offset) return ra->offset < rb->offset ? -1 : 1;
+    return 0;
+}
+
+static int CompareByOffset(const void *a, const void *b) {
+    const LogIndexRecord *ra = (const LogIndexRecord *)a;
+    const LogIndexRecord *rb = (const LogIndexRecord *)b;
+    if (ra->offset != rb->offset) return ra->offset < rb->offset ? -1 : 1;
+    return 0;
+}
+
+static void UpdateOffsetOrder(LogIndex *index) {
+    index->offsetOrdered = TRUE;
+    for (int i = 1; i < index->count; i++) {
+        if (index->records[i].offset <= index->records[i - 1].offset) {
+            index->offsetOrdered = FALSE;
+            return;
+        }
+    }
+}
+
+void LogIndex_PathFor(const char *logPath, char *indexPath, size_t size) {
+    const char *dot = strrchr(logPath, '.');
+    const char *slash = strrchr(logPath, '\\');
+    if (!dot || (slash && dot < slash)) dot = logPath + strlen(logPath);
+    snprintf(indexPath, size, "%.*s.idx", (int)(dot - logPath), logPath);
+}
+
+// "[h:mmam]" at p; sets minutes since midnight
+static BOOL ParseEntryTime(const char *p, const char *end, int *minutes) {
+    if (end - p < 8 || p[0] != '[') return FALSE;
+    
+    int i = 1, hour = 0;
+    while (i < 3 && p[i] >= '0' && p[i] <= '9') hour = hour * 10 + (p[i++] - '0');
+    if (i == 1 || hour < 1 || hour > 12 || end - p < i + 6 || p[i] != ':') return FALSE;
+    
+    const char *m = p + i + 1;
+    if (m[0] < '0' || m[0] > '5' || m[1] < '0' || m[1] > '9') return FALSE;
+    if ((m[2] != 'a' && m[2] != 'p') || m[3] != 'm' || m[4] != ']') return FALSE;
+    
+    *minutes = ((hour % 12) + (m[2] == 'p' ? 12 : 0)) * 60 + (m[0] - '0') * 10 + (m[1] - '0');
+    return TRUE;
+}
+
+// Every line of the log that starts an entry
+static EntryHeader *ScanEntries(const char *text, LONGLONG size, int *count) {
+    int capacity = 256;
+    EntryHeader *headers = (EntryHeader *)malloc(capacity * sizeof(EntryHeader));
+    *count = 0;
+    if (!headers) return NULL;
+    
+    const char *end = text + size;
+    for (const char *line = text; line < end; ) {
+        int minutes;
+        if (ParseEntryTime(line, end, &minutes)) {
+            if (*count == capacity) {
+                capacity *= 2;
+                EntryHeader *grown = (EntryHeader *)realloc(headers, capacity * sizeof(EntryHeader));
+                if (!grown) {
+                    free(headers);
+                    return NULL;
+                }
+                headers = grown;
+            }
+            headers[*count].offset = line - text;
+            headers[*count].minutes = minutes;
+            (*count)++;
+        }
+        const char *nl = (const char *)memchr(line, '\n', end - line);
+        if (!nl) break;
+        line = nl + 1;
+    }
+    return headers;
+}
+
+// Dates for a log that never had an index: the last entry is taken to be
+// from the day the file was last written, and each time the clock runs
+// backwards between entries is a day boundary
+static void GuessStamps(HANDLE log, const EntryHeader *headers, int count, LogIndexRecord *records) {
+    FILETIME written;
+    time_t when = time(NULL);
+    if (GetFileTime(log, NULL, NULL, &written)) {
+        ULONGLONG ticks = ((ULONGLONG)written.dwHighDateTime << 32) | written.dwLowDateTime;
+        if (ticks > 116444736000000000ULL) when = (time_t)((ticks - 116444736000000000ULL) / 10000000ULL);
+    }
+    struct tm day = *localtime(&when);
+    day.tm_hour = 12;  // Away from DST transitions when stepping back
+    
+    for (int i = count - 1; i >= 0; i--) {
+        if (i < count - 1 && headers[i].minutes > headers[i + 1].minutes) {
+            day.tm_mday--;
+            mktime(&day);
+        }
+        records[i].stamp = LOGINDEX_STAMP(day.tm_year + 1900, day.tm_mon + 1, day.tm_mday, headers[i].minutes);
+    }
+}
+
+// Carry recorded dates over to the rescanned entries, matching them in file
+// order by time of day
+static void RealignStamps(const LogIndexRecord *old, int oldCount, const EntryHeader *headers, int count,
+                          LogIndexRecord *records) {
+    int next = 0;
+    DWORD day = 0;
+    for (int i = 0; i < count; i++) {
+        int match = -1;
+        for (int k = next; k < oldCount && k < next + LOGINDEX_REALIGN_WINDOW; k++) {
+            if (LOGINDEX_STAMP_MINUTES(old[k].stamp) == headers[i].minutes) {
+                match = k;
+                break;
+            }
+        }
+        if (match >= 0) {
+            day = LOGINDEX_STAMP_DAY(old[match].stamp);
+            next = match + 1;
+        } else if (!day && next < oldCount) {
+            day = LOGINDEX_STAMP_DAY(old[next].stamp);
+        }
+        if (day) records[i].stamp = day | (DWORD)headers[i].minutes;
+    }
+}
+
+// Replace the sidecar with records and reopen it for appending
+static BOOL WriteIndexFile(LogIndex *index) {
+    char tempPath[MAX_PATH + 4];
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", index->path);
+    HANDLE temp = CreateFile(tempPath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (temp == INVALID_HANDLE_VALUE) return FALSE;
+    
+    LogIndexHeader header = { LOGINDEX_MAGIC, LOGINDEX_VERSION, sizeof(LogIndexRecord), 0 };
+    BOOL ok = FileIO_WriteAll(temp, &header, sizeof(header)) &&
+              FileIO_WriteAll(temp, index->records, (DWORD)(index->count * sizeof(LogIndexRecord)));
+    CloseHandle(temp);
+    
+    if (index->file) CloseHandle(index->file);
+    index->file = NULL;
+    if (!ok || !MoveFileEx(tempPath, index->path, MOVEFILE_REPLACE_EXISTING)) {
+        DeleteFile(tempPath);
+        return FALSE;
+    }
+    
+    index->file = CreateFile(index->path, FILE_APPEND_DATA, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (index->file == INVALID_HANDLE_VALUE) index->file = NULL;
+    return index->file != NULL;
+}
+
+// Rescan the log into index->records, keeping the dates of what was loaded
+static BOOL ScanLog(LogIndex *index) {
+    HANDLE log = CreateFile(index->logPath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                            NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    LARGE_INTEGER size;
+    size.QuadPart = 0;
+    if (log != INVALID_HANDLE_VALUE && !GetFileSizeEx(log, &size)) size.QuadPart = 0;
+    
+    // No log yet is an empty index
+    HANDLE mapping = NULL;
+    const char *text = NULL;
+    if (size.QuadPart > 0) {
+        mapping = CreateFileMapping(log, NULL, PAGE_READONLY, 0, 0, NULL);
+        text = mapping ? (const char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+        if (!text) {
+            if (mapping) CloseHandle(mapping);
+            CloseHandle(log);
+            return FALSE;
+        }
+    }
+    
+    int count = 0;
+    EntryHeader *headers = text ? ScanEntries(text, size.QuadPart, &count) : NULL;
+    LogIndexRecord *records = count > 0 ? (LogIndexRecord *)malloc(count * sizeof(LogIndexRecord)) : NULL;
+    BOOL ok = !text || (headers && (count == 0 || records));
+    
+    if (ok && count > 0) {
+        for (int i = 0; i < count; i++) {
+            LONGLONG end = i + 1 < count ? headers[i + 1].offset : size.QuadPart;
+            records[i].offset = headers[i].offset;
+            records[i].length = (DWORD)min(end - headers[i].offset, (LONGLONG)MAXDWORD);
+        }
+        GuessStamps(log, headers, count, records);
+    
+        // What was recorded before is in stamp order; match it in file order
+        if (index->count > 0) qsort(index->records, index->count, sizeof(LogIndexRecord), CompareByOffset);
+        RealignStamps(index->records, index->count, headers, count, records);
+    }
+    
+    free(headers);
+    if (text) UnmapViewOfFile(text);
+    if (mapping) CloseHandle(mapping);
+    if (log != INVALID_HANDLE_VALUE) CloseHandle(log);
+    if (!ok) {
+        free(records);
+        if (index->count > 0) qsort(index->records, index->count, sizeof(LogIndexRecord), CompareByStamp);
+        return FALSE;
+    }
+    
+    free(index->records);
+    index->records = records;
+    index->count = count;
+    index->capacity = count;
+    if (count > 0) qsort(index->records, count, sizeof(LogIndexRecord), CompareByStamp);
+    UpdateOffsetOrder(index);
+    return TRUE;
+}
+
+BOOL LogIndex_Rebuild(LogIndex *index) {
+    if (!index) return FALSE;
+    return ScanLog(index) && WriteIndexFile(index);
+}
+
+// Read the sidecar into memory; FALSE if it is missing or unusable
+static BOOL LoadIndexFile(LogIndex *index) {
+    HANDLE file = CreateFile(index->path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                             NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return FALSE;
+    
+    LARGE_INTEGER size;
+    LogIndexHeader header;
+    DWORD got = 0;
+    BOOL ok = GetFileSizeEx(file, &size) && size.QuadPart >= (LONGLONG)sizeof(header) &&
+              size.QuadPart < 0x40000000 &&
+              ReadFile(file, &header, sizeof(header), &got, NULL) && got == sizeof(header) &&
+              header.magic == LOGINDEX_MAGIC && header.version == LOGINDEX_VERSION &&
+              header.recordSize == sizeof(LogIndexRecord);
+    
+    // A record torn by a crash mid-append is dropped
+    int count = ok ? (int)((size.QuadPart - sizeof(header)) / sizeof(LogIndexRecord)) : 0;
+    LogIndexRecord *records = NULL;
+    if (ok && count > 0) {
+        DWORD bytes = (DWORD)(count * sizeof(LogIndexRecord));
+        records = (LogIndexRecord *)malloc(bytes);
+        ok = records && ReadFile(file, records, bytes, &got, NULL) && got == bytes;
+    }
+    CloseHandle(file);
+    if (!ok) {
+        free(records);
+        return FALSE;
+    }
+    
+    index->records = records;
+    index->count = count;
+    index->capacity = count;
+    if (count > 0) qsort(index->records, count, sizeof(LogIndexRecord), CompareByStamp);
+    UpdateOffsetOrder(index);
+    return TRUE;
+}
+
+// The index still describes the log if its last entry ends where the log
+// does and starts with an entry header
+static BOOL MatchesLog(const LogIndex *index) {
+    HANDLE log = CreateFile(index->logPath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                            NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (log == INVALID_HANDLE_VALUE) return index->count == 0;
+    
+    const LogIndexRecord *last = NULL;
+    for (int i = 0; i < index->count; i++) {
+        if (!last || index->records[i].offset > last->offset) last = &index->records[i];
+    }
+    
+    LARGE_INTEGER size;
+    BOOL ok = GetFileSizeEx(log, &size);
+    if (ok && !last) {
+        ok = size.QuadPart == 0;
+    } else if (ok) {
+        char head[8];
+        DWORD got = 0;
+        LARGE_INTEGER pos;
+        pos.QuadPart = last->offset;
+        int minutes;
+        ok = last->offset + last->length == size.QuadPart &&
+             SetFilePointerEx(log, pos, NULL, FILE_BEGIN) &&
+             ReadFile(log, head, sizeof(head), &got, NULL) && ParseEntryTime(head, head + got, &minutes) &&
+             minutes == LOGINDEX_STAMP_MINUTES(last->stamp);
+    }
+    CloseHandle(log);
+    return ok;
+}
+
+BOOL LogIndex_Open(LogIndex *index, const char *logPath) {
+    if (!index || !logPath) return FALSE;
+    memset(index, 0, sizeof(LogIndex));
+    snprintf(index->logPath, sizeof(index->logPath), "%s", logPath);
+    LogIndex_PathFor(logPath, index->path, sizeof(index->path));
+    
+    if (LoadIndexFile(index) && MatchesLog(index)) {
+        index->file = CreateFile(index->path, FILE_APPEND_DATA, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                                 OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (index->file != INVALID_HANDLE_VALUE) return TRUE;
+        index->file = NULL;
+    }
+    
+    // Whatever was loaded still lends its dates to the rebuilt index
+    if (!LogIndex_Rebuild(index)) {
+        LogIndex_Close(index);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+BOOL LogIndex_Load(LogIndex *index, const char *logPath) {
+    if (!index || !logPath) return FALSE;
+    memset(index, 0, sizeof(LogIndex));
+    snprintf(index->logPath, sizeof(index->logPath), "%s", logPath);
+    LogIndex_PathFor(logPath, index->path, sizeof(index->path));
+    
+    if (LoadIndexFile(index) && MatchesLog(index)) return TRUE;
+    if (!ScanLog(index)) {
+        LogIndex_Close(index);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+void LogIndex_Close(LogIndex *index) {
+    if (!index) return;
+    if (index->file) CloseHandle(index->file);
+    free(index->records);
+    memset(index, 0, sizeof(LogIndex));
+}
+
+BOOL LogIndex_Append(LogIndex *index, DWORD stamp, LONGLONG offset, DWORD length) {
+    if (!index || !index->file) return FALSE;
+    
+    if (index->count >= index->capacity) {
+        int newCapacity = index->capacity > 0 ? index->capacity * 2 : 256;
+        LogIndexRecord *grown = (LogIndexRecord *)realloc(index->records, newCapacity * sizeof(LogIndexRecord));
+        if (!grown) return FALSE;
+        index->records = grown;
+        index->capacity = newCapacity;
+    }
+    
+    LogIndexRecord record = { offset, length, stamp };
+    
+    // Entries normally arrive in order; a clock set back lands earlier
+    int pos = index->count;
+    while (pos > 0 && CompareByStamp(&index->records[pos - 1], &record) > 0) pos--;
+    memmove(&index->records[pos + 1], &index->records[pos], (index->count - pos) * sizeof(LogIndexRecord));
+    index->records[pos] = record;
+    index->count++;
+    
+    if (index->offsetOrdered) {
+        index->offsetOrdered = (pos == 0 || index->records[pos - 1].offset < offset) &&
+                               (pos == index->count - 1 || index->records[pos + 1].offset > offset);
+    }
+    return FileIO_WriteAll(index->file, &record, sizeof(record));
+}
+
+int LogIndex_LowerBound(const LogIndex *index, DWORD stamp) {
+    if (!index) return 0;
+    int lo = 0, hi = index->count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (index->records[mid].stamp < stamp) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+int LogIndex_FindRange(const LogIndex *index, DWORD from, DWORD to, int *first) {
+    int start = LogIndex_LowerBound(index, from);
+    int end = LogIndex_LowerBound(index, to);
+    if (first) *first = start;
+    return end > start ? end - start : 0;
+}
+
+int LogIndex_FindOffset(const LogIndex *index, LONGLONG offset) {
+    if (!index) return -1;
+    
+    // The entry whose bytes reach past offset, nearest the start of the log
+    if (index->offsetOrdered) {
+        int lo = 0, hi = index->count;
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            if (index->records[mid].offset + index->records[mid].length <= offset) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo < index->count ? lo : -1;
+    }
+    
+    int best = -1;
+    for (int i = 0; i < index->count; i++) {
+        const LogIndexRecord *r = &index->records[i];
+        if (r->offset + r->length > offset && (best < 0 || r->offset < index->records[best].offset)) best = i;
+    }
+    return best;
+}
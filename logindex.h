@@ -0,0 +1,84 @@
+#ifndef LOGINDEX_H
+#define LOGINDEX_H
+
+#include <windows.h>
+
+// Sidecar index for a log (WorkLog.txt -> WorkLog.idx). The log itself only
+// carries "[h:mmam]" times, so the date each entry was written is recorded
+// here. Layout, all little-endian:
+//
+//   LogIndexHeader
+//   LogIndexRecord records[]   one per entry, appended as entries are added
+//
+// Exports are byte-for-byte copies of the log, so an export's copy of the
+// index (WorkLog_YYYY-MM-DD.idx) describes it as well.
+#define LOGINDEX_MAGIC   0x58444957u  // "WIDX"
+#define LOGINDEX_VERSION 1
+
+// Sortable date and time of an entry: year, month, day and minute of day
+// packed from the high bits down
+#define LOGINDEX_STAMP(year, month, day, minutes) \
+    (((DWORD)(year) << 20) | ((DWORD)(month) << 16) | ((DWORD)(day) << 11) | (DWORD)(minutes))
+#define LOGINDEX_STAMP_YEAR(stamp) ((int)((stamp) >> 20))
+#define LOGINDEX_STAMP_MONTH(stamp) ((int)((stamp) >> 16) & 0xF)
+#define LOGINDEX_STAMP_DATE(stamp) ((int)((stamp) >> 11) & 0x1F)
+#define LOGINDEX_STAMP_MINUTES(stamp) ((int)(stamp) & 0x7FF)
+#define LOGINDEX_STAMP_DAY(stamp) ((stamp) & ~0x7FFu)       // Midnight of the stamp's day
+#define LOGINDEX_STAMP_NEXT_DAY(stamp) (LOGINDEX_STAMP_DAY(stamp) + 0x800u)  // Sorts after the whole day
+
+typedef struct {
+    DWORD magic;
+    DWORD version;
+    DWORD recordSize;
+    DWORD reserved;
+} LogIndexHeader;
+
+typedef struct {
+    LONGLONG offset;     // Start of the entry's "[h:mmam]" line
+    DWORD length;        // Bytes up to the next entry
+    DWORD stamp;         // LOGINDEX_STAMP
+} LogIndexRecord;
+
+// Records in memory, kept sorted by stamp then offset. Not thread-safe; the
+// UI thread owns it.
+typedef struct {
+    HANDLE file;             // Sidecar, open for appending
+    char path[MAX_PATH];
+    char logPath[MAX_PATH];
+    LogIndexRecord *records;
+    int count;
+    int capacity;
+    BOOL offsetOrdered;      // Offsets rise with stamps, so offset lookups can bisect
+} LogIndex;
+
+// Load the sidecar for logPath. A missing, corrupt or stale index (its last
+// entry no longer matches the log) is rebuilt from the log first.
+BOOL LogIndex_Open(LogIndex *index, const char *logPath);
+void LogIndex_Close(LogIndex *index);
+
+// The records LogIndex_Open would give, without writing anything: the
+// sidecar if it matches the log, else a scan of the log kept in memory.
+// For reading another process's or an export's log; Append fails on it.
+BOOL LogIndex_Load(LogIndex *index, const char *logPath);
+
+// Record an entry just appended to the log
+BOOL LogIndex_Append(LogIndex *index, DWORD stamp, LONGLONG offset, DWORD length);
+
+// Rescan the log after it was rewritten (View mode save). Entries keep the
+// dates recorded for them; entries typed while viewing take the date of the
+// entry before them.
+BOOL LogIndex_Rebuild(LogIndex *index);
+
+// First record with stamp >= stamp, or count if there is none
+int LogIndex_LowerBound(const LogIndex *index, DWORD stamp);
+
+// Records with from <= stamp < to; sets *first and returns how many
+int LogIndex_FindRange(const LogIndex *index, DWORD from, DWORD to, int *first);
+
+// Record of the entry at or after offset, or -1
+int LogIndex_FindOffset(const LogIndex *index, LONGLONG offset);
+
+// Sidecar path for a log: its extension replaced with .idx
+void LogIndex_PathFor(const char *logPath, char *indexPath, size_t size);
+
+#endif // LOGINDEX_H
@@ -0,0 +1,517 @@
+#include "logpager.h"
+#include "fileio.h"
+#include "perfstats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LOGPAGER_COPY_CHUNK (64 * 1024)
+
+// One changed run of the log: removed bytes at offset give way to text
+typedef struct {
+    LONGLONG offset;
+    DWORD removed;
+    const char *text;
+    DWORD len;
+} PatchSpan;
+
+// End of the page starting at start: LOGPAGER_PAGE_SIZE bytes extended to the
+// next line break, capped at twice the page size for pathological lines
+static LONGLONG FindPageEnd(LogPager *pager, LONGLONG start) {
+    LONGLONG end = start + LOGPAGER_PAGE_SIZE;
+    if (end >= pager->fileSize) return pager->fileSize;
+    
+    char chunk[4096];
+    LONGLONG limit = start + 2 * LOGPAGER_PAGE_SIZE;
+    while (end < pager->fileSize && end < limit) {
+        DWORD got;
+        if (!FileIO_ReadAt(pager->file, end, chunk, sizeof(chunk), &got) || got == 0) break;
+        char *nl = (char *)memchr(chunk, '\n', got);
+        if (nl) return end + (nl - chunk) + 1;
+        end += got;
+    }
+    return end < pager->fileSize ? min(end, limit) : pager->fileSize;
+}
+
+BOOL LogPager_Open(LogPager *pager, const char *path) {
+    if (!pager || !path) return FALSE;
+    memset(pager, 0, sizeof(LogPager));
+    if (!LogPager_Recover(path, NULL)) return FALSE;
+    
+    pager->file = CreateFile(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                             NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (pager->file == INVALID_HANDLE_VALUE) {
+        pager->file = NULL;
+        return FALSE;
+    }
+    
+    LARGE_INTEGER size;
+    pager->pageCapacity = 16;
+    pager->pageStarts = (LONGLONG *)malloc(pager->pageCapacity * sizeof(LONGLONG));
+    if (!pager->pageStarts || !GetFileSizeEx(pager->file, &size)) {
+        LogPager_Close(pager);
+        return FALSE;
+    }
+    
+    snprintf(pager->path, sizeof(pager->path), "%s", path);
+    pager->fileSize = size.QuadPart;
+    pager->pageStarts[0] = 0;
+    return TRUE;
+}
+
+void LogPager_Close(LogPager *pager) {
+    if (!pager) return;
+    if (pager->file) CloseHandle(pager->file);
+    for (int i = 0; i < pager->editCount; i++) {
+        free(pager->edits[i].text);
+    }
+    free(pager->edits);
+    free(pager->pageStarts);
+    memset(pager, 0, sizeof(LogPager));
+}
+
+BOOL LogPager_HasPage(const LogPager *pager, int index) {
+    if (!pager || !pager->file || index < 0 || index > pager->knownPages) return FALSE;
+    return index < pager->knownPages || pager->pageStarts[index] < pager->fileSize;
+}
+
+int LogPager_PercentThrough(const LogPager *pager, int index) {
+    if (!LogPager_HasPage(pager, index) || index >= pager->knownPages || pager->fileSize == 0) return 0;
+    return (int)(pager->pageStarts[index + 1] * 100 / pager->fileSize);
+}
+
+// Learn where page index ends (index may be at most knownPages)
+static BOOL EnsurePageBounds(LogPager *pager, int index) {
+    if (index < pager->knownPages) return TRUE;
+    
+    if (pager->knownPages + 2 > pager->pageCapacity) {
+        int newCapacity = pager->pageCapacity * 2;
+        LONGLONG *newStarts = (LONGLONG *)realloc(pager->pageStarts, newCapacity * sizeof(LONGLONG));
+        if (!newStarts) return FALSE;
+        pager->pageStarts = newStarts;
+        pager->pageCapacity = newCapacity;
+    }
+    pager->pageStarts[index + 1] = FindPageEnd(pager, pager->pageStarts[index]);
+    pager->knownPages = index + 1;
+    return TRUE;
+}
+
+int LogPager_FindPage(LogPager *pager, LONGLONG offset) {
+    if (!pager || !pager->file || offset < 0 || offset >= pager->fileSize) return -1;
+    
+    // Bisect the pages already known, otherwise walk forward; each new
+    // boundary costs one small read near the end of its page
+    if (pager->knownPages > 0 && offset < pager->pageStarts[pager->knownPages]) {
+        int lo = 0, hi = pager->knownPages - 1;
+        while (lo < hi) {
+            int mid = lo + (hi - lo + 1) / 2;
+            if (pager->pageStarts[mid] <= offset) lo = mid;
+            else hi = mid - 1;
+        }
+        return lo;
+    }
+    int index = pager->knownPages;
+    while (EnsurePageBounds(pager, index)) {
+        if (offset < pager->pageStarts[index + 1]) return index;
+        index++;
+    }
+    return -1;
+}
+
+LONGLONG LogPager_PageStart(const LogPager *pager, int index) {
+    if (!pager || !pager->pageStarts || index < 0 || index > pager->knownPages) return 0;
+    return pager->pageStarts[index];
+}
+
+static LogPagerEdit *FindEdit(LogPager *pager, LONGLONG start) {
+    for (int i = 0; i < pager->editCount; i++) {
+        if (pager->edits[i].start == start) return &pager->edits[i];
+    }
+    return NULL;
+}
+
+char *LogPager_LoadPage(LogPager *pager, int index, DWORD *len) {
+    if (!LogPager_HasPage(pager, index) || !EnsurePageBounds(pager, index)) return NULL;
+    
+    LONGLONG start = pager->pageStarts[index];
+    LONGLONG end = pager->pageStarts[index + 1];
+    
+    // A changed page is shown as the user left it
+    LogPagerEdit *edit = FindEdit(pager, start);
+    if (edit) {
+        char *copy = (char *)malloc(edit->len + 1);
+        if (!copy) return NULL;
+        memcpy(copy, edit->text, edit->len);
+        copy[edit->len] = '\0';
+        if (len) *len = edit->len;
+        return copy;
+    }
+    
+    DWORD rawLen = (DWORD)(end - start);
+    char *raw = (char *)malloc(rawLen + 1);
+    char *converted = (char *)malloc(2 * (size_t)rawLen + 1);
+    DWORD bytesRead = 0, prevRead = 0;
+    char prev = 0;  // Byte before the page, for CRLF pairs split across pages
+    if (!raw || !converted ||
+        !FileIO_ReadAt(pager->file, start, raw, rawLen, &bytesRead) ||
+        (start > 0 && !FileIO_ReadAt(pager->file, start - 1, &prev, 1, &prevRead))) {
+        free(raw);
+        free(converted);
+        return NULL;
+    }
+    
+    // Convert lone LF to CRLF so the Windows edit control shows new lines correctly
+    DWORD wi = 0;
+    for (DWORD ri = 0; ri < bytesRead; ri++) {
+        char c = raw[ri];
+        if (c == '\n' && (ri > 0 ? raw[ri - 1] : prev) != '\r') {
+            converted[wi++] = '\r';
+        }
+        converted[wi++] = c;
+    }
+    converted[wi] = '\0';
+    free(raw);
+    
+    if (len) *len = wi;
+    return converted;
+}
+
+BOOL LogPager_SetPageText(LogPager *pager, int index, char *text, DWORD len) {
+    if (!pager || !text || index < 0 || index >= pager->knownPages) {
+        free(text);
+        return FALSE;
+    }
+    
+    LONGLONG start = pager->pageStarts[index];
+    LogPagerEdit *edit = FindEdit(pager, start);
+    if (edit) {
+        free(edit->text);
+        edit->text = text;
+        edit->len = len;
+        return TRUE;
+    }
+    
+    if (pager->editCount >= pager->editCapacity) {
+        int newCapacity = pager->editCapacity > 0 ? pager->editCapacity * 2 : 4;
+        LogPagerEdit *newEdits = (LogPagerEdit *)realloc(pager->edits, newCapacity * sizeof(LogPagerEdit));
+        if (!newEdits) {
+            free(text);
+            return FALSE;
+        }
+        pager->edits = newEdits;
+        pager->editCapacity = newCapacity;
+    }
+    
+    // Keep edits in file order for the single pass in Save
+    int pos = pager->editCount;
+    while (pos > 0 && pager->edits[pos - 1].start > start) pos--;
+    memmove(&pager->edits[pos + 1], &pager->edits[pos], (pager->editCount - pos) * sizeof(LogPagerEdit));
+    pager->edits[pos].start = start;
+    pager->edits[pos].end = pager->pageStarts[index + 1];
+    pager->edits[pos].text = text;
+    pager->edits[pos].len = len;
+    pager->editCount++;
+    return TRUE;
+}
+
+// Stream [from, to) of the source into dest, adding it to *hash if given
+static BOOL CopyRange(HANDLE source, HANDLE dest, LONGLONG from, LONGLONG to, char *chunk, DWORD *hash) {
+    while (from < to) {
+        DWORD want = (DWORD)min(to - from, (LONGLONG)LOGPAGER_COPY_CHUNK);
+        DWORD got;
+        if (!FileIO_ReadAt(source, from, chunk, want, &got) || got == 0) return FALSE;
+        if (!FileIO_WriteAll(dest, chunk, got)) return FALSE;
+        if (hash) *hash = FileIO_Checksum(*hash, chunk, got);
+        from += got;
+    }
+    return TRUE;
+}
+
+static BOOL WriteHashed(HANDLE file, const void *data, DWORD len, DWORD *hash) {
+    *hash = FileIO_Checksum(*hash, data, len);
+    return FileIO_WriteAll(file, data, len);
+}
+
+// Shrink an edited page to the run that actually changed. The page was
+// shown with lone LFs widened to CRLF, so the edit text is compared against
+// the file through that conversion and the unchanged ends stay byte for
+// byte as they are on disk. An empty span means the page is unchanged.
+static BOOL NarrowEdit(const LogPager *pager, const LogPagerEdit *edit, char *raw, PatchSpan *span) {
+    DWORD rawLen = (DWORD)(edit->end - edit->start);
+    DWORD got = 0, prevRead = 0;
+    char prev = 0;
+    if (!FileIO_ReadAt(pager->file, edit->start, raw, rawLen, &got) || got != rawLen ||
+        (edit->start > 0 && !FileIO_ReadAt(pager->file, edit->start - 1, &prev, 1, &prevRead))) {
+        return FALSE;
+    }
+    
+    const char *text = edit->text;
+    DWORD ri = 0, ti = 0;
+    while (ri < rawLen) {
+        char c = raw[ri];
+        BOOL widened = c == '\n' && (ri > 0 ? raw[ri - 1] : prev) != '\r';
+        if (widened) {
+            if (ti + 1 >= edit->len || text[ti] != '\r' || text[ti + 1] != '\n') break;
+            ti += 2;
+        } else {
+            if (ti >= edit->len || text[ti] != c) break;
+            ti++;
+        }
+        ri++;
+    }
+    
+    DWORD re = rawLen, te = edit->len;
+    while (re > ri && te > ti) {
+        char c = raw[re - 1];
+        BOOL widened = c == '\n' && (re > 1 ? raw[re - 2] : prev) != '\r';
+        if (widened) {
+            if (te < ti + 2 || text[te - 2] != '\r' || text[te - 1] != '\n') break;
+            te -= 2;
+        } else {
+            if (text[te - 1] != c) break;
+            te--;
+        }
+        re--;
+    }
+    
+    span->offset = edit->start + ri;
+    span->removed = re - ri;
+    span->text = text + ti;
+    span->len = te - ti;
+    return TRUE;
+}
+
+static void JournalPathFor(const char *path, char *journalPath, size_t size) {
+    snprintf(journalPath, size, "%s.patch", path);
+}
+
+// Copy each journal record into the log, set its final size and flush.
+// The journal was verified by the caller.
+static BOOL ApplyJournal(HANDLE journal, const char *path, const LogPagerJournalHeader *header, char *chunk) {
+    HANDLE log = CreateFile(path, GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, NULL);
+    if (log == INVALID_HANDLE_VALUE) return FALSE;
+    
+    BOOL ok = TRUE;
+    LONGLONG pos = sizeof(LogPagerJournalHeader);
+    for (DWORD r = 0; ok && r < header->recordCount; r++) {
+        LogPagerJournalRecord record;
+        DWORD got = 0;
+        ok = FileIO_ReadAt(journal, pos, &record, sizeof(record), &got) && got == sizeof(record);
+        pos += sizeof(record);
+        
+        LARGE_INTEGER at;
+        at.QuadPart = record.offset;
+        ok = ok && SetFilePointerEx(log, at, NULL, FILE_BEGIN) && CopyRange(journal, log, pos, pos + record.length, chunk, NULL);
+        pos += record.length;
+    }
+    
+    LARGE_INTEGER end;
+    end.QuadPart = header->newSize;
+    ok = ok && SetFilePointerEx(log, end, NULL, FILE_BEGIN) && SetEndOfFile(log) && FlushFileBuffers(log);
+    CloseHandle(log);
+    return ok;
+}
+
+// Read the journal through, checking the records fit and the checksum holds
+static BOOL VerifyJournal(HANDLE journal, LogPagerJournalHeader *header, char *chunk) {
+    LARGE_INTEGER size;
+    DWORD got = 0;
+    if (!GetFileSizeEx(journal, &size) ||
+        !FileIO_ReadAt(journal, 0, header, sizeof(LogPagerJournalHeader), &got) || got != sizeof(LogPagerJournalHeader) ||
+        header->magic != LOGPAGER_JOURNAL_MAGIC || header->version != LOGPAGER_JOURNAL_VERSION) {
+        return FALSE;
+    }
+    
+    DWORD hash = FILEIO_CHECKSUM_SEED;
+    LONGLONG pos = sizeof(LogPagerJournalHeader);
+    for (DWORD r = 0; r < header->recordCount; r++) {
+        LogPagerJournalRecord record;
+        if (!FileIO_ReadAt(journal, pos, &record, sizeof(record), &got) || got != sizeof(record) ||
+            record.offset < 0 || record.length < 0 || pos + (LONGLONG)sizeof(record) + record.length > size.QuadPart) {
+            return FALSE;
+        }
+        hash = FileIO_Checksum(hash, &record, sizeof(record));
+        pos += sizeof(record);
+        for (LONGLONG left = record.length; left > 0; ) {
+            DWORD want = (DWORD)min(left, (LONGLONG)LOGPAGER_COPY_CHUNK);
+            if (!FileIO_ReadAt(journal, pos, chunk, want, &got) || got != want) return FALSE;
+            hash = FileIO_Checksum(hash, chunk, got);
+            pos += got;
+            left -= got;
+        }
+    }
+    return pos == size.QuadPart && hash == header->checksum;
+}
+
+BOOL LogPager_Recover(const char *path, BOOL *replayed) {
+    if (replayed) *replayed = FALSE;
+    if (!path) return FALSE;
+    
+    char journalPath[MAX_PATH + 8];
+    JournalPathFor(path, journalPath, sizeof(journalPath));
+    HANDLE journal = CreateFile(journalPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, NULL);
+    if (journal == INVALID_HANDLE_VALUE) return TRUE;  // Nothing was interrupted
+    
+    char *chunk = (char *)malloc(LOGPAGER_COPY_CHUNK);
+    if (!chunk) {
+        CloseHandle(journal);
+        return FALSE;
+    }
+    
+    // A journal that doesn't verify was cut short before the log was
+    // touched; one that does is applied again, which is harmless if it
+    // already was
+    LogPagerJournalHeader header;
+    BOOL ok = TRUE;
+    if (VerifyJournal(journal, &header, chunk)) {
+        ok = ApplyJournal(journal, path, &header, chunk);
+        if (ok && replayed) *replayed = TRUE;
+    }
+    free(chunk);
+    CloseHandle(journal);
+    if (ok) DeleteFile(journalPath);
+    return ok;
+}
+
+// Write the spans into the log where it lies: the new bytes go to a journal
+// first, flushed before the log is touched, so a crash part way through is
+// finished by LogPager_Recover. Equal-length spans are written as they
+// are; otherwise everything from the first span on is rewritten.
+static BOOL PatchInPlace(LogPager *pager, const PatchSpan *spans, int spanCount, LONGLONG fileSize, BOOL sameLength,
+                         char *chunk) {
+    char journalPath[MAX_PATH + 8];
+    JournalPathFor(pager->path, journalPath, sizeof(journalPath));
+    HANDLE journal = CreateFile(journalPath, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                                FILE_ATTRIBUTE_NORMAL, NULL);
+    if (journal == INVALID_HANDLE_VALUE) return FALSE;
+    
+    LogPagerJournalHeader header = {0};
+    header.version = LOGPAGER_JOURNAL_VERSION;
+    header.newSize = fileSize;
+    DWORD hash = FILEIO_CHECKSUM_SEED;
+    BOOL ok = FileIO_WriteAll(journal, &header, sizeof(header));
+    if (sameLength) {
+        for (int i = 0; ok && i < spanCount; i++) {
+            LogPagerJournalRecord record = { spans[i].offset, spans[i].len };
+            ok = WriteHashed(journal, &record, sizeof(record), &hash) && WriteHashed(journal, spans[i].text, spans[i].len, &hash);
+            header.recordCount++;
+        }
+    } else {
+        LogPagerJournalRecord record = { spans[0].offset, fileSize - spans[0].offset };
+        for (int i = 0; i < spanCount; i++) {
+            record.length += (LONGLONG)spans[i].len - spans[i].removed;
+            header.newSize += (LONGLONG)spans[i].len - spans[i].removed;
+        }
+        ok = ok && WriteHashed(journal, &record, sizeof(record), &hash);
+        LONGLONG pos = spans[0].offset;
+        for (int i = 0; ok && i < spanCount; i++) {
+            ok = CopyRange(pager->file, journal, pos, spans[i].offset, chunk, &hash) &&
+                 WriteHashed(journal, spans[i].text, spans[i].len, &hash);
+            pos = spans[i].offset + spans[i].removed;
+        }
+        ok = ok && CopyRange(pager->file, journal, pos, fileSize, chunk, &hash);
+        header.recordCount = 1;
+    }
+    
+    // The header goes in last, after the records are on disk, so a journal
+    // is only ever whole or rejected
+    header.magic = LOGPAGER_JOURNAL_MAGIC;
+    header.checksum = hash;
+    LARGE_INTEGER start = {0};
+    ok = ok && FlushFileBuffers(journal) && SetFilePointerEx(journal, start, NULL, FILE_BEGIN) &&
+         FileIO_WriteAll(journal, &header, sizeof(header)) && FlushFileBuffers(journal);
+    CloseHandle(pager->file);
+    pager->file = NULL;
+    if (!ok) {
+        CloseHandle(journal);
+        DeleteFile(journalPath);
+        return FALSE;
+    }
+    
+    ok = ApplyJournal(journal, pager->path, &header, chunk);
+    CloseHandle(journal);
+    // A failed apply leaves the journal for the next LogPager_Recover
+    if (ok) DeleteFile(journalPath);
+    return ok;
+}
+
+// Write the whole log to a temporary file with the spans spliced in, then
+// swap it in
+static BOOL RewriteFile(LogPager *pager, const PatchSpan *spans, int spanCount, LONGLONG fileSize, char *chunk) {
+    char tempPath[MAX_PATH + 4];
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", pager->path);
+    HANDLE temp = CreateFile(tempPath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (temp == INVALID_HANDLE_VALUE) return FALSE;
+    
+    BOOL ok = TRUE;
+    LONGLONG pos = 0;
+    for (int i = 0; i < spanCount && ok; i++) {
+        ok = CopyRange(pager->file, temp, pos, spans[i].offset, chunk, NULL) && FileIO_WriteAll(temp, spans[i].text, spans[i].len);
+        pos = spans[i].offset + spans[i].removed;
+    }
+    ok = ok && CopyRange(pager->file, temp, pos, fileSize, chunk, NULL);
+    
+    // On disk before the rename, or a crash could swap in an empty file
+    ok = ok && FlushFileBuffers(temp);
+    CloseHandle(temp);
+    CloseHandle(pager->file);
+    pager->file = NULL;
+    
+    if (!ok || !MoveFileEx(tempPath, pager->path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        DeleteFile(tempPath);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+BOOL LogPager_Save(LogPager *pager, BOOL inPlace) {
+    if (!pager || !pager->file) return FALSE;
+    
+    LONGLONG start = PerfStats_Start();
+    PatchSpan *spans = pager->editCount > 0 ? (PatchSpan *)malloc(pager->editCount * sizeof(PatchSpan)) : NULL;
+    char *raw = (char *)malloc(2 * LOGPAGER_PAGE_SIZE);
+    char *chunk = (char *)malloc(LOGPAGER_COPY_CHUNK);
+    BOOL ok = (spans || pager->editCount == 0) && raw && chunk;
+    
+    // Edits are in file order and don't overlap, so neither do the spans
+    int spanCount = 0;
+    BOOL sameLength = TRUE;
+    LONGLONG patchBytes = 0;
+    for (int i = 0; ok && i < pager->editCount; i++) {
+        PatchSpan *span = &spans[spanCount];
+        ok = NarrowEdit(pager, &pager->edits[i], raw, span);
+        if (!ok || (span->removed == 0 && span->len == 0)) continue;
+        if (span->len != span->removed) sameLength = FALSE;
+        patchBytes += span->len;
+        spanCount++;
+    }
+    free(raw);
+    
+    // Anything appended since the pager opened is carried over too
+    LARGE_INTEGER size;
+    LONGLONG fileSize = GetFileSizeEx(pager->file, &size) ? size.QuadPart : pager->fileSize;
+    
+    if (ok && spanCount > 0) {
+        // Patching in place writes its bytes twice (journal, then log);
+        // past half the file a fresh copy is cheaper
+        if (!sameLength) {
+            patchBytes = fileSize - spans[0].offset;
+            for (int i = 0; i < spanCount; i++) {
+                patchBytes += (LONGLONG)spans[i].len - spans[i].removed;
+            }
+        }
+        BOOL patch = inPlace && patchBytes * 2 <= fileSize;
+        ok = patch ? PatchInPlace(pager, spans, spanCount, fileSize, sameLength, chunk)
+                   : RewriteFile(pager, spans, spanCount, fileSize, chunk);
+    }
+    if (pager->file) {
+        CloseHandle(pager->file);
+        pager->file = NULL;
+    }
+    free(spans);
+    free(chunk);
+    PerfStats_Stop(PERF_LOG_SAVE, start);
+    return ok;
+}
@@ -0,0 +1,98 @@
+#ifndef LOGPAGER_H
+#define LOGPAGER_H
+
+#include <windows.h>
+
+#define LOGPAGER_PAGE_SIZE (32 * 1024)   // Target bytes per page; pages end on a line break
+
+// Redo journal for saves patched into the log in place (WorkLog.txt.patch).
+// Layout, all little-endian:
+//
+//   LogPagerJournalHeader
+//   per record: LogPagerJournalRecord, BYTE data[length]
+//
+// The header is written last, once the records are flushed; replaying the
+// records and cutting the log to newSize finishes the save.
+#define LOGPAGER_JOURNAL_MAGIC   0x4A504C57u  // "WLPJ"
+#define LOGPAGER_JOURNAL_VERSION 1
+
+typedef struct {
+    DWORD magic;
+    DWORD version;
+    DWORD recordCount;
+    DWORD checksum;          // FNV-1a of everything after the header
+    LONGLONG newSize;        // Log size once the records are written
+} LogPagerJournalHeader;
+
+typedef struct {
+    LONGLONG offset;         // Where data goes in the log
+    LONGLONG length;
+} LogPagerJournalRecord;
+
+// Replacement text for one page, kept until Save
+typedef struct {
+    LONGLONG start;      // Original file range the page covered
+    LONGLONG end;
+    char *text;          // Edited page as shown (CRLF line endings)
+    DWORD len;
+} LogPagerEdit;
+
+// Windowed access to the log for View mode. Only the page on screen and the
+// pages the user actually changed are held in memory; page boundaries are
+// discovered as the user moves forward and refer to the file as opened.
+typedef struct {
+    HANDLE file;
+    char path[MAX_PATH];
+    LONGLONG fileSize;
+    LONGLONG *pageStarts;    // pageStarts[i] = offset of page i; one extra entry closes the last known page
+    int knownPages;          // Pages whose end offset is known
+    int pageCapacity;
+    LogPagerEdit *edits;     // Sorted by start, non-overlapping
+    int editCount;
+    int editCapacity;
+} LogPager;
+
+// Open path for viewing, finishing an interrupted save first
+BOOL LogPager_Open(LogPager *pager, const char *path);
+
+// Release the pager, discarding unsaved edits
+void LogPager_Close(LogPager *pager);
+
+// Text for page index with LF converted to CRLF for the edit control, or the
+// pending edit if the page was changed. Caller frees. Pages can be visited
+// in any order up to one past the furthest page already loaded.
+char *LogPager_LoadPage(LogPager *pager, int index, DWORD *len);
+
+BOOL LogPager_HasPage(const LogPager *pager, int index);
+
+// Fraction of the file covered through the end of page index, in percent
+int LogPager_PercentThrough(const LogPager *pager, int index);
+
+// Page holding offset, learning page bounds up to it as needed; -1 if the
+// offset is past the end of the file as opened
+int LogPager_FindPage(LogPager *pager, LONGLONG offset);
+
+// File offset where page index starts (index must be loaded or next)
+LONGLONG LogPager_PageStart(const LogPager *pager, int index);
+
+// Record new contents for a loaded page; takes ownership of text (malloc'd)
+BOOL LogPager_SetPageText(LogPager *pager, int index, char *text, DWORD len);
+
+// Write the log back with the edits in. Each edited page is diffed against
+// the file and only the run that changed is written, so the cost follows
+// the edit: same-length changes, or changes near the end of the log, are
+// patched in place through the journal; anything else is written to a
+// temporary file that replaces the log. Either way a crash leaves the old
+// log or the new one. Pass inPlace FALSE while something else is reading
+// the log (an export copying it, a summary mapping it) to always rewrite.
+// Closes the pager's handle.
+BOOL LogPager_Save(LogPager *pager, BOOL inPlace);
+
+// Finish a save that was patching path in place when it was cut short, or
+// drop its journal if the log was not touched yet. Run before anything else
+// opens the log; FALSE if the journal could not be applied (it is kept).
+// *replayed, if given, is set when the journal was applied, so the log
+// changed and anything indexing it is stale.
+BOOL LogPager_Recover(const char *path, BOOL *replayed);
+
+#endif // LOGPAGER_H
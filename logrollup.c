@@ -0,0 +1,867 @@
+#include "logrollup.h"
+#include "logindex.h"
+#include "fileio.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ROLLUP_MAX_SECTIONS   16        // Category headings taken per entry
+#define ROLLUP_MAX_FILES      100000    // Sanity limits for reading the cache
+#define ROLLUP_MAX_DAYS       100000
+#define ROLLUP_MAX_CATEGORIES 4096
+
+// Words of three letters or more that say nothing about the work; sorted
+// for bsearch
+static const char *g_stopWords[] = {
+    "about", "after", "all", "also", "and", "any", "are", "been", "before", "but", "can", "could",
+    "did", "does", "for", "from", "get", "got", "had", "has", "have", "her", "his", "how", "into",
+    "its", "just", "more", "not", "now", "off", "one", "our", "out", "over", "should", "some",
+    "than", "that", "the", "their", "them", "then", "there", "these", "they", "this", "those",
+    "through", "was", "were", "what", "when", "which", "while", "who", "will", "with", "would", "you"
+};
+
+static const char *g_dayNames[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+static const char *g_monthNames[] = {
+    "January", "February", "March", "April", "May", "June",
+    "July", "August", "September", "October", "November", "December"
+};
+
+typedef struct {
+    LogRollupCategory *items;
+    DWORD count;
+    DWORD capacity;
+} CategoryList;
+
+// Terms in insertion order with an open-addressed hash over them
+typedef struct {
+    LogRollupTerm *items;
+    DWORD count;
+    DWORD capacity;
+    DWORD *slots;            // Item index + 1, 0 for empty
+    DWORD slotCount;         // Power of two, kept at least twice count
+} TermTable;
+
+typedef struct {
+    LogRollupFile **files;
+    LONG count;
+    volatile LONG next;
+    volatile LONG failed;
+} ParseJob;
+
+static DWORD HashTerm(const char *word) {
+    DWORD hash = 2166136261u;
+    for (; *word; word++) {
+        hash = (hash ^ (BYTE)*word) * 16777619u;
+    }
+    return hash;
+}
+
+static BOOL GrowTermSlots(TermTable *table) {
+    DWORD slotCount = table->slotCount > 0 ? table->slotCount * 2 : 64;
+    DWORD *slots = (DWORD *)calloc(slotCount, sizeof(DWORD));
+    if (!slots) return FALSE;
+    for (DWORD i = 0; i < table->count; i++) {
+        DWORD slot = HashTerm(table->items[i].word) & (slotCount - 1);
+        while (slots[slot]) slot = (slot + 1) & (slotCount - 1);
+        slots[slot] = i + 1;
+    }
+    free(table->slots);
+    table->slots = slots;
+    table->slotCount = slotCount;
+    return TRUE;
+}
+
+// Add count to word (lowercase, shorter than LOGROLLUP_TERM_MAX)
+static BOOL AddTerm(TermTable *table, const char *word, DWORD count) {
+    if ((table->count + 1) * 2 > table->slotCount && !GrowTermSlots(table)) return FALSE;
+    
+    DWORD slot = HashTerm(word) & (table->slotCount - 1);
+    while (table->slots[slot]) {
+        LogRollupTerm *term = &table->items[table->slots[slot] - 1];
+        if (strcmp(term->word, word) == 0) {
+            term->count += count;
+            return TRUE;
+        }
+        slot = (slot + 1) & (table->slotCount - 1);
+    }
+    
+    if (table->count >= table->capacity) {
+        DWORD newCapacity = table->capacity > 0 ? table->capacity * 2 : 64;
+        LogRollupTerm *grown = (LogRollupTerm *)realloc(table->items, newCapacity * sizeof(LogRollupTerm));
+        if (!grown) return FALSE;
+        table->items = grown;
+        table->capacity = newCapacity;
+    }
+    LogRollupTerm *term = &table->items[table->count];
+    snprintf(term->word, sizeof(term->word), "%s", word);
+    term->count = count;
+    table->slots[slot] = ++table->count;
+    return TRUE;
+}
+
+static void FreeTerms(TermTable *table) {
+    free(table->items);
+    free(table->slots);
+    memset(table, 0, sizeof(TermTable));
+}
+
+// Headings that differ only in case are one category; the first spelling wins
+static BOOL AddCategory(CategoryList *list, const char *name, DWORD minutes, DWORD entries) {
+    for (DWORD i = 0; i < list->count; i++) {
+        if (_stricmp(list->items[i].name, name) == 0) {
+            list->items[i].minutes += minutes;
+            list->items[i].entries += entries;
+            return TRUE;
+        }
+    }
+    if (list->count >= list->capacity) {
+        if (list->capacity >= ROLLUP_MAX_CATEGORIES) return FALSE;
+        DWORD newCapacity = list->capacity > 0 ? list->capacity * 2 : 16;
+        LogRollupCategory *grown = (LogRollupCategory *)realloc(list->items, newCapacity * sizeof(LogRollupCategory));
+        if (!grown) return FALSE;
+        list->items = grown;
+        list->capacity = newCapacity;
+    }
+    LogRollupCategory *category = &list->items[list->count++];
+    snprintf(category->name, sizeof(category->name), "%s", name);
+    category->minutes = minutes;
+    category->entries = entries;
+    return TRUE;
+}
+
+static int CompareCategories(const void *a, const void *b) {
+    const LogRollupCategory *ca = (const LogRollupCategory *)a;
+    const LogRollupCategory *cb = (const LogRollupCategory *)b;
+    if (ca->minutes != cb->minutes) return ca->minutes > cb->minutes ? -1 : 1;
+    if (ca->entries != cb->entries) return ca->entries > cb->entries ? -1 : 1;
+    return strcmp(ca->name, cb->name);
+}
+
+static int CompareTerms(const void *a, const void *b) {
+    const LogRollupTerm *ta = (const LogRollupTerm *)a;
+    const LogRollupTerm *tb = (const LogRollupTerm *)b;
+    if (ta->count != tb->count) return ta->count > tb->count ? -1 : 1;
+    return strcmp(ta->word, tb->word);
+}
+
+static int CompareStopWord(const void *key, const void *item) {
+    return strcmp((const char *)key, *(const char * const *)item);
+}
+
+static BOOL IsBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static BOOL IsLetter(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+// Count the terms in one line of body text
+static BOOL CountTerms(TermTable *terms, const char *line, const char *end) {
+    const char *p = line;
+    while (p < end) {
+        if (!IsLetter(*p)) {
+            p++;
+            continue;
+        }
+        const char *start = p;
+        while (p < end && IsLetter(*p)) p++;
+        size_t len = (size_t)(p - start);
+    
+        // Letters glued to digits or non-ASCII bytes are codes or words
+        // this can't lowercase; skip them
+        BOOL glued = (start > line && (((BYTE)start[-1] & 0x80) || (start[-1] >= '0' && start[-1] <= '9'))) ||
+                     (p < end && (((BYTE)*p & 0x80) || (*p >= '0' && *p <= '9')));
+        if (len < 3 || len >= LOGROLLUP_TERM_MAX || glued) continue;
+    
+        char word[LOGROLLUP_TERM_MAX];
+        for (size_t i = 0; i < len; i++) {
+            word[i] = (char)(start[i] | 0x20);
+        }
+        word[len] = '\0';
+        if (bsearch(word, g_stopWords, sizeof(g_stopWords) / sizeof(g_stopWords[0]), sizeof(g_stopWords[0]),
+                    CompareStopWord)) {
+            continue;
+        }
+        if (!AddTerm(terms, word, 1)) return FALSE;
+    }
+    return TRUE;
+}
+
+// Split one entry into category sections and add them and its terms to
+// the day being built
+static BOOL AddEntry(CategoryList *categories, TermTable *terms, const char *text, DWORD len, DWORD minutes) {
+    const char *p = text;
+    const char *end = text + len;
+    const char *close = (const char *)memchr(p, ']', min(len, 12));
+    if (close) p = close + 1;
+    
+    char headings[ROLLUP_MAX_SECTIONS][LOGROLLUP_NAME_MAX];
+    int sections = 0;
+    int blankRun = 0;
+    BOOL first = TRUE;
+    while (p < end) {
+        const char *lineEnd = (const char *)memchr(p, '\n', (size_t)(end - p));
+        if (!lineEnd) lineEnd = end;
+        const char *start = p;
+        const char *stop = lineEnd;
+        p = lineEnd < end ? lineEnd + 1 : end;
+        while (start < stop && IsBlank(*start)) start++;
+        while (stop > start && IsBlank(stop[-1])) stop--;
+    
+        if (start == stop) {
+            blankRun++;
+            continue;
+        }
+        if ((first || blankRun >= 2) && sections < ROLLUP_MAX_SECTIONS) {
+            size_t nameLen = min((size_t)(stop - start), (size_t)LOGROLLUP_NAME_MAX - 1);
+            memcpy(headings[sections], start, nameLen);
+            headings[sections][nameLen] = '\0';
+            sections++;
+        } else if (!CountTerms(terms, start, stop)) {
+            return FALSE;
+        }
+        first = FALSE;
+        blankRun = 0;
+    }
+    
+    if (sections == 0) {
+        snprintf(headings[0], sizeof(headings[0]), "(untitled)");
+        sections = 1;
+    }
+    
+    // The first section takes what doesn't divide evenly
+    for (int i = 0; i < sections; i++) {
+        DWORD share = minutes / sections + (i == 0 ? minutes % sections : 0);
+        if (!AddCategory(categories, headings[i], share, 1)) return FALSE;
+    }
+    return TRUE;
+}
+
+// Hand a finished day's lists over to day, sorted and trimmed
+static void FinishDay(LogRollupDay *day, CategoryList *categories, TermTable *terms) {
+    if (categories->count > 1) qsort(categories->items, categories->count, sizeof(LogRollupCategory), CompareCategories);
+    if (terms->count > 1) qsort(terms->items, terms->count, sizeof(LogRollupTerm), CompareTerms);
+    
+    day->categoryCount = categories->count;
+    day->categories = categories->items;
+    day->termCount = min(terms->count, (DWORD)LOGROLLUP_DAY_TERMS);
+    day->terms = terms->items;
+    if (day->termCount > 0 && day->termCount < terms->count) {
+        LogRollupTerm *shrunk = (LogRollupTerm *)realloc(terms->items, day->termCount * sizeof(LogRollupTerm));
+        if (shrunk) day->terms = shrunk;
+    }
+    free(terms->slots);
+    memset(categories, 0, sizeof(CategoryList));
+    memset(terms, 0, sizeof(TermTable));
+}
+
+static void FreeDays(LogRollupFile *file) {
+    for (int i = 0; i < file->dayCount; i++) {
+        free(file->days[i].categories);
+        free(file->days[i].terms);
+    }
+    free(file->days);
+    file->days = NULL;
+    file->dayCount = 0;
+}
+
+// Parse one log into per-day aggregates; runs on a pool thread
+static BOOL ParseFile(LogRollupFile *file) {
+    FreeDays(file);
+    
+    LogIndex index;
+    if (!LogIndex_Load(&index, file->path)) return FALSE;
+    
+    HANDLE log = CreateFile(file->path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    LARGE_INTEGER size;
+    if (log == INVALID_HANDLE_VALUE || !GetFileSizeEx(log, &size) || size.QuadPart > MAXDWORD) {
+        if (log != INVALID_HANDLE_VALUE) CloseHandle(log);
+        LogIndex_Close(&index);
+        return FALSE;
+    }
+    HANDLE mapping = size.QuadPart > 0 ? CreateFileMapping(log, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+    const char *view = mapping ? (const char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    BOOL ok = size.QuadPart == 0 || view != NULL;
+    
+    // Records are sorted by stamp, so each day's entries sit together
+    int dayCapacity = 0;
+    CategoryList categories = {0};
+    TermTable terms = {0};
+    for (int i = 0; ok && view && i < index.count; i++) {
+        const LogIndexRecord *record = &index.records[i];
+        DWORD day = LOGINDEX_STAMP_DAY(record->stamp);
+        if (record->offset < 0 || record->offset + record->length > size.QuadPart) continue;
+    
+        if (file->dayCount == 0 || file->days[file->dayCount - 1].day != day) {
+            if (file->dayCount > 0) FinishDay(&file->days[file->dayCount - 1], &categories, &terms);
+            if (file->dayCount >= dayCapacity) {
+                int newCapacity = dayCapacity > 0 ? dayCapacity * 2 : 32;
+                LogRollupDay *grown = (LogRollupDay *)realloc(file->days, newCapacity * sizeof(LogRollupDay));
+                if (!grown) {
+                    ok = FALSE;
+                    break;
+                }
+                file->days = grown;
+                dayCapacity = newCapacity;
+            }
+            memset(&file->days[file->dayCount], 0, sizeof(LogRollupDay));
+            file->days[file->dayCount++].day = day;
+        }
+    
+        DWORD minutes = 0;
+        if (i + 1 < index.count && LOGINDEX_STAMP_DAY(index.records[i + 1].stamp) == day) {
+            minutes = LOGINDEX_STAMP_MINUTES(index.records[i + 1].stamp) - LOGINDEX_STAMP_MINUTES(record->stamp);
+        }
+        file->days[file->dayCount - 1].entries++;
+        ok = AddEntry(&categories, &terms, view + record->offset, record->length, minutes);
+    }
+    if (file->dayCount > 0) FinishDay(&file->days[file->dayCount - 1], &categories, &terms);
+    free(categories.items);
+    FreeTerms(&terms);
+    
+    if (view) UnmapViewOfFile(view);
+    if (mapping) CloseHandle(mapping);
+    CloseHandle(log);
+    LogIndex_Close(&index);
+    if (!ok) FreeDays(file);
+    return ok;
+}
+
+static VOID CALLBACK ParseFileWork(PTP_CALLBACK_INSTANCE instance, PVOID context, PTP_WORK work) {
+    ParseJob *job = (ParseJob *)context;
+    (void)instance;
+    (void)work;
+    
+    for (;;) {
+        LONG index = InterlockedIncrement(&job->next) - 1;
+        if (index >= job->count) break;
+        LogRollupFile *file = job->files[index];
+        if (!ParseFile(file)) {
+            // Zero stamps never match, so the next refresh tries again
+            memset(&file->writeTime, 0, sizeof(file->writeTime));
+            file->size = -1;
+            InterlockedIncrement(&job->failed);
+        }
+    }
+}
+
+static void FreeFiles(LogRollup *rollup) {
+    for (int i = 0; i < rollup->fileCount; i++) {
+        FreeDays(&rollup->files[i]);
+    }
+    free(rollup->files);
+    rollup->files = NULL;
+    rollup->fileCount = 0;
+    rollup->fileCapacity = 0;
+}
+
+static LogRollupFile* AddFile(LogRollup *rollup) {
+    if (rollup->fileCount >= rollup->fileCapacity) {
+        int newCapacity = rollup->fileCapacity > 0 ? rollup->fileCapacity * 2 : 16;
+        LogRollupFile *grown = (LogRollupFile *)realloc(rollup->files, newCapacity * sizeof(LogRollupFile));
+        if (!grown) return NULL;
+        rollup->files = grown;
+        rollup->fileCapacity = newCapacity;
+    }
+    LogRollupFile *file = &rollup->files[rollup->fileCount++];
+    memset(file, 0, sizeof(LogRollupFile));
+    return file;
+}
+
+// Read one cached file's days; FALSE if the cache is cut short or corrupt
+static BOOL ReadCachedDays(FILE *in, LogRollupFile *file, DWORD dayCount) {
+    if (dayCount > ROLLUP_MAX_DAYS) return FALSE;
+    if (dayCount == 0) return TRUE;
+    file->days = (LogRollupDay *)calloc(dayCount, sizeof(LogRollupDay));
+    if (!file->days) return FALSE;
+    
+    for (DWORD i = 0; i < dayCount; i++) {
+        LogRollupCacheDay cached;
+        if (fread(&cached, sizeof(cached), 1, in) != 1 || cached.categoryCount > ROLLUP_MAX_CATEGORIES ||
+            cached.termCount > LOGROLLUP_DAY_TERMS) {
+            return FALSE;
+        }
+    
+        LogRollupDay *day = &file->days[file->dayCount++];
+        day->day = cached.day;
+        day->entries = cached.entries;
+        day->categoryCount = cached.categoryCount;
+        day->termCount = cached.termCount;
+        day->categories = cached.categoryCount ? (LogRollupCategory *)malloc(cached.categoryCount * sizeof(LogRollupCategory)) : NULL;
+        day->terms = cached.termCount ? (LogRollupTerm *)malloc(cached.termCount * sizeof(LogRollupTerm)) : NULL;
+        if ((cached.categoryCount && (!day->categories ||
+                                      fread(day->categories, sizeof(LogRollupCategory), cached.categoryCount, in) != cached.categoryCount)) ||
+            (cached.termCount && (!day->terms ||
+                                  fread(day->terms, sizeof(LogRollupTerm), cached.termCount, in) != cached.termCount))) {
+            return FALSE;
+        }
+        for (DWORD c = 0; c < day->categoryCount; c++) {
+            day->categories[c].name[LOGROLLUP_NAME_MAX - 1] = '\0';
+        }
+        for (DWORD t = 0; t < day->termCount; t++) {
+            day->terms[t].word[LOGROLLUP_TERM_MAX - 1] = '\0';
+        }
+    }
+    return TRUE;
+}
+
+static BOOL LoadCache(LogRollup *rollup) {
+    FILE *in = fopen(rollup->cachePath, "rb");
+    if (!in) return FALSE;
+    
+    LogRollupCacheHeader header;
+    BOOL ok = fread(&header, sizeof(header), 1, in) == 1 && header.magic == LOGROLLUP_MAGIC &&
+              header.version == LOGROLLUP_VERSION && header.fileCount <= ROLLUP_MAX_FILES;
+    for (DWORD i = 0; ok && i < header.fileCount; i++) {
+        LogRollupCacheFile cached;
+        LogRollupFile *file = NULL;
+        ok = fread(&cached, sizeof(cached), 1, in) == 1 && (file = AddFile(rollup)) != NULL;
+        if (!ok) break;
+    
+        memcpy(file->path, cached.path, MAX_PATH);
+        file->path[MAX_PATH - 1] = '\0';
+        file->writeTime = cached.writeTime;
+        file->size = cached.size;
+        ok = ReadCachedDays(in, file, cached.dayCount);
+    }
+    fclose(in);
+    if (!ok) FreeFiles(rollup);
+    return ok;
+}
+
+BOOL LogRollup_Open(LogRollup *rollup, const char *cachePath) {
+    if (!rollup || !cachePath) return FALSE;
+    memset(rollup, 0, sizeof(LogRollup));
+    snprintf(rollup->cachePath, sizeof(rollup->cachePath), "%s", cachePath);
+    LoadCache(rollup);
+    return TRUE;
+}
+
+void LogRollup_Close(LogRollup *rollup) {
+    if (!rollup) return;
+    FreeFiles(rollup);
+    memset(rollup, 0, sizeof(LogRollup));
+}
+
+BOOL LogRollup_Save(const LogRollup *rollup) {
+    if (!rollup || !rollup->cachePath[0]) return FALSE;
+    
+    char tempPath[MAX_PATH + 4];
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", rollup->cachePath);
+    FILE *out = fopen(tempPath, "wb");
+    if (!out) return FALSE;
+    
+    LogRollupCacheHeader header = { LOGROLLUP_MAGIC, LOGROLLUP_VERSION, (DWORD)rollup->fileCount, 0 };
+    BOOL ok = fwrite(&header, sizeof(header), 1, out) == 1;
+    for (int i = 0; ok && i < rollup->fileCount; i++) {
+        const LogRollupFile *file = &rollup->files[i];
+        LogRollupCacheFile cached = {0};
+        memcpy(cached.path, file->path, MAX_PATH);
+        cached.writeTime = file->writeTime;
+        cached.size = file->size;
+        cached.dayCount = (DWORD)file->dayCount;
+        ok = fwrite(&cached, sizeof(cached), 1, out) == 1;
+    
+        for (int d = 0; ok && d < file->dayCount; d++) {
+            const LogRollupDay *day = &file->days[d];
+            LogRollupCacheDay cachedDay = { day->day, day->entries, day->categoryCount, day->termCount };
+            ok = fwrite(&cachedDay, sizeof(cachedDay), 1, out) == 1 &&
+                 fwrite(day->categories, sizeof(LogRollupCategory), day->categoryCount, out) == day->categoryCount &&
+                 fwrite(day->terms, sizeof(LogRollupTerm), day->termCount, out) == day->termCount;
+        }
+    }
+    if (fclose(out) != 0) ok = FALSE;
+    if (!ok || !MoveFileEx(tempPath, rollup->cachePath, MOVEFILE_REPLACE_EXISTING)) {
+        DeleteFile(tempPath);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+// logPath followed by its exports: "dir\WorkLog.txt" -> "dir\WorkLog_*.txt"
+static BOOL ListLogs(PathList *list, const char *logPath) {
+    if (!FileIO_AddPath(list, "", 0, logPath)) return FALSE;
+    
+    const char *slash = strrchr(logPath, '\\');
+    const char *forward = strrchr(logPath, '/');
+    if (forward > slash) slash = forward;
+    size_t dirLen = slash ? (size_t)(slash - logPath) + 1 : 0;
+    const char *dot = strrchr(logPath + dirLen, '.');
+    size_t stemLen = dot ? (size_t)(dot - logPath) : strlen(logPath);
+    
+    char pattern[MAX_PATH];
+    if (snprintf(pattern, sizeof(pattern), "%.*s_*%s", (int)stemLen, logPath, dot ? dot : "") >= (int)sizeof(pattern)) {
+        return FALSE;
+    }
+    WIN32_FIND_DATA fd;
+    HANDLE find = FindFirstFile(pattern, &fd);
+    if (find == INVALID_HANDLE_VALUE) return TRUE;  // No exports yet
+    
+    BOOL ok = TRUE;
+    do {
+        if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) continue;
+        char path[MAX_PATH];
+        if (snprintf(path, sizeof(path), "%.*s%s", (int)dirLen, logPath, fd.cFileName) >= (int)sizeof(path)) {
+            ok = FALSE;
+            continue;
+        }
+        ok = FileIO_AddPath(list, "", 0, path) && ok;
+    } while (FindNextFile(find, &fd));
+    FindClose(find);
+    return ok;
+}
+
+static const LogRollupFile* FindFile(const LogRollupFile *files, int count, const char *path) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp(files[i].path, path) == 0) return &files[i];
+    }
+    return NULL;
+}
+
+BOOL LogRollup_Refresh(LogRollup *rollup, const char *logPath, int maxThreads) {
+    if (!rollup || !logPath) return FALSE;
+    rollup->lastParsed = 0;
+    rollup->lastFailed = 0;
+    
+    PathList paths = {0};
+    BOOL listed = ListLogs(&paths, logPath);
+    
+    // Rebuild the file list from what is on disk, carrying over the days
+    // of files that haven't changed; files no longer there drop out
+    LogRollup fresh = {0};
+    int slots = paths.count > 0 ? paths.count : 1;
+    int *pending = (int *)malloc(slots * sizeof(int));
+    LogRollupFile **parse = (LogRollupFile **)malloc(slots * sizeof(LogRollupFile *));
+    BOOL ok = pending && parse;
+    int pendingCount = 0;
+    BOOL changed = FALSE;
+    for (int i = 0; ok && i < paths.count; i++) {
+        WIN32_FILE_ATTRIBUTE_DATA data;
+        if (!GetFileAttributesEx(paths.paths[i], GetFileExInfoStandard, &data)) continue;
+        LONGLONG size = ((LONGLONG)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+    
+        LogRollupFile *file = AddFile(&fresh);
+        if (!file) {
+            ok = FALSE;
+            break;
+        }
+        LogRollupFile *old = (LogRollupFile *)FindFile(rollup->files, rollup->fileCount, paths.paths[i]);
+        if (old && old->size == size && CompareFileTime(&old->writeTime, &data.ftLastWriteTime) == 0) {
+            *file = *old;
+            old->days = NULL;
+            old->dayCount = 0;
+            continue;
+        }
+        snprintf(file->path, sizeof(file->path), "%s", paths.paths[i]);
+        file->writeTime = data.ftLastWriteTime;
+        file->size = size;
+        pending[pendingCount++] = fresh.fileCount - 1;
+        changed = TRUE;
+    }
+    free(paths.paths);
+    if (!ok) {
+        // Days carried over are lost with fresh; their files must be read again
+        FreeFiles(&fresh);
+        FreeFiles(rollup);
+        free(pending);
+        free(parse);
+        return FALSE;
+    }
+    if (fresh.fileCount != rollup->fileCount) changed = TRUE;
+    
+    // Pointers only now that fresh.files is done growing
+    for (int i = 0; i < pendingCount; i++) {
+        parse[i] = &fresh.files[pending[i]];
+    }
+    free(pending);
+    
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    int threads = (int)info.dwNumberOfProcessors;
+    if (maxThreads > 0 && maxThreads < threads) threads = maxThreads;
+    
+    ParseJob job = {0};
+    job.files = parse;
+    job.count = pendingCount;
+    int helpers = min(threads, pendingCount) - 1;
+    PTP_WORK work = helpers > 0 ? CreateThreadpoolWork(ParseFileWork, &job, NULL) : NULL;
+    for (int i = 0; work && i < helpers; i++) {
+        SubmitThreadpoolWork(work);
+    }
+    ParseFileWork(NULL, &job, NULL);
+    if (work) {
+        WaitForThreadpoolWorkCallbacks(work, FALSE);
+        CloseThreadpoolWork(work);
+    }
+    free(parse);
+    
+    FreeFiles(rollup);
+    rollup->files = fresh.files;
+    rollup->fileCount = fresh.fileCount;
+    rollup->fileCapacity = fresh.fileCapacity;
+    rollup->lastParsed = pendingCount;
+    rollup->lastFailed = (int)job.failed;
+    
+    // A cache that fails to save only costs a full parse next time
+    if (changed) LogRollup_Save(rollup);
+    return listed && job.failed == 0;
+}
+
+typedef struct {
+    const LogRollupDay *day;
+    const LogRollupFile *file;
+} DaySource;
+
+// Best source first within each day: most entries, then newest file
+static int CompareSources(const void *a, const void *b) {
+    const DaySource *sa = (const DaySource *)a;
+    const DaySource *sb = (const DaySource *)b;
+    if (sa->day->day != sb->day->day) return sa->day->day < sb->day->day ? -1 : 1;
+    if (sa->day->entries != sb->day->entries) return sa->day->entries > sb->day->entries ? -1 : 1;
+    return -CompareFileTime(&sa->file->writeTime, &sb->file->writeTime);
+}
+
+// One source per day, ascending; *count gets how many
+static DaySource* ChooseDays(const LogRollup *rollup, int *count) {
+    int total = 0;
+    for (int i = 0; i < rollup->fileCount; i++) {
+        total += rollup->files[i].dayCount;
+    }
+    *count = 0;
+    DaySource *sources = (DaySource *)malloc((total > 0 ? total : 1) * sizeof(DaySource));
+    if (!sources) return NULL;
+    
+    for (int i = 0; i < rollup->fileCount; i++) {
+        for (int d = 0; d < rollup->files[i].dayCount; d++) {
+            sources[*count].day = &rollup->files[i].days[d];
+            sources[*count].file = &rollup->files[i];
+            (*count)++;
+        }
+    }
+    if (*count > 1) qsort(sources, *count, sizeof(DaySource), CompareSources);
+    
+    int kept = 0;
+    for (int i = 0; i < *count; i++) {
+        if (kept > 0 && sources[kept - 1].day->day == sources[i].day->day) continue;
+        sources[kept++] = sources[i];
+    }
+    *count = kept;
+    return sources;
+}
+
+// Calendar fields of a stamp's day through mktime, which also normalizes
+// tm_mday moved past the month
+static BOOL DayToTm(DWORD day, int offsetDays, struct tm *tm) {
+    memset(tm, 0, sizeof(struct tm));
+    tm->tm_year = LOGINDEX_STAMP_YEAR(day) - 1900;
+    tm->tm_mon = LOGINDEX_STAMP_MONTH(day) - 1;
+    tm->tm_mday = LOGINDEX_STAMP_DATE(day) + offsetDays;
+    tm->tm_hour = 12;
+    tm->tm_isdst = -1;
+    return mktime(tm) != (time_t)-1;
+}
+
+static DWORD PeriodStart(DWORD day, LogRollupPeriod period) {
+    if (period == LOGROLLUP_MONTH) return LOGINDEX_STAMP(LOGINDEX_STAMP_YEAR(day), LOGINDEX_STAMP_MONTH(day), 1, 0);
+    
+    struct tm tm;
+    if (!DayToTm(day, 0, &tm)) return LOGINDEX_STAMP_DAY(day);
+    if (!DayToTm(day, -((tm.tm_wday + 6) % 7), &tm)) return LOGINDEX_STAMP_DAY(day);
+    return LOGINDEX_STAMP(tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, 0);
+}
+
+typedef struct {
+    char *text;
+    size_t len;
+    size_t capacity;
+    BOOL failed;
+} TextBuffer;
+
+static void Appendf(TextBuffer *out, const char *format, ...) {
+    if (out->failed) return;
+    for (;;) {
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(out->text + out->len, out->capacity - out->len, format, args);
+        va_end(args);
+        if (n < 0) {
+            out->failed = TRUE;
+            return;
+        }
+        if ((size_t)n < out->capacity - out->len) {
+            out->len += n;
+            return;
+        }
+    
+        size_t newCapacity = out->capacity * 2 + n;
+        char *grown = (char *)realloc(out->text, newCapacity);
+        if (!grown) {
+            out->failed = TRUE;
+            return;
+        }
+        out->text = grown;
+        out->capacity = newCapacity;
+    }
+}
+
+// One week or month: sources[first, first + count)
+static BOOL ReportPeriod(TextBuffer *out, const DaySource *sources, int count, DWORD start, LogRollupPeriod period) {
+    CategoryList categories = {0};
+    TermTable terms = {0};
+    DWORD entries = 0;
+    DWORD minutes = 0;
+    BOOL ok = TRUE;
+    for (int i = 0; ok && i < count; i++) {
+        const LogRollupDay *day = sources[i].day;
+        entries += day->entries;
+        for (DWORD c = 0; ok && c < day->categoryCount; c++) {
+            minutes += day->categories[c].minutes;
+            ok = AddCategory(&categories, day->categories[c].name, day->categories[c].minutes, day->categories[c].entries);
+        }
+        for (DWORD t = 0; ok && t < day->termCount; t++) {
+            ok = AddTerm(&terms, day->terms[t].word, day->terms[t].count);
+        }
+    }
+    if (ok) {
+        if (categories.count > 1) qsort(categories.items, categories.count, sizeof(LogRollupCategory), CompareCategories);
+        if (terms.count > 1) qsort(terms.items, terms.count, sizeof(LogRollupTerm), CompareTerms);
+    
+        if (period == LOGROLLUP_WEEK) {
+            Appendf(out, "Week of %04d-%02d-%02d", LOGINDEX_STAMP_YEAR(start), LOGINDEX_STAMP_MONTH(start),
+                    LOGINDEX_STAMP_DATE(start));
+        } else {
+            Appendf(out, "%s %04d", g_monthNames[(LOGINDEX_STAMP_MONTH(start) + 11) % 12], LOGINDEX_STAMP_YEAR(start));
+        }
+        Appendf(out, ": %lu %s on %d %s, %luh %02lum tracked\r\n", (unsigned long)entries, entries == 1 ? "entry" : "entries",
+                count, count == 1 ? "day" : "days", (unsigned long)(minutes / 60), (unsigned long)(minutes % 60));
+    
+        Appendf(out, "  Entries per day:");
+        for (int i = 0; i < count; i++) {
+            struct tm tm;
+            DWORD day = sources[i].day->day;
+            const char *name = DayToTm(day, 0, &tm) ? g_dayNames[tm.tm_wday] : "";
+            if (i > 0 && i % 7 == 0) Appendf(out, "\r\n                  ");
+            Appendf(out, "%s %s %02d-%02d: %lu", i % 7 ? "," : "", name, LOGINDEX_STAMP_MONTH(day),
+                    LOGINDEX_STAMP_DATE(day), (unsigned long)sources[i].day->entries);
+        }
+        Appendf(out, "\r\n");
+    
+        for (DWORD c = 0; c < min(categories.count, (DWORD)LOGROLLUP_TOP); c++) {
+            const LogRollupCategory *category = &categories.items[c];
+            Appendf(out, "  %3luh %02lum  %3lu x  %s\r\n", (unsigned long)(category->minutes / 60),
+                    (unsigned long)(category->minutes % 60), (unsigned long)category->entries, category->name);
+        }
+        if (categories.count > LOGROLLUP_TOP) {
+            Appendf(out, "               (%lu more categories)\r\n", (unsigned long)(categories.count - LOGROLLUP_TOP));
+        }
+    
+        if (terms.count > 0) {
+            Appendf(out, "  Top terms:");
+            for (DWORD t = 0; t < min(terms.count, (DWORD)LOGROLLUP_TOP); t++) {
+                Appendf(out, "%s %s (%lu)", t ? "," : "", terms.items[t].word, (unsigned long)terms.items[t].count);
+            }
+            Appendf(out, "\r\n");
+        }
+        Appendf(out, "\r\n");
+    }
+    free(categories.items);
+    FreeTerms(&terms);
+    return ok;
+}
+
+char* LogRollup_Report(const LogRollup *rollup, LogRollupPeriod period) {
+    if (!rollup) return NULL;
+    
+    TextBuffer out = {0};
+    out.capacity = 4096;
+    out.text = (char *)malloc(out.capacity);
+    if (!out.text) return NULL;
+    out.text[0] = '\0';
+    
+    int count = 0;
+    DaySource *sources = ChooseDays(rollup, &count);
+    if (!sources) {
+        free(out.text);
+        return NULL;
+    }
+    
+    Appendf(&out, "%s summary of %d log %s (%d re-read", period == LOGROLLUP_WEEK ? "Weekly" : "Monthly",
+            rollup->fileCount, rollup->fileCount == 1 ? "file" : "files", rollup->lastParsed);
+    if (rollup->lastFailed > 0) Appendf(&out, ", %d unreadable", rollup->lastFailed);
+    Appendf(&out, ")\r\n\r\n");
+    if (count == 0) Appendf(&out, "No log entries found.\r\n");
+    
+    // Newest period first; sources run oldest to newest
+    int end = count;
+    BOOL ok = TRUE;
+    while (ok && end > 0) {
+        DWORD start = PeriodStart(sources[end - 1].day->day, period);
+        int first = end - 1;
+        while (first > 0 && PeriodStart(sources[first - 1].day->day, period) == start) first--;
+        ok = ReportPeriod(&out, &sources[first], end - first, start, period);
+        end = first;
+    }
+    free(sources);
+    
+    if (!ok || out.failed) {
+        free(out.text);
+        return NULL;
+    }
+    return out.text;
+}
+
+int LogRollup_Run(int argc, char **argv) {
+    FileIO_AttachParentConsole();
+    
+    LogRollupPeriod period = LOGROLLUP_WEEK;
+    const char *logPath = "WorkLog.txt";
+    int jobs = 0;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "week") == 0) {
+            period = LOGROLLUP_WEEK;
+        } else if (strcmp(argv[i], "month") == 0) {
+            period = LOGROLLUP_MONTH;
+        } else if (strcmp(argv[i], "--log") == 0 && i + 1 < argc) {
+            logPath = argv[++i];
+        } else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobs = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage: %s --summary [week|month] [--log file] [--jobs N]\n", argv[0]);
+            return 2;
+        }
+    }
+    
+    // The cache sits next to the log: WorkLog.txt -> WorkLog.rollup
+    char cachePath[MAX_PATH];
+    LogIndex_PathFor(logPath, cachePath, sizeof(cachePath));
+    char *ext = strrchr(cachePath, '.');
+    if (!ext || (size_t)(ext - cachePath) + sizeof(".rollup") > sizeof(cachePath)) {
+        fprintf(stderr, "Log path too long: %s\n", logPath);
+        return 2;
+    }
+    strcpy(ext, ".rollup");
+    
+    LogRollup rollup;
+    LogRollup_Open(&rollup, cachePath);
+    BOOL ok = LogRollup_Refresh(&rollup, logPath, jobs);
+    char *report = LogRollup_Report(&rollup, period);
+    LogRollup_Close(&rollup);
+    if (!report) {
+        fprintf(stderr, "Out of memory\n");
+        return 2;
+    }
+    
+    // stdout is in text mode and adds its own carriage returns
+    for (const char *p = report; *p; p++) {
+        if (*p != '\r') fputc(*p, stdout);
+    }
+    fflush(stdout);
+    free(report);
+    
+    if (!ok) fprintf(stderr, "Some logs could not be read; their entries are missing\n");
+    return ok ? 0 : 2;
+}
@@ -0,0 +1,126 @@
+#ifndef LOGROLLUP_H
+#define LOGROLLUP_H
+
+#include <windows.h>
+
+// Weekly and monthly summaries over the log history: WorkLog.txt and every
+// WorkLog_*.txt export next to it. Each file is parsed into per-day partial
+// aggregates (entries, time per category, term counts), which are kept in a
+// cache file (WorkLog.rollup) so a refresh only re-reads files whose write
+// time or size changed. Changed files are parsed in parallel on the thread
+// pool, one file per callback.
+//
+// Entries are dated through the log's index (logindex.h). An entry's time
+// runs until the next entry on the same day; a day's last entry counts as an
+// entry but adds no time. Its heading (the text after "[h:mmam]") names a
+// category, and so does any line after two or more blank lines, which is how
+// an entry covering several activities reads; the entry's time is split
+// evenly between them. Exports overlap the log, so each day is taken from
+// the file holding the most entries for it, the newest one on a tie.
+//
+// Cache layout, all little-endian:
+//
+//   LogRollupCacheHeader
+//   per file: LogRollupCacheFile, then per day: LogRollupCacheDay,
+//             LogRollupCategory categories[], LogRollupTerm terms[]
+//
+// A cache that fails to read is dropped and everything is parsed again.
+#define LOGROLLUP_MAGIC     0x43524C57u  // "WLRC"
+#define LOGROLLUP_VERSION   1
+#define LOGROLLUP_NAME_MAX  64           // Category headings are cut to this, NUL included
+#define LOGROLLUP_TERM_MAX  24           // Longer words are not counted as terms
+#define LOGROLLUP_DAY_TERMS 50           // Terms kept per day
+#define LOGROLLUP_TOP       8            // Categories and terms shown per week or month
+
+typedef struct {
+    char name[LOGROLLUP_NAME_MAX];
+    DWORD minutes;
+    DWORD entries;           // Entries with a section under this heading
+} LogRollupCategory;
+
+typedef struct {
+    char word[LOGROLLUP_TERM_MAX];   // Lowercase
+    DWORD count;
+} LogRollupTerm;
+
+typedef struct {
+    DWORD day;                       // LOGINDEX_STAMP_DAY
+    DWORD entries;
+    DWORD categoryCount;
+    DWORD termCount;
+    LogRollupCategory *categories;   // Most minutes first
+    LogRollupTerm *terms;            // Most frequent first, at most LOGROLLUP_DAY_TERMS
+} LogRollupDay;
+
+typedef struct {
+    char path[MAX_PATH];
+    FILETIME writeTime;              // What the days were parsed from; zero
+    LONGLONG size;                   // forces a re-read
+    LogRollupDay *days;              // Ascending
+    int dayCount;
+} LogRollupFile;
+
+typedef struct {
+    DWORD magic;
+    DWORD version;
+    DWORD fileCount;
+    DWORD reserved;
+} LogRollupCacheHeader;
+
+typedef struct {
+    char path[MAX_PATH];
+    FILETIME writeTime;
+    LONGLONG size;
+    DWORD dayCount;
+    DWORD reserved;
+} LogRollupCacheFile;
+
+typedef struct {
+    DWORD day;
+    DWORD entries;
+    DWORD categoryCount;
+    DWORD termCount;
+} LogRollupCacheDay;
+
+// Not thread-safe; one thread refreshes and reads it at a time
+typedef struct {
+    char cachePath[MAX_PATH];
+    LogRollupFile *files;
+    int fileCount;
+    int fileCapacity;
+    int lastParsed;          // Files the last refresh had to read
+    int lastFailed;          // ...and of those, how many could not be read
+} LogRollup;
+
+typedef enum {
+    LOGROLLUP_WEEK,          // Monday to Sunday
+    LOGROLLUP_MONTH
+} LogRollupPeriod;
+
+// Load the cache at cachePath; a missing or unreadable one opens empty
+BOOL LogRollup_Open(LogRollup *rollup, const char *cachePath);
+void LogRollup_Close(LogRollup *rollup);
+
+// Bring the aggregates up to date with logPath and the logPath stem's
+// "_*" exports beside it (WorkLog.txt -> WorkLog_*.txt), re-reading changed
+// files on up to maxThreads threads (0 = one per processor), and save the
+// cache if anything changed. FALSE if some file could not be read; its
+// days are left out until a later refresh reads it.
+BOOL LogRollup_Refresh(LogRollup *rollup, const char *logPath, int maxThreads);
+
+// Write the cache out (temp file, then replace)
+BOOL LogRollup_Save(const LogRollup *rollup);
+
+// Text report of every week or month, newest first, with CRLF line ends
+// so it shows as-is in an edit control. Caller frees; NULL if out of memory.
+char* LogRollup_Report(const LogRollup *rollup, LogRollupPeriod period);
+
+// Console entry point:
+//
+//     Logger.exe --summary [week|month] [--log WorkLog.txt] [--jobs N]
+//
+// Prints the report to stdout. Returns the exit code: 0, or 2 if some log
+// could not be read or the arguments were wrong.
+int LogRollup_Run(int argc, char **argv);
+
+#endif // LOGROLLUP_H
@@ -0,0 +1,147 @@
+#include "logwriter.h"
+#include "perfstats.h"
+#include "fileio.h"
+#include <stdlib.h>
+#include <string.h>
+
+BOOL LogWriter_Open(LogWriter *writer, const char *path, LogWriterMode mode, DWORD bufferSize, DWORD flushIntervalMs) {
+    if (!writer || !path) return FALSE;
+    memset(writer, 0, sizeof(LogWriter));
+    
+    // FILE_APPEND_DATA without FILE_WRITE_DATA makes every write land at the
+    // end, even if another writer truncated or rewrote the file meanwhile
+    writer->file = CreateFile(path, GENERIC_READ | FILE_APPEND_DATA,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (writer->file == INVALID_HANDLE_VALUE) {
+        writer->file = NULL;
+        return FALSE;
+    }
+    
+    writer->mode = mode;
+    writer->flushIntervalMs = flushIntervalMs;
+    if (mode == LOGWRITER_BUFFERED && bufferSize > 0) {
+        writer->buffer = (char *)malloc(bufferSize);
+        writer->capacity = writer->buffer ? bufferSize : 0;
+    }
+    
+    LogWriter_Resync(writer);
+    return TRUE;
+}
+
+BOOL LogWriter_Close(LogWriter *writer) {
+    if (!writer) return TRUE;
+    BOOL ok = TRUE;
+    if (writer->file) {
+        ok = !LogWriter_HasPending(writer) || LogWriter_Flush(writer);
+        CloseHandle(writer->file);
+    }
+    free(writer->buffer);
+    memset(writer, 0, sizeof(LogWriter));
+    return ok;
+}
+
+// Write bytes straight to the file, counting what reached it
+static BOOL EmitDirect(LogWriter *writer, const char *data, DWORD len) {
+    DWORD done;
+    BOOL ok = FileIO_Write(writer->file, data, len, &done);
+    writer->size += done;
+    if (done > 0) writer->lastChar = data[done - 1];
+    return ok;
+}
+
+// Put bytes in the buffer, or straight to the file when unbuffered or too
+// large. size and lastChar only move for bytes that were taken.
+static BOOL Emit(LogWriter *writer, const char *data, DWORD len) {
+    if (len == 0) return TRUE;
+    if (writer->capacity == 0) return EmitDirect(writer, data, len);
+    
+    if (writer->used + len > writer->capacity) {
+        if (!LogWriter_Flush(writer)) return FALSE;
+        if (len > writer->capacity) return EmitDirect(writer, data, len);
+    }
+    
+    if (writer->used == 0) writer->pendingSince = GetTickCount();
+    memcpy(writer->buffer + writer->used, data, len);
+    writer->used += len;
+    writer->size += len;
+    writer->lastChar = data[len - 1];
+    return TRUE;
+}
+
+BOOL LogWriter_Append(LogWriter *writer, const char *text, DWORD len) {
+    if (!writer || !writer->file || !text) return FALSE;
+    
+    BOOL ok = TRUE;
+    if (writer->lastChar != 0 && writer->lastChar != '\n' && writer->lastChar != '\r') {
+        ok = Emit(writer, "\r\n", 2);
+    }
+    ok = ok && Emit(writer, text, len);
+    
+    if (ok && writer->mode == LOGWRITER_DURABLE) {
+        ok = LogWriter_Flush(writer);
+    } else if (ok && writer->used >= writer->capacity) {
+        // The entry is taken either way; if this fails it stays pending and
+        // the next flush retries it
+        LogWriter_Flush(writer);
+    }
+    return ok;
+}
+
+BOOL LogWriter_Flush(LogWriter *writer) {
+    if (!writer || !writer->file) return FALSE;
+    if (writer->used == 0 && writer->mode != LOGWRITER_DURABLE) return TRUE;
+    
+    LONGLONG start = PerfStats_Start();
+    BOOL ok = TRUE;
+    if (writer->used > 0) {
+        // What didn't make it stays buffered, still counted in size, for
+        // the next flush
+        DWORD done;
+        ok = FileIO_Write(writer->file, writer->buffer, writer->used, &done);
+        memmove(writer->buffer, writer->buffer + done, writer->used - done);
+        writer->used -= done;
+    }
+    if (ok && writer->mode == LOGWRITER_DURABLE) {
+        ok = FlushFileBuffers(writer->file);
+    }
+    PerfStats_Stop(PERF_LOG_FLUSH, start);
+    return ok;
+}
+
+BOOL LogWriter_FlushIfDue(LogWriter *writer) {
+    if (!LogWriter_HasPending(writer)) return TRUE;
+    if (GetTickCount() - writer->pendingSince < writer->flushIntervalMs) return TRUE;
+    return LogWriter_Flush(writer);
+}
+
+BOOL LogWriter_HasPending(const LogWriter *writer) {
+    return writer && writer->file && writer->used > 0;
+}
+
+LONGLONG LogWriter_GetSize(const LogWriter *writer) {
+    return writer && writer->file ? writer->size : 0;
+}
+
+void LogWriter_Resync(LogWriter *writer) {
+    if (!writer || !writer->file) return;
+    
+    // Anything a failed flush left buffered still lands after the file's end
+    LogWriter_Flush(writer);
+    writer->lastChar = writer->used > 0 ? writer->buffer[writer->used - 1] : 0;
+    writer->size = writer->used;
+    
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(writer->file, &size) || size.QuadPart == 0) return;
+    writer->size += size.QuadPart;
+    if (writer->used > 0) return;
+    
+    LARGE_INTEGER offset;
+    offset.QuadPart = size.QuadPart - 1;
+    char last;
+    DWORD read = 0;
+    if (SetFilePointerEx(writer->file, offset, NULL, FILE_BEGIN) &&
+        ReadFile(writer->file, &last, 1, &read, NULL) && read == 1) {
+        writer->lastChar = last;
+    }
+}
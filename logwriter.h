@@ -0,0 +1,50 @@
+#ifndef LOGWRITER_H
+#define LOGWRITER_H
+
+#include <windows.h>
+
+typedef enum {
+    LOGWRITER_BUFFERED,  // Batch entries; flush on size, interval or demand
+    LOGWRITER_DURABLE    // Write and FlushFileBuffers on every entry
+} LogWriterMode;
+
+// Append-only writer that keeps the log open between entries. The last byte
+// on disk is cached so entries can be separated without re-reading the file.
+// Not thread-safe; the UI thread owns it.
+typedef struct {
+    HANDLE file;
+    LogWriterMode mode;
+    char *buffer;            // Entries not yet written
+    DWORD used;
+    DWORD capacity;          // Buffered bytes that force a flush
+    DWORD flushIntervalMs;   // Longest an entry may sit in the buffer
+    DWORD pendingSince;      // GetTickCount when the buffer became non-empty
+    char lastChar;           // Last byte of the log including buffered data, 0 if empty
+    LONGLONG size;           // Length of the log including buffered data
+} LogWriter;
+
+BOOL LogWriter_Open(LogWriter *writer, const char *path, LogWriterMode mode, DWORD bufferSize, DWORD flushIntervalMs);
+// FALSE if buffered entries could not be written and were dropped
+BOOL LogWriter_Close(LogWriter *writer);
+
+// Queue one entry, preceded by CRLF if the log doesn't end in a newline.
+// FALSE if it could not be taken (or, in durable mode, written through).
+BOOL LogWriter_Append(LogWriter *writer, const char *text, DWORD len);
+
+// Write out buffered entries (and hit the disk in durable mode). On failure
+// the unwritten bytes stay buffered, so a later flush retries them.
+BOOL LogWriter_Flush(LogWriter *writer);
+
+// Flush if the oldest buffered entry has waited flushIntervalMs; for timers
+BOOL LogWriter_FlushIfDue(LogWriter *writer);
+
+BOOL LogWriter_HasPending(const LogWriter *writer);
+
+// Offset just past the last appended entry, counting buffered data; an
+// entry of len bytes starts at LogWriter_GetSize() - len after its Append
+LONGLONG LogWriter_GetSize(const LogWriter *writer);
+
+// Re-read the cached tail after the file was rewritten by someone else
+void LogWriter_Resync(LogWriter *writer);
+
+#endif // LOGWRITER_H
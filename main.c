@@ -1,7 +1,20 @@
 #include <windows.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include "spellchecker.h"
+#include "tokenizer.h"
+#include "spellworker.h"
+#include "logwriter.h"
+#include "logexport.h"
+#include "logarchive.h"
+#include "logpager.h"
+#include "logindex.h"
+#include "searchindex.h"
+#include "batchcheck.h"
+#include "logrollup.h"
+#include "perfstats.h"
 
 // Helper macros for mouse position extraction
 #define GET_X_LPARAM(lp) ((int)(short)LOWORD(lp))
@@ -11,17 +24,69 @@
 static SpellChecker *g_spellChecker = NULL;
 static HWND g_hwndInput = NULL;
 static UINT_PTR g_spellCheckTimer = 0;
-static DWORD g_lastSpellCheckTime = 0;
-static BOOL g_spellCheckEnabled = TRUE;
+static BOOL g_spellCheckEnabled = FALSE; // Turned on once the dictionaries are in
+static HANDLE g_dictionaryLoader = NULL;   // Thread loading the dictionaries, until it reports back
+static const char *g_teamDictionaries[SPELLCHECKER_MAX_LAYERS - 1]; // --dictionary <file>: stacked on dictionary.txt
+static int g_teamDictionaryCount = 0;
 static int g_contextMenuWordIndex = -1;
 static HWND g_hwndTooltip = NULL;
+static WCHAR *g_lastCheckedText = NULL;  // Snapshot the current misspelled list describes
+static int g_lastCheckedLen = 0;
+static BOOL g_spellCheckFullPass = TRUE; // Dictionaries changed; incremental results are stale
+static SpellWorker *g_spellWorker = NULL;  // Background checker; NULL = check on the UI thread
+static DWORD g_spellCheckGeneration = 0;   // Bumped per submitted snapshot; older results are dropped
+static DWORD g_spellCheckDue = 0;          // Tick the scheduled check should run at
+static DWORD g_checkedHash = 0;            // Content hash of the text last checked...
+static int g_checkedHashLen = -1;          // ...and its length; -1 = nothing checked yet
+static int g_lastInputLen = 0;             // Input length at the previous EN_CHANGE, to spot pastes
+static BOOL g_spellCheckWordEnded = FALSE; // The character just typed ended a word
+
+// Squiggles currently on screen, in client coordinates and text order. Paints
+// redraw these; a new check result invalidates only the rectangles that differ.
+static RECT *g_squiggles = NULL;
+static int g_squiggleCount = 0;
+static int g_squiggleCapacity = 0;
+static int g_squiggleFirstLine = -1;       // Scroll position the rectangles were computed for
+static int g_squiggleClientWidth = -1;     // Wrap width they were computed for
+
+// Log writer globals
+static LogWriter g_logWriter = {0};        // Opened on the first entry
+static BOOL g_durableLog = FALSE;          // --durable-log: flush every entry to disk
+static BOOL g_logFlushTimerArmed = FALSE;
+static BOOL g_logFlushFailed = FALSE;      // Reported; cleared once a retry succeeds
+static HWND g_hwndStatus = NULL;
+static LogIndex g_logIndex = {0};          // Dates of WorkLog.txt entries; opened with the writer or View
+static LogExport *g_logExport = NULL;      // Export in progress, if any
+static char g_exportFileName[64] = {0};
+static BOOL g_archiveExports = FALSE;      // --archive-exports: append to a monthly archive instead of copying
+
+// Search globals
+static SearchIndex g_searchIndex = {0};    // Words of WorkLog.txt entries; opened with the log index
+static HWND g_hwndSearch = NULL;
+static HWND g_hwndResults = NULL;          // Replaces the input box while showing matches
+static WNDPROC g_oldSearchProc = NULL;
+
+// Diagnostics globals
+static HWND g_hwndDiagnostics = NULL;      // Hidden until Ctrl+Shift+D
+static HWND g_hwndDiagnosticsText = NULL;
+static BOOL g_perfStatsFile = FALSE;       // --perf-stats: write perfstats.txt on exit
+
+// Summary globals
+static HWND g_hwndSummary = NULL;          // Hidden until Ctrl+Shift+S
+static HWND g_hwndSummaryText = NULL;
+static LogRollup g_logRollup = {0};        // Aggregates of the log history; owned by the thread below while it runs
+static HANDLE g_summaryBuilder = NULL;     // Thread refreshing g_logRollup, until it reports back
 
 // Global variables for view/edit mode
 static BOOL isViewMode = FALSE;
 static HWND hwndSaveBtn = NULL;
 static HWND hwndCancelBtn = NULL;
-static char originalContent[4096] = {0};
-static char mainInputBackup[4096] = {0};
+static HWND hwndPrevPageBtn = NULL;
+static HWND hwndNextPageBtn = NULL;
+static WCHAR *mainInputBackup = NULL;    // What the user was typing before View
+static LRESULT mainInputLimit = 0;       // Its typing limit, lifted while viewing
+static LogPager g_logPager = {0};        // Windowed access to WorkLog.txt while viewing
+static int g_viewPage = 0;
 
 #define ID_INPUT 1
 #define ID_ADD 2
@@ -29,40 +94,124 @@ static char mainInputBackup[4096] = {0};
 #define ID_EXPORT 4
 #define ID_SAVE 5
 #define ID_CANCEL 6
+#define ID_STATUS 7
+#define ID_PAGE_PREV 8
+#define ID_PAGE_NEXT 9
+#define ID_DAY_PREV 10
+#define ID_DAY_NEXT 11
+#define ID_SEARCH 12
+#define ID_SEARCH_RESULTS 13
+#define ID_DIAGNOSTICS 14
+#define ID_SUMMARY 15
 #define ID_SPELLCHECK_TIMER 100
+#define ID_LOG_FLUSH_TIMER 101
+#define ID_DIAGNOSTICS_TIMER 102
 #define ID_CONTEXT_MENU_SUGGESTION_BASE 1000
 #define ID_CONTEXT_MENU_ADD_DICT 1100
 #define ID_CONTEXT_MENU_IGNORE 1101
-#define SPELLCHECK_DEBOUNCE_MS 150
+#define SPELLCHECK_MIN_DELAY_MS 80        // Pause in typing before a check
+#define SPELLCHECK_MAX_DELAY_MS 1000
+#define SPELLCHECK_IDLE_DELAY_MS 750       // Quiet time wanted before checking a long paste
+#define SPELLCHECK_PASTE_CHARS 4096        // A change this large is treated as a paste
+#define SPELLCHECK_IMMEDIATE_COST_MS 30    // Checks cheaper than this run as soon as a word ends
+#define WM_APP_SPELLCHECK_DONE (WM_APP + 1)
+#define WM_APP_EXPORT_PROGRESS (WM_APP + 2)
+#define WM_APP_EXPORT_DONE (WM_APP + 3)
+#define WM_APP_DICTIONARY_LOADED (WM_APP + 4)
+#define WM_APP_SUMMARY_DONE (WM_APP + 5)
+#define LOG_BUFFER_SIZE (64 * 1024)
+#define LOG_FLUSH_INTERVAL_MS 1000
+#define SEARCH_BOX_HEIGHT 24
+#define SEARCH_MAX_RESULTS 500
+#define DIAGNOSTICS_REFRESH_MS 1000
 
 // Function declarations
 LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
 LRESULT CALLBACK EditProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
+LRESULT CALLBACK SearchProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
+LRESULT CALLBACK DiagnosticsProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
+LRESULT CALLBACK SummaryProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
 void AddLogEntry(HWND hwndInput);
-void ExportLog();
+void ExportLog(HWND hwnd);
+void ShowLogPage(int index);
+void ShowLogDay(int direction);
+void OpenLogIndexes(void);
+BOOL RecoverLogSave(void);
+void RunSearch(void);
+void ShowSearchResults(BOOL show);
+void OpenSearchResult(HWND hwnd);
+void ToggleDiagnostics(HWND owner);
+void RefreshDiagnostics(void);
+void ToggleSummary(HWND owner);
+void RefreshSummary(HWND hwnd);
+void OnSummaryDone(char *text);
+void KeepLogPageEdits(void);
 void InitializeSpellChecker(void);
 void CleanupSpellChecker(void);
+void StartDictionaryLoad(HWND hwnd);
+void OnDictionariesLoaded(BOOL loaded);
 void TriggerSpellCheck(void);
+void ScheduleSpellCheck(DWORD delayMs);
+void OnInputChanged(void);
+void RunSpellCheck(void);
+void UpdateSpellCheckDisplay(void);
 void CALLBACK SpellCheckTimerProc(HWND hwnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTime);
-void DrawMisspelledUnderlines(HWND hwnd);
+void DrawMisspelledUnderlines(HWND hwnd, const RECT *damage);
+void RefreshSquiggles(BOOL invalidateChanges);
 BOOL HandleSpellCheckContextMenu(HWND hwnd, int xPos, int yPos);
 void ReplaceWord(const char *oldWord, const char *newWord);
 
 // Keep original edit control procedure so we can forward messages we don't handle
 static WNDPROC g_oldEditProc = NULL;
 
-// Initialize spell checker at startup
+// Create the spell checker at startup. Its dictionaries are loaded once the
+// window is up (StartDictionaryLoad); until then nothing is flagged.
 void InitializeSpellChecker(void) {
-    g_spellChecker = SpellChecker_Create();
-    if (g_spellChecker) {
-        if (!SpellChecker_LoadDictionary(g_spellChecker, "dictionary.txt")) {
-            MessageBox(NULL, "Warning: Could not load spell-check dictionary. Spell checking disabled.", 
-                      "Dictionary Load Error", MB_OK | MB_ICONWARNING);
-            g_spellCheckEnabled = FALSE;
-        } else {
-            SpellChecker_LoadUserDictionary(g_spellChecker, "user_dictionary.txt");
-            g_spellCheckEnabled = TRUE;
-        }
+    g_spellChecker = SpellChecker_Create(DICTIONARY_BACKEND_HASH);
+    g_spellCheckEnabled = FALSE;
+}
+
+static BOOL LoadDictionaries(void) {
+    if (!SpellChecker_LoadDictionary(g_spellChecker, "dictionary.txt")) return FALSE;
+    for (int i = 0; i < g_teamDictionaryCount; i++) {
+        SpellChecker_AddDictionary(g_spellChecker, g_teamDictionaries[i]);
+    }
+    SpellChecker_LoadUserDictionary(g_spellChecker, "user_dictionary.txt");
+    return TRUE;
+}
+
+static DWORD WINAPI DictionaryLoaderThread(LPVOID param) {
+    BOOL loaded = LoadDictionaries();
+    PostMessage((HWND)param, WM_APP_DICTIONARY_LOADED, (WPARAM)loaded, 0);
+    return 0;
+}
+
+// The dictionaries finished loading (WM_APP_DICTIONARY_LOADED): check
+// whatever was typed meanwhile
+void OnDictionariesLoaded(BOOL loaded) {
+    if (g_dictionaryLoader) {
+        WaitForSingleObject(g_dictionaryLoader, INFINITE);
+        CloseHandle(g_dictionaryLoader);
+        g_dictionaryLoader = NULL;
+    }
+    if (!loaded) {
+        MessageBox(NULL, "Warning: Could not load spell-check dictionary. Spell checking disabled.", 
+                  "Dictionary Load Error", MB_OK | MB_ICONWARNING);
+        return;
+    }
+    g_spellCheckEnabled = TRUE;
+    g_spellCheckFullPass = TRUE;
+    RunSpellCheck();
+}
+
+// Load the dictionaries on a thread of their own so the window takes input
+// right away, whatever their size. Loads in place if the thread can't start.
+void StartDictionaryLoad(HWND hwnd) {
+    if (!g_spellChecker) return;
+    
+    g_dictionaryLoader = CreateThread(NULL, 0, DictionaryLoaderThread, hwnd, 0, NULL);
+    if (!g_dictionaryLoader) {
+        OnDictionariesLoaded(LoadDictionaries());
     }
 }
 
@@ -72,6 +221,17 @@ void CleanupSpellChecker(void) {
         KillTimer(NULL, g_spellCheckTimer);
         g_spellCheckTimer = 0;
     }
+    // Stop the loader and checker threads before the SpellChecker they use goes away
+    if (g_dictionaryLoader) {
+        WaitForSingleObject(g_dictionaryLoader, INFINITE);
+        CloseHandle(g_dictionaryLoader);
+        g_dictionaryLoader = NULL;
+    }
+    SpellWorker_Stop(g_spellWorker);
+    g_spellWorker = NULL;
+    free(g_lastCheckedText);
+    g_lastCheckedText = NULL;
+    g_lastCheckedLen = 0;
     if (g_spellChecker) {
         SpellChecker_SaveUserDictionary(g_spellChecker, "user_dictionary.txt");
         SpellChecker_Destroy(g_spellChecker);
@@ -79,48 +239,169 @@ void CleanupSpellChecker(void) {
     }
 }
 
-// Trigger spell check with debouncing
+// FNV-1a over the text, to tell a real change from one that put back what
+// was already checked
+static DWORD HashText(const WCHAR *text, int len) {
+    DWORD hash = 2166136261u;
+    for (int i = 0; i < len; i++) {
+        hash ^= text[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Pause before checking text of textLen characters: longer when the last
+// check was slow or the text is big, so typing isn't interrupted by checks
+// that will be superseded anyway
+static DWORD SpellCheckDelay(int textLen) {
+    DWORD delay = SPELLCHECK_MIN_DELAY_MS + 2 * g_spellChecker->lastCheckTime + (DWORD)textLen / 4096;
+    return min(delay, SPELLCHECK_MAX_DELAY_MS);
+}
+
+// Check after the usual pause (dictionary changes, replaced text)
 void TriggerSpellCheck(void) {
+    if (!g_spellCheckEnabled || !g_spellChecker || !g_hwndInput) return;
+    ScheduleSpellCheck(SpellCheckDelay(GetWindowTextLengthW(g_hwndInput)));
+}
+
+// Run the check delayMs from now. A pending check is pushed back rather
+// than re-created; the timer re-arms itself if it fires early.
+void ScheduleSpellCheck(DWORD delayMs) {
     if (!g_spellCheckEnabled || !g_spellChecker) return;
     
-    // Kill existing timer if any
-    if (g_spellCheckTimer) {
-        KillTimer(NULL, g_spellCheckTimer);
+    g_spellCheckDue = GetTickCount() + delayMs;
+    if (!g_spellCheckTimer) {
+        g_spellCheckTimer = SetTimer(NULL, ID_SPELLCHECK_TIMER, delayMs, SpellCheckTimerProc);
     }
+}
+
+// The input box's text changed (EN_CHANGE). A finished word is checked
+// right away when checks are cheap; a long paste waits for a pause.
+void OnInputChanged(void) {
+    if (!g_spellCheckEnabled || !g_spellChecker || !g_hwndInput) return;
+    
+    int textLen = GetWindowTextLengthW(g_hwndInput);
+    int delta = abs(textLen - g_lastInputLen);
+    g_lastInputLen = textLen;
+    BOOL wordEnded = g_spellCheckWordEnded;
+    g_spellCheckWordEnded = FALSE;
     
-    // Set new timer for debounced spell check
-    g_spellCheckTimer = SetTimer(NULL, ID_SPELLCHECK_TIMER, SPELLCHECK_DEBOUNCE_MS, SpellCheckTimerProc);
+    if (delta >= SPELLCHECK_PASTE_CHARS) {
+        ScheduleSpellCheck(max(SpellCheckDelay(textLen), SPELLCHECK_IDLE_DELAY_MS));
+    } else if (wordEnded && g_spellChecker->lastCheckTime < SPELLCHECK_IMMEDIATE_COST_MS) {
+        RunSpellCheck();
+    } else {
+        ScheduleSpellCheck(SpellCheckDelay(textLen));
+    }
 }
 
 // Timer callback for spell checking
 void CALLBACK SpellCheckTimerProc(HWND hwnd, UINT uMsg, UINT_PTR idEvent, DWORD dwTime) {
-    if (!g_spellCheckEnabled || !g_spellChecker || !g_hwndInput) return;
+    // Typing since the timer was set moved the check later
+    int remaining = (int)(g_spellCheckDue - GetTickCount());
+    if (remaining > 0 && g_spellCheckTimer) {
+        g_spellCheckTimer = SetTimer(NULL, g_spellCheckTimer, (UINT)remaining, SpellCheckTimerProc);
+        return;
+    }
+    RunSpellCheck();
+}
+
+// Check the input box now, unless it holds exactly what was checked last
+void RunSpellCheck(void) {
+    if (!g_spellCheckEnabled || !g_spellChecker || !g_hwndInput) goto cleanup;
     
     // Get text from edit control
-    int textLen = GetWindowTextLength(g_hwndInput);
+    int textLen = GetWindowTextLengthW(g_hwndInput);
     if (textLen == 0) {
+        if (g_checkedHashLen == 0 && !g_spellCheckFullPass) goto cleanup;
+        g_checkedHash = HashText(L"", 0);
+        g_checkedHashLen = 0;
+        
         if (g_spellChecker->misspelled.count > 0) {
             g_spellChecker->misspelled.count = 0;
-            InvalidateRect(g_hwndInput, NULL, FALSE);
+            UpdateSpellCheckDisplay();
+        }
+        free(g_lastCheckedText);
+        g_lastCheckedText = NULL;
+        g_lastCheckedLen = 0;
+        g_spellCheckFullPass = FALSE;
+        
+        // Supersede any check still in flight and reset the worker's baseline
+        if (g_spellWorker) {
+            WCHAR *empty = (WCHAR *)calloc(1, sizeof(WCHAR));
+            SpellWorker_Submit(g_spellWorker, empty, 0, ++g_spellCheckGeneration, TRUE);
         }
         goto cleanup;
     }
     
-    char *text = (char *)malloc(textLen + 1);
+    // Read as UTF-16 so positions are the control's character indexes and
+    // nothing is lost to the ANSI code page
+    WCHAR *text = (WCHAR *)malloc((textLen + 1) * sizeof(WCHAR));
     if (!text) goto cleanup;
     
-    GetWindowText(g_hwndInput, text, textLen + 1);
+    textLen = GetWindowTextW(g_hwndInput, text, textLen + 1);
+    g_lastInputLen = textLen;
     
-    // Perform spell check
-    SpellChecker_Check(g_spellChecker, text);
+    DWORD hash = HashText(text, textLen);
+    if (hash == g_checkedHash && textLen == g_checkedHashLen && !g_spellCheckFullPass) {
+        free(text);
+        goto cleanup;
+    }
+    g_checkedHash = hash;
+    g_checkedHashLen = textLen;
+    
+    // Hand the snapshot to the checker thread; results come back as WM_APP_SPELLCHECK_DONE
+    if (g_spellWorker) {
+        if (SpellWorker_Submit(g_spellWorker, text, textLen, ++g_spellCheckGeneration, g_spellCheckFullPass)) {
+            g_spellCheckFullPass = FALSE;
+        } else {
+            g_checkedHashLen = -1;
+        }
+        goto cleanup;
+    }
+    
+    // Perform spell check, re-scanning only the edited span when the previous
+    // results are still valid for the unchanged parts of the buffer
+    if (g_lastCheckedText && !g_spellCheckFullPass) {
+        DWORD editStart, oldLen, newLen;
+        SpellChecker_ComputeEditRangeW(g_lastCheckedText, g_lastCheckedLen, text, textLen,
+                                       &editStart, &oldLen, &newLen);
+        if (oldLen != 0 || newLen != 0) {
+            SpellChecker_CheckRangeIntoW(g_spellChecker, text, (DWORD)textLen, editStart, oldLen, newLen,
+                                         &g_spellChecker->misspelled);
+        }
+    } else {
+        SpellChecker_CheckIntoW(g_spellChecker, text, (DWORD)textLen, &g_spellChecker->misspelled);
+        g_spellCheckFullPass = FALSE;
+    }
+    
+    // Keep this pass's text as the baseline for the next incremental check
+    free(g_lastCheckedText);
+    g_lastCheckedText = text;
+    g_lastCheckedLen = textLen;
+    
+    UpdateSpellCheckDisplay();
+
+cleanup:
+    // Kill timer after spell check
+    if (g_spellCheckTimer) {
+        KillTimer(NULL, g_spellCheckTimer);
+        g_spellCheckTimer = 0;
+    }
+}
+
+// Reflect the current misspelled list in the title bar and edit control
+void UpdateSpellCheckDisplay(void) {
+    if (!g_spellChecker || !g_hwndInput) return;
     
     // Create or update tooltip with misspelled words
     if (g_spellChecker->misspelled.count > 0) {
-        char tooltipText[512] = "Misspelled words:\n";
-        for (int i = 0; i < g_spellChecker->misspelled.count && i < 10; i++) {
-            strcat(tooltipText, "- ");
-            strcat(tooltipText, g_spellChecker->misspelled.words[i].word);
-            strcat(tooltipText, "\n");
+        // Long spellings are cut off at the end of the buffer
+        char tooltipText[512];
+        int used = snprintf(tooltipText, sizeof(tooltipText), "Misspelled words:\n");
+        for (int i = 0; i < g_spellChecker->misspelled.count && i < 10 && used < (int)sizeof(tooltipText); i++) {
+            used += snprintf(tooltipText + used, sizeof(tooltipText) - used, "- %s\n",
+                             SpellChecker_MisspelledText(&g_spellChecker->misspelled, i));
         }
         
         // Set title bar to indicate spell errors
@@ -139,47 +420,240 @@ void CALLBACK SpellCheckTimerProc(HWND hwnd, UINT uMsg, UINT_PTR idEvent, DWORD
         }
     }
     
-    // Trigger repaint
-    InvalidateRect(g_hwndInput, NULL, FALSE);
-    UpdateWindow(g_hwndInput);
+    // Repaint only words that appeared or went away
+    RefreshSquiggles(TRUE);
+}
+
+// Order squiggle rectangles the way text flows: by line, then left to right
+static int CompareSquiggles(const RECT *a, const RECT *b) {
+    if (a->top != b->top) return a->top < b->top ? -1 : 1;
+    if (a->left != b->left) return a->left < b->left ? -1 : 1;
+    if (a->right != b->right) return a->right < b->right ? -1 : 1;
+    return 0;
+}
+
+// Compute squiggle rectangles for the misspelled words in the visible part
+// of the edit control. Returns the count; *rects is grown as needed.
+static int BuildSquiggleRects(HWND hwnd, RECT **rects, int *capacity) {
+    MisspelledWordList *list = g_spellChecker ? &g_spellChecker->misspelled : NULL;
+    if (!list || list->count == 0) return 0;
     
-    free(text);
+    RECT client;
+    GetClientRect(hwnd, &client);
+    
+    HDC hdc = GetDC(hwnd);
+    if (!hdc) return 0;
+    HFONT font = (HFONT)SendMessage(hwnd, WM_GETFONT, 0, 0);
+    HGDIOBJ oldFont = SelectObject(hdc, font ? (HGDIOBJ)font : GetStockObject(SYSTEM_FONT));
+    TEXTMETRIC tm;
+    GetTextMetrics(hdc, &tm);
+    int lineHeight = tm.tmHeight > 0 ? tm.tmHeight : 16;
+    
+    // Character range covered by the visible lines
+    int firstLine = (int)SendMessage(hwnd, EM_GETFIRSTVISIBLELINE, 0, 0);
+    int visibleLines = (client.bottom - client.top) / lineHeight + 1;
+    DWORD firstChar = (DWORD)SendMessage(hwnd, EM_LINEINDEX, firstLine, 0);
+    LRESULT endIndex = SendMessage(hwnd, EM_LINEINDEX, firstLine + visibleLines + 1, 0);
+    DWORD lastChar = endIndex < 0 ? MAXDWORD : (DWORD)endIndex;
+    
+    // The list is in text order: skip words that end before the window
+    int lo = 0, hi = list->count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (list->words[mid].endPos <= firstChar) lo = mid + 1;
+        else hi = mid;
+    }
+    
+    // Words are placed line by line: each line with flagged words costs one
+    // EM_POSFROMCHAR for its origin and one EM_GETLINE for its text, and the
+    // words on it are measured from that text. The control expands tabs, so
+    // on a line holding one the words are still asked for one by one.
+    WCHAR *lineText = NULL;
+    int lineCapacity = 0;
+    DWORD lineStart = 0, lineEnd = 0;
+    int lineX = 0, lineY = 0;
+    BOOL lineShown = FALSE, lineHasTab = FALSE, haveLine = FALSE;
+    
+    int count = 0;
+    for (int i = lo; i < list->count && list->words[i].startPos < lastChar; i++) {
+        const MisspelledWord *mw = &list->words[i];
+        if (!haveLine || mw->startPos >= lineEnd) {
+            int line = (int)SendMessage(hwnd, EM_LINEFROMCHAR, mw->startPos, 0);
+            lineStart = (DWORD)SendMessage(hwnd, EM_LINEINDEX, line, 0);
+            int lineLen = (int)SendMessage(hwnd, EM_LINELENGTH, lineStart, 0);
+            lineEnd = lineStart + lineLen;
+            haveLine = TRUE;
+            lineShown = FALSE;
+            if (lineLen <= 0 || mw->startPos < lineStart) continue;
+            
+            LRESULT pos = SendMessage(hwnd, EM_POSFROMCHAR, lineStart, 0);
+            if (pos == -1) continue;
+            lineX = (short)LOWORD(pos);
+            lineY = (short)HIWORD(pos);
+            if (lineY >= client.bottom || lineY + lineHeight <= client.top) continue;
+            
+            // EM_GETLINE takes the buffer size in its first WORD
+            if (lineLen + 1 > lineCapacity) {
+                WCHAR *grown = (WCHAR *)realloc(lineText, (lineLen + 1) * sizeof(WCHAR));
+                if (!grown) break;
+                lineText = grown;
+                lineCapacity = lineLen + 1;
+            }
+            *(WORD *)lineText = (WORD)(lineLen < 0xFFFF ? lineLen : 0xFFFF);
+            int copied = (int)SendMessageW(hwnd, EM_GETLINE, line, (LPARAM)lineText);
+            if (copied < lineLen) continue;
+            lineHasTab = FALSE;
+            for (int c = 0; c < lineLen && !lineHasTab; c++) {
+                if (lineText[c] == L'\t') lineHasTab = TRUE;
+            }
+            lineShown = TRUE;
+        }
+        if (!lineShown) continue;
+        
+        // A word can't run past its line; soft wraps break between words
+        int column = (int)(mw->startPos - lineStart);
+        int wordLen = (int)((mw->endPos < lineEnd ? mw->endPos : lineEnd) - mw->startPos);
+        SIZE extent;
+        if (wordLen <= 0 || !GetTextExtentPoint32W(hdc, lineText + column, wordLen, &extent)) continue;
+        int x;
+        if (lineHasTab) {
+            LRESULT pos = SendMessage(hwnd, EM_POSFROMCHAR, mw->startPos, 0);
+            if (pos == -1) continue;
+            x = (short)LOWORD(pos);
+        } else {
+            SIZE prefix;
+            if (!GetTextExtentPoint32W(hdc, lineText, column, &prefix)) continue;
+            x = lineX + prefix.cx;
+        }
+        
+        if (count >= *capacity) {
+            int newCapacity = *capacity > 0 ? *capacity * 2 : 64;
+            RECT *grown = (RECT *)realloc(*rects, newCapacity * sizeof(RECT));
+            if (!grown) break;
+            *rects = grown;
+            *capacity = newCapacity;
+        }
+        // Squiggle band sits in the descender area under the word
+        SetRect(&(*rects)[count], x, lineY + lineHeight - 3, x + extent.cx, lineY + lineHeight);
+        count++;
+    }
+    
+    free(lineText);
+    SelectObject(hdc, oldFont);
+    ReleaseDC(hwnd, hdc);
+    return count;
+}
 
-cleanup:
-    // Kill timer after spell check
-    if (g_spellCheckTimer) {
-        KillTimer(NULL, g_spellCheckTimer);
-        g_spellCheckTimer = 0;
+// Recompute the on-screen squiggles from the current results. With
+// invalidateChanges, only rectangles present in exactly one of the old and
+// new sets are invalidated, so unchanged words are not repainted.
+void RefreshSquiggles(BOOL invalidateChanges) {
+    if (!g_hwndInput) return;
+    
+    static RECT *fresh = NULL;
+    static int freshCapacity = 0;
+    int freshCount = BuildSquiggleRects(g_hwndInput, &fresh, &freshCapacity);
+    
+    if (invalidateChanges) {
+        int i = 0, j = 0;
+        while (i < g_squiggleCount || j < freshCount) {
+            int cmp = i >= g_squiggleCount ? 1 : j >= freshCount ? -1 : CompareSquiggles(&g_squiggles[i], &fresh[j]);
+            if (cmp == 0) {
+                i++;
+                j++;
+            } else if (cmp < 0) {
+                InvalidateRect(g_hwndInput, &g_squiggles[i++], TRUE);
+            } else {
+                InvalidateRect(g_hwndInput, &fresh[j++], FALSE);
+            }
+        }
+    }
+    
+    // Swap buffers so neither is reallocated on the next pass
+    RECT *swapRects = g_squiggles;
+    int swapCapacity = g_squiggleCapacity;
+    g_squiggles = fresh;
+    g_squiggleCapacity = freshCapacity;
+    g_squiggleCount = freshCount;
+    fresh = swapRects;
+    freshCapacity = swapCapacity;
+    
+    RECT client;
+    GetClientRect(g_hwndInput, &client);
+    g_squiggleFirstLine = (int)SendMessage(g_hwndInput, EM_GETFIRSTVISIBLELINE, 0, 0);
+    g_squiggleClientWidth = client.right;
+}
+
+// Draw the red zigzag under each misspelled word that intersects damage
+void DrawMisspelledUnderlines(HWND hwnd, const RECT *damage) {
+    if (!g_spellCheckEnabled || IsRectEmpty(damage)) return;
+    
+    // Scrolling or re-wrapping moved the text; rebuild for the new layout
+    RECT client;
+    GetClientRect(hwnd, &client);
+    if ((int)SendMessage(hwnd, EM_GETFIRSTVISIBLELINE, 0, 0) != g_squiggleFirstLine ||
+        client.right != g_squiggleClientWidth) {
+        RefreshSquiggles(FALSE);
     }
+    if (g_squiggleCount == 0) return;
+    
+    HDC hdc = GetDC(hwnd);
+    if (!hdc) return;
+    IntersectClipRect(hdc, damage->left, damage->top, damage->right, damage->bottom);
+    HPEN pen = CreatePen(PS_SOLID, 1, RGB(255, 0, 0));
+    HGDIOBJ oldPen = SelectObject(hdc, pen);
+    
+    for (int i = 0; i < g_squiggleCount; i++) {
+        const RECT *r = &g_squiggles[i];
+        if (r->top >= damage->bottom) break;  // Sorted by line
+        RECT overlap;
+        if (!IntersectRect(&overlap, r, damage)) continue;
+        
+        // Two-pixel zigzag across the band
+        MoveToEx(hdc, r->left, r->bottom - 1, NULL);
+        for (int x = r->left; x < r->right; x += 2) {
+            LineTo(hdc, min(x + 2, (int)r->right), ((x - r->left) / 2) % 2 ? r->bottom - 1 : r->top);
+        }
+    }
+    
+    SelectObject(hdc, oldPen);
+    DeleteObject(pen);
+    ReleaseDC(hwnd, hdc);
 }
 
-// Replace a word in the text
+// Replace a word in the text; both words are UTF-8
 void ReplaceWord(const char *oldWord, const char *newWord) {
     if (!g_hwndInput || !oldWord || !newWord) return;
     
-    int textLen = GetWindowTextLength(g_hwndInput);
+    int textLen = GetWindowTextLengthW(g_hwndInput);
     if (textLen == 0) return;
     
-    char *text = (char *)malloc(textLen + 1);
+    WCHAR oldWide[256], newWide[256];
+    if (!MultiByteToWideChar(CP_UTF8, 0, oldWord, -1, oldWide, 256) ||
+        !MultiByteToWideChar(CP_UTF8, 0, newWord, -1, newWide, 256)) {
+        return;
+    }
+    
+    WCHAR *text = (WCHAR *)malloc((textLen + 1) * sizeof(WCHAR));
     if (!text) return;
     
-    GetWindowText(g_hwndInput, text, textLen + 1);
+    GetWindowTextW(g_hwndInput, text, textLen + 1);
     
     // Simple find and replace (replaces first occurrence)
-    char *pos = strstr(text, oldWord);
+    WCHAR *pos = wcsstr(text, oldWide);
     if (pos) {
-        int oldLen = strlen(oldWord);
-        int newLen = strlen(newWord);
+        int oldLen = (int)wcslen(oldWide);
+        int newLen = (int)wcslen(newWide);
         
         // Create new text with replacement
-        char *newText = (char *)malloc(textLen + newLen - oldLen + 1);
+        WCHAR *newText = (WCHAR *)malloc((textLen + newLen - oldLen + 1) * sizeof(WCHAR));
         if (newText) {
-            int offset = pos - text;
-            strncpy(newText, text, offset);
-            strcpy(newText + offset, newWord);
-            strcpy(newText + offset + newLen, text + offset + oldLen);
+            int offset = (int)(pos - text);
+            memcpy(newText, text, offset * sizeof(WCHAR));
+            wcscpy(newText + offset, newWide);
+            wcscpy(newText + offset + newLen, text + offset + oldLen);
             
-            SetWindowText(g_hwndInput, newText);
+            SetWindowTextW(g_hwndInput, newText);
             TriggerSpellCheck();
             
             free(newText);
@@ -190,58 +664,67 @@ void ReplaceWord(const char *oldWord, const char *newWord) {
 }
 
 // Handle right-click context menu for misspelled words
-BOOL HandleSpellCheckContextMenu(HWND hwnd, int xPos, int yPos) {
-    if (!g_spellChecker || g_spellChecker->misspelled.count == 0) return FALSE;
+// Exact character index under a client point. EM_CHARFROMPOS packs the
+// index and line into 16-bit halves, so both are widened against values
+// known to be close: the line against the first visible line, and the
+// index against the start of that line.
+static BOOL CharIndexFromPoint(HWND hwnd, POINT pt, DWORD *charIndex) {
+    LRESULT result = SendMessage(hwnd, EM_CHARFROMPOS, 0, MAKELPARAM(pt.x, pt.y));
+    if (result == -1) return FALSE;
     
-    // Get text to find word at position
-    int textLen = GetWindowTextLength(hwnd);
-    if (textLen == 0) return FALSE;
+    DWORD firstVisible = (DWORD)SendMessage(hwnd, EM_GETFIRSTVISIBLELINE, 0, 0);
+    DWORD line = firstVisible + (WORD)(HIWORD(result) - (WORD)firstVisible);
+    LRESULT lineStart = SendMessage(hwnd, EM_LINEINDEX, line, 0);
+    if (lineStart < 0) return FALSE;
     
-    char *text = (char *)malloc(textLen + 1);
-    if (!text) return FALSE;
-    
-    GetWindowText(hwnd, text, textLen + 1);
+    *charIndex = (DWORD)lineStart + (WORD)(LOWORD(result) - (WORD)lineStart);
+    return TRUE;
+}
+
+BOOL HandleSpellCheckContextMenu(HWND hwnd, int xPos, int yPos) {
+    if (!g_spellChecker || g_spellChecker->misspelled.count == 0) return FALSE;
     
-    // Get cursor position (approximate from click point)
+    // Resolve the click to a character index
     POINT pt = {xPos, yPos};
     ScreenToClient(hwnd, &pt);
+    DWORD charIndex;
+    if (!CharIndexFromPoint(hwnd, pt, &charIndex)) return FALSE;
     
-    // Find a misspelled word near the cursor
-    char misspelledWord[256] = {0};
-    int wordIndex = -1;
-    
-    for (int i = 0; i < g_spellChecker->misspelled.count; i++) {
-        if (pt.x >= g_spellChecker->misspelled.words[i].startPos * 6 && 
-            pt.x <= g_spellChecker->misspelled.words[i].endPos * 6) {
-            strcpy(misspelledWord, g_spellChecker->misspelled.words[i].word);
-            wordIndex = i;
-            break;
+    // Find the misspelled word under the cursor
+    MisspelledWordList *list = &g_spellChecker->misspelled;
+    int wordIndex = SpellChecker_FindMisspelledAt(list, charIndex);
+    if (wordIndex < 0 && charIndex > 0) {
+        // EM_CHARFROMPOS rounds to the nearest boundary; a click on the right
+        // half of a word's last letter reports the character after it
+        LRESULT pos = SendMessage(hwnd, EM_POSFROMCHAR, charIndex, 0);
+        if (pos == -1 || (short)LOWORD(pos) > pt.x) {
+            wordIndex = SpellChecker_FindMisspelledAt(list, charIndex - 1);
         }
     }
+    if (wordIndex < 0) return FALSE;
     
-    if (wordIndex < 0) {
-        free(text);
-        return FALSE;
-    }
+    // Copied, since the list can change while the menu is up
+    char misspelledWord[MAX_MISSPELLED_TEXT + 1];
+    snprintf(misspelledWord, sizeof(misspelledWord), "%s", SpellChecker_MisspelledText(list, wordIndex));
     
     // Create context menu
     HMENU hMenu = CreatePopupMenu();
-    if (!hMenu) {
-        free(text);
-        return FALSE;
-    }
+    if (!hMenu) return FALSE;
     
-    // Get suggestions
+    // Get suggestions (usually prefetched by the worker); kept until the
+    // menu closes so a pick needs no second search
     int suggestCount = 0;
     char **suggestions = SpellChecker_GetSuggestions(g_spellChecker, misspelledWord, &suggestCount);
     
     // Add suggestion options
     if (suggestions && suggestCount > 0) {
         for (int i = 0; i < suggestCount && i < 5; i++) {
-            AppendMenu(hMenu, MF_STRING, ID_CONTEXT_MENU_SUGGESTION_BASE + i, suggestions[i]);
+            WCHAR label[256];
+            if (MultiByteToWideChar(CP_UTF8, 0, suggestions[i], -1, label, 256)) {
+                AppendMenuW(hMenu, MF_STRING, ID_CONTEXT_MENU_SUGGESTION_BASE + i, label);
+            }
         }
         AppendMenu(hMenu, MF_SEPARATOR, 0, NULL);
-        SpellChecker_FreeSuggestions(suggestions, suggestCount);
     } else {
         AppendMenu(hMenu, MF_STRING | MF_GRAYED, 0, "No suggestions");
         AppendMenu(hMenu, MF_SEPARATOR, 0, NULL);
@@ -257,22 +740,22 @@ BOOL HandleSpellCheckContextMenu(HWND hwnd, int xPos, int yPos) {
     // Handle menu selection
     if (selection >= ID_CONTEXT_MENU_SUGGESTION_BASE && selection < ID_CONTEXT_MENU_SUGGESTION_BASE + 10) {
         // User selected a suggestion
-        char **sugg = SpellChecker_GetSuggestions(g_spellChecker, misspelledWord, &suggestCount);
-        if (sugg && selection - ID_CONTEXT_MENU_SUGGESTION_BASE < suggestCount) {
-            ReplaceWord(misspelledWord, sugg[selection - ID_CONTEXT_MENU_SUGGESTION_BASE]);
-            SpellChecker_FreeSuggestions(sugg, suggestCount);
+        if (suggestions && selection - ID_CONTEXT_MENU_SUGGESTION_BASE < suggestCount) {
+            ReplaceWord(misspelledWord, suggestions[selection - ID_CONTEXT_MENU_SUGGESTION_BASE]);
         }
     } else if (selection == ID_CONTEXT_MENU_ADD_DICT) {
         SpellChecker_AddToUserDictionary(g_spellChecker, misspelledWord);
+        g_spellCheckFullPass = TRUE;
         TriggerSpellCheck();
     } else if (selection == ID_CONTEXT_MENU_IGNORE) {
         // Add word to ignore list for this session
         SpellChecker_AddToIgnoreList(g_spellChecker, misspelledWord);
+        g_spellCheckFullPass = TRUE;
         TriggerSpellCheck();
     }
     
+    SpellChecker_FreeSuggestions(suggestions, suggestCount);
     DestroyMenu(hMenu);
-    free(text);
     return TRUE;
 }
 
@@ -280,6 +763,42 @@ BOOL HandleSpellCheckContextMenu(HWND hwnd, int xPos, int yPos) {
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) {
     const char CLASS_NAME[] = "WorkLogAggregatorClass";
 
+    // "--check <pattern>..." spell checks log files headlessly (batchcheck.h)
+    if (__argc >= 2 && strcmp(__argv[1], "--check") == 0) {
+        return BatchCheck_Run(__argc, __argv);
+    }
+    
+    // "--summary [week|month]" prints the log history's rollups (logrollup.h)
+    if (__argc >= 2 && strcmp(__argv[1], "--summary") == 0) {
+        return LogRollup_Run(__argc, __argv);
+    }
+    
+    // "--compile-dictionary [input.txt] [output.bin]" builds the mapped
+    // dictionary image and exits without creating a window
+    if (__argc >= 2 && strcmp(__argv[1], "--compile-dictionary") == 0) {
+        const char *input = __argc >= 3 ? __argv[2] : "dictionary.txt";
+        const char *output = __argc >= 4 ? __argv[3] : "dictionary.bin";
+        return SpellChecker_CompileDictionary(input, output) ? 0 : 1;
+    }
+    
+    // "--extract-archive <archive.lga> <output.txt>" restores the log an
+    // archive export holds
+    if (__argc >= 4 && strcmp(__argv[1], "--extract-archive") == 0) {
+        return LogArchive_Extract(__argv[2], __argv[3]) ? 0 : 1;
+    }
+    for (int i = 1; i < __argc; i++) {
+        if (strcmp(__argv[i], "--durable-log") == 0) g_durableLog = TRUE;
+        if (strcmp(__argv[i], "--perf-stats") == 0) g_perfStatsFile = TRUE;
+        if (strcmp(__argv[i], "--archive-exports") == 0) g_archiveExports = TRUE;
+        if (strcmp(__argv[i], "--dictionary") == 0 && i + 1 < __argc &&
+            g_teamDictionaryCount < SPELLCHECKER_MAX_LAYERS - 1) {
+            g_teamDictionaries[g_teamDictionaryCount++] = __argv[++i];
+        }
+    }
+
+    // Finish a View mode save a crash cut short before the log is read
+    RecoverLogSave();
+    
     // Initialize spell checker
     InitializeSpellChecker();
 
@@ -321,6 +840,8 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
     }
 
     CleanupSpellChecker();
+    // Timings from a slow machine can be sent back as this file
+    if (g_perfStatsFile) PerfStats_WriteFile("perfstats.txt");
     return 0;
 }
 
@@ -330,12 +851,29 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 
     switch (uMsg) {
     case WM_CREATE:
-        hwndInput = CreateWindowEx(
+        // Search box above the input; Enter runs the query (see SearchProc)
+        g_hwndSearch = CreateWindowEx(
             WS_EX_CLIENTEDGE,
             "EDIT",
             "",
+            WS_CHILD | WS_VISIBLE | WS_TABSTOP | ES_AUTOHSCROLL,
+            20, 20, 440, SEARCH_BOX_HEIGHT,
+            hwnd,
+            (HMENU)ID_SEARCH,
+            GetModuleHandle(NULL),
+            NULL
+        );
+        if (g_hwndSearch) {
+            g_oldSearchProc = (WNDPROC)SetWindowLongPtr(g_hwndSearch, GWLP_WNDPROC, (LONG_PTR)SearchProc);
+        }
+
+        // A Unicode control, so the spell checker reads it as UTF-16
+        hwndInput = CreateWindowExW(
+            WS_EX_CLIENTEDGE,
+            L"EDIT",
+            L"",
             WS_CHILD | WS_VISIBLE | ES_MULTILINE | ES_AUTOVSCROLL | WS_VSCROLL,
-            20, 20, 440, 250,
+            20, 20 + SEARCH_BOX_HEIGHT + 10, 440, 250 - SEARCH_BOX_HEIGHT - 10,
             hwnd,
             (HMENU)ID_INPUT,
             GetModuleHandle(NULL),
@@ -345,7 +883,25 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
         // Subclass the edit control so we can handle Ctrl+A (select all)
         if (hwndInput) {
             g_hwndInput = hwndInput;  // Store for spell checker
-            g_oldEditProc = (WNDPROC)SetWindowLongPtr(hwndInput, GWLP_WNDPROC, (LONG_PTR)EditProc);
+            g_oldEditProc = (WNDPROC)SetWindowLongPtrW(hwndInput, GWLP_WNDPROC, (LONG_PTR)EditProc);
+        }
+        
+        // Matches take the input box's place until the search is closed
+        g_hwndResults = CreateWindowEx(
+            WS_EX_CLIENTEDGE,
+            "LISTBOX",
+            "",
+            WS_CHILD | WS_VSCROLL | LBS_NOTIFY | LBS_NOINTEGRALHEIGHT,
+            20, 20 + SEARCH_BOX_HEIGHT + 10, 440, 250 - SEARCH_BOX_HEIGHT - 10,
+            hwnd,
+            (HMENU)ID_SEARCH_RESULTS,
+            GetModuleHandle(NULL),
+            NULL
+        );
+        
+        // Run spell checks off the UI thread; falls back to the timer if the thread can't start
+        if (g_spellChecker) {
+            g_spellWorker = SpellWorker_Start(g_spellChecker, hwnd, WM_APP_SPELLCHECK_DONE);
         }
 
         hwndAddBtn = CreateWindow(
@@ -380,68 +936,64 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
             GetModuleHandle(NULL),
             NULL
         );
+
+        // Status line for confirmations that shouldn't interrupt typing
+        g_hwndStatus = CreateWindow(
+            "STATIC",
+            "",
+            WS_VISIBLE | WS_CHILD | SS_LEFT | SS_CENTERIMAGE,
+            380, 290, 100, 30,
+            hwnd,
+            (HMENU)ID_STATUS,
+            GetModuleHandle(NULL),
+            NULL
+        );
+        
+        // Everything the loader reports to exists now
+        StartDictionaryLoad(hwnd);
         break;
 
     case WM_COMMAND:
         switch (LOWORD(wParam)) {
+        case ID_INPUT:
+            if (HIWORD(wParam) == EN_CHANGE) OnInputChanged();
+            break;
+        case ID_SEARCH_RESULTS:
+            if (HIWORD(wParam) == LBN_DBLCLK) OpenSearchResult(hwnd);
+            break;
         case ID_ADD:
             if (!isViewMode) {
                 AddLogEntry(hwndInput);
             }
             break;
         case ID_VIEW:
+            if (g_logExport) {
+                // Save could rewrite the file while it is being copied
+                SetWindowText(g_hwndStatus, "Export in progress...");
+                break;
+            }
             if (!isViewMode) {
                 // Backup whatever the user has typed in the main input so we can restore it
+                free(mainInputBackup);
+                mainInputBackup = NULL;
                 if (hwndInput) {
-                    GetWindowText(hwndInput, mainInputBackup, sizeof(mainInputBackup));
+                    int len = GetWindowTextLengthW(hwndInput);
+                    mainInputBackup = (WCHAR *)malloc((len + 1) * sizeof(WCHAR));
+                    if (mainInputBackup) GetWindowTextW(hwndInput, mainInputBackup, len + 1);
                 }
-                // Load content from file
-                FILE *file = fopen("WorkLog.txt", "r");
-                if (!file) {
-                    MessageBox(NULL, "No entries to view!", "Error", MB_OK | MB_ICONERROR);
-                    break;
-                }
-
-                // Read file content and normalize line endings to CRLF for the edit control
-                char raw[4096] = {0};
-                size_t bytesRead = fread(raw, 1, sizeof(raw) - 1, file);
-                fclose(file);
 
-                if (bytesRead == 0) {
+                // Open the log for paged viewing, including entries still buffered
+                RecoverLogSave();
+                OpenLogIndexes();
+                if (!LogPager_Open(&g_logPager, "WorkLog.txt") || !LogPager_HasPage(&g_logPager, 0)) {
+                    LogPager_Close(&g_logPager);
                     MessageBox(NULL, "No entries to view!", "Error", MB_OK | MB_ICONERROR);
                     break;
                 }
 
-                // Convert lone LF to CRLF so the Windows edit control shows new lines correctly.
-                // Use a larger buffer for converted content.
-                char converted[8192] = {0};
-                size_t ri = 0, wi = 0;
-                for (ri = 0; ri < bytesRead && wi + 2 < sizeof(converted); ++ri) {
-                    unsigned char c = raw[ri];
-                    if (c == '\r') {
-                        // keep CR as-is
-                        converted[wi++] = '\r';
-                        // If next is LF, it'll be handled in next iteration and appended
-                    } else if (c == '\n') {
-                        // If previous char wasn't CR, insert CR before LF
-                        if (ri == 0 || raw[ri - 1] != '\r') {
-                            converted[wi++] = '\r';
-                        }
-                        converted[wi++] = '\n';
-                    } else {
-                        converted[wi++] = c;
-                    }
-                }
-
-                // Ensure null-terminated
-                converted[wi] = '\0';
-
-                // Store original content (raw) for possible later comparison
-                strncpy(originalContent, converted, sizeof(originalContent) - 1);
-
-                // Show content in input box (this temporarily replaces what was in the main input)
-                SetWindowText(hwndInput, converted);
-
+                // Pages can exceed the edit control's default 32K typing limit
+                mainInputLimit = SendMessage(hwndInput, EM_GETLIMITTEXT, 0, 0);
+                SendMessage(hwndInput, EM_SETLIMITTEXT, 0, 0);
                 // Hide regular buttons and show Save/Cancel buttons
                 ShowWindow(hwndAddBtn, SW_HIDE);
                 ShowWindow(GetDlgItem(hwnd, ID_VIEW), SW_HIDE);
@@ -464,25 +1016,77 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
                     GetModuleHandle(NULL), NULL
                 );
 
+                hwndPrevPageBtn = CreateWindow(
+                    "BUTTON", "< Prev",
+                    WS_TABSTOP | WS_VISIBLE | WS_CHILD | BS_PUSHBUTTON,
+                    260, 290, 100, 30,
+                    hwnd, (HMENU)ID_PAGE_PREV,
+                    GetModuleHandle(NULL), NULL
+                );
+
+                hwndNextPageBtn = CreateWindow(
+                    "BUTTON", "Next >",
+                    WS_TABSTOP | WS_VISIBLE | WS_CHILD | BS_PUSHBUTTON,
+                    380, 290, 100, 30,
+                    hwnd, (HMENU)ID_PAGE_NEXT,
+                    GetModuleHandle(NULL), NULL
+                );
+
+                ShowSearchResults(FALSE);
+                EnableWindow(g_hwndSearch, FALSE);
                 isViewMode = TRUE;
+                ShowLogPage(0);
+                SendMessage(hwnd, WM_SIZE, 0, 0);
+            }
+            break;
+        case ID_PAGE_PREV:
+        case ID_PAGE_NEXT:
+            if (isViewMode) {
+                KeepLogPageEdits();
+                ShowLogPage(g_viewPage + (LOWORD(wParam) == ID_PAGE_NEXT ? 1 : -1));
+            }
+            break;
+        case ID_DIAGNOSTICS:
+            ToggleDiagnostics(hwnd);
+            break;
+        case ID_SUMMARY:
+            ToggleSummary(hwnd);
+            break;
+        case ID_DAY_PREV:
+        case ID_DAY_NEXT:
+            if (isViewMode) {
+                KeepLogPageEdits();
+                ShowLogDay(LOWORD(wParam) == ID_DAY_NEXT ? 1 : -1);
             }
             break;
         case ID_SAVE:
             if (isViewMode) {
-                // Get current content
-                char newContent[4096];
-                GetWindowText(hwndInput, newContent, sizeof(newContent));
-
-                // Save to file
-                FILE *file = fopen("WorkLog.txt", "w");
-                if (file) {
-                    fputs(newContent, file);
-                    fclose(file);
+                // Entries the writer couldn't write yet would be lost when
+                // it closes below
+                if (LogWriter_HasPending(&g_logWriter) && !LogWriter_Flush(&g_logWriter)) {
+                    MessageBox(hwnd, "Could not write the pending log entries. Nothing was saved; try again.",
+                               "Error", MB_OK | MB_ICONERROR);
+                    break;
+                }
+                // Write back only what changed on the edited pages. The log
+                // writer's handle would point at the replaced file, so it
+                // reopens on the next entry. An export or summary still
+                // reading the log must not see it patched under them, so
+                // meanwhile the save always writes a replacement file.
+                KeepLogPageEdits();
+                LogWriter_Close(&g_logWriter);
+                if (LogPager_Save(&g_logPager, !g_logExport && !g_summaryBuilder)) {
+                    // Offsets moved; entries keep their recorded dates
+                    if (g_logIndex.file && LogIndex_Rebuild(&g_logIndex) && g_searchIndex.slots) {
+                        SearchIndex_Rebuild(&g_searchIndex, &g_logIndex);
+                    }
                     MessageBox(NULL, "Changes saved successfully!", "Success", MB_OK | MB_ICONINFORMATION);
+                } else {
+                    MessageBox(NULL, "Could not save changes!", "Error", MB_OK | MB_ICONERROR);
                 }
 
                 // Restore the user's previous main input (preserve what they were typing)
-                SetWindowText(hwndInput, mainInputBackup);
+                SetWindowTextW(hwndInput, mainInputBackup ? mainInputBackup : L"");
                 
                 // Exit view mode
                 goto exit_view_mode;
@@ -491,29 +1095,123 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
         case ID_CANCEL:
             if (isViewMode) {
                 // Restore the user's previous main input (preserve what they were typing)
-                SetWindowText(hwndInput, mainInputBackup);
+                SetWindowTextW(hwndInput, mainInputBackup ? mainInputBackup : L"");
 exit_view_mode:
-                // Clean up view mode
+                // Clean up view mode; unsaved page edits are dropped
+                LogPager_Close(&g_logPager);
+                free(mainInputBackup);
+                mainInputBackup = NULL;
+                SendMessage(hwndInput, EM_SETLIMITTEXT, (WPARAM)mainInputLimit, 0);
                 DestroyWindow(hwndSaveBtn);
                 DestroyWindow(hwndCancelBtn);
-                hwndSaveBtn = hwndCancelBtn = NULL;
+                DestroyWindow(hwndPrevPageBtn);
+                DestroyWindow(hwndNextPageBtn);
+                hwndSaveBtn = hwndCancelBtn = hwndPrevPageBtn = hwndNextPageBtn = NULL;
 
                 // Show regular buttons
                 ShowWindow(hwndAddBtn, SW_SHOW);
                 ShowWindow(GetDlgItem(hwnd, ID_VIEW), SW_SHOW);
                 ShowWindow(hwndExportBtn, SW_SHOW);
 
+                EnableWindow(g_hwndSearch, TRUE);
                 isViewMode = FALSE;
             }
             break;
         case ID_EXPORT:
-            if (!isViewMode) {
-                ExportLog();
+            if (g_logExport) {
+                // The button doubles as Cancel while an export runs
+                LogExport_Cancel(g_logExport);
+            } else if (!isViewMode) {
+                LogWriter_Flush(&g_logWriter);
+                ExportLog(hwnd);
             }
             break;
         }
         break;
 
+    case WM_APP_EXPORT_PROGRESS:
+        {
+            char status[64];
+            snprintf(status, sizeof(status), "Exporting... %d%%", (int)wParam);
+            SetWindowText(g_hwndStatus, status);
+        }
+        break;
+
+    case WM_APP_EXPORT_DONE:
+        {
+            LogExport_Finish((LogExport *)lParam);
+            g_logExport = NULL;
+            SetWindowText(hwndExportBtn, "Export");
+
+            if (wParam == LOGEXPORT_SUCCEEDED && g_archiveExports) {
+                char status[128];
+                snprintf(status, sizeof(status), "Log archived to %s", g_exportFileName);
+                SetWindowText(g_hwndStatus, status);
+            } else if (wParam == LOGEXPORT_SUCCEEDED) {
+                // The export is a byte copy, so the index describes it too
+                char exportIndex[MAX_PATH];
+                LogIndex_PathFor(g_exportFileName, exportIndex, sizeof(exportIndex));
+                CopyFile(g_logIndex.path[0] ? g_logIndex.path : "WorkLog.idx", exportIndex, FALSE);
+
+                char status[128];
+                snprintf(status, sizeof(status), "Daily log exported to %s", g_exportFileName);
+                SetWindowText(g_hwndStatus, status);
+            } else if (wParam == LOGEXPORT_CANCELLED) {
+                SetWindowText(g_hwndStatus, "Export cancelled");
+            } else {
+                SetWindowText(g_hwndStatus, "");
+                MessageBox(NULL, "Could not create export file!", "Error", MB_OK | MB_ICONERROR);
+            }
+        }
+        break;
+
+    case WM_TIMER:
+        if (wParam == ID_LOG_FLUSH_TIMER) {
+            if (!LogWriter_FlushIfDue(&g_logWriter)) {
+                // The entries stay buffered and the timer keeps retrying;
+                // say so once per failure rather than on every tick
+                if (!g_logFlushFailed) {
+                    g_logFlushFailed = TRUE;
+                    SetWindowText(g_hwndStatus, "Could not write to WorkLog.txt; retrying...");
+                    MessageBox(hwnd, "Could not write to log file! Entries are kept and will be retried.",
+                               "Error", MB_OK | MB_ICONWARNING);
+                }
+            } else if (g_logFlushFailed && !LogWriter_HasPending(&g_logWriter)) {
+                g_logFlushFailed = FALSE;
+                SetWindowText(g_hwndStatus, "Pending entries written to WorkLog.txt");
+            }
+            if (!LogWriter_HasPending(&g_logWriter)) {
+                // With the entries on disk the search index matches the log
+                // file again; saving it now spares a rebuild after a crash
+                if (g_searchIndex.dirty) SearchIndex_Save(&g_searchIndex);
+                KillTimer(hwnd, ID_LOG_FLUSH_TIMER);
+                g_logFlushTimerArmed = FALSE;
+            }
+        }
+        break;
+
+    case WM_APP_DICTIONARY_LOADED:
+        OnDictionariesLoaded((BOOL)wParam);
+        break;
+    
+    case WM_APP_SUMMARY_DONE:
+        OnSummaryDone((char *)lParam);
+        break;
+    
+    case WM_APP_SPELLCHECK_DONE:
+        {
+            SpellCheckResult *result = (SpellCheckResult *)lParam;
+            // Only the newest snapshot's result describes what is on screen
+            if (result && result->generation == g_spellCheckGeneration && g_spellChecker) {
+                MisspelledWordList previous = g_spellChecker->misspelled;
+                g_spellChecker->misspelled = result->list;
+                result->list = previous;
+                UpdateSpellCheckDisplay();
+            }
+            SpellWorker_FreeResult(result);
+        }
+        break;
+
     case WM_ERASEBKGND:
         {
             RECT rect;
@@ -539,13 +1237,23 @@ exit_view_mode:
             // Calculate the height for the input box (leave space for buttons at bottom)
             int inputHeight = rcClient.bottom - (margin * 2 + buttonHeight);
             
-            // Resize the input box
-            MoveWindow(hwndInput,
+            // Search box on top, then the input box (or the matches in its place)
+            int searchBottom = margin + SEARCH_BOX_HEIGHT + 10;
+            MoveWindow(g_hwndSearch,
                 margin,                                    // x position
                 margin,                                    // y position
                 rcClient.right - (margin * 2),            // width
-                inputHeight - margin,                      // height
+                SEARCH_BOX_HEIGHT,                         // height
                 TRUE);
+            HWND inputArea[] = { hwndInput, g_hwndResults };
+            for (int i = 0; i < 2; i++) {
+                MoveWindow(inputArea[i],
+                    margin,                                    // x position
+                    searchBottom,                              // y position
+                    rcClient.right - (margin * 2),            // width
+                    max(inputHeight - searchBottom, 0),        // height
+                    TRUE);
+            }
             
             // Position the buttons at the bottom
             MoveWindow(hwndAddBtn,
@@ -570,10 +1278,49 @@ exit_view_mode:
                 buttonWidth,                               // width
                 buttonHeight,                              // height
                 TRUE);
+
+            // View mode buttons share the same row
+            HWND viewButtons[] = { hwndSaveBtn, hwndCancelBtn, hwndPrevPageBtn, hwndNextPageBtn };
+            for (int i = 0; i < 4; i++) {
+                if (viewButtons[i]) {
+                    MoveWindow(viewButtons[i],
+                        margin + (buttonWidth + buttonSpacing) * i, // x position
+                        rcClient.bottom - (margin + buttonHeight),  // y position
+                        buttonWidth,                                // width
+                        buttonHeight,                               // height
+                        TRUE);
+                }
+            }
+
+            // Status line takes the rest of the button row
+            int statusX = margin + (buttonWidth + buttonSpacing) * (isViewMode ? 4 : 3);
+            MoveWindow(g_hwndStatus,
+                statusX,                                    // x position
+                rcClient.bottom - (margin + buttonHeight),  // y position
+                max(rcClient.right - margin - statusX, 0),  // width
+                buttonHeight,                               // height
+                TRUE);
         }
         break;
 
     case WM_DESTROY:
+        if (g_logExport) {
+            LogExport_Cancel(g_logExport);
+            LogExport_Finish(g_logExport);
+            g_logExport = NULL;
+        }
+        if (g_summaryBuilder) {
+            // Its report can't be posted any more; the thread frees it
+            WaitForSingleObject(g_summaryBuilder, INFINITE);
+            CloseHandle(g_summaryBuilder);
+            g_summaryBuilder = NULL;
+        }
+        LogRollup_Close(&g_logRollup);
+        if (!LogWriter_Close(&g_logWriter)) {
+            MessageBox(hwnd, "Could not write the last log entries to WorkLog.txt!", "Error", MB_OK | MB_ICONERROR);
+        }
+        SearchIndex_Close(&g_searchIndex);
+        LogIndex_Close(&g_logIndex);
         PostQuitMessage(0);
         break;
 
@@ -585,87 +1332,271 @@ exit_view_mode:
 
 // Add an entry to today's log
 void AddLogEntry(HWND hwndInput) {
-    char text[1024];
-    GetWindowText(hwndInput, text, sizeof(text));
-
-    if (strlen(text) == 0) {
+    int textLen = GetWindowTextLength(hwndInput);
+    if (textLen == 0) {
         MessageBox(NULL, "Please enter a note before adding.", "No Entry", MB_OK | MB_ICONWARNING);
         return;
     }
-
-    // Open file for update so we can check last character
-    FILE *file = fopen("WorkLog.txt", "a+");
-    if (!file) {
-        MessageBox(NULL, "Could not open log file!", "Error", MB_OK | MB_ICONERROR);
+    // Sized from the text so a long note is never cut, which would also
+    // drop its line ending and glue the next entry onto it
+    char *text = (char *)malloc(textLen + 1);
+    char *entry = (char *)malloc(textLen + 32);
+    if (!text || !entry) {
+        free(text);
+        free(entry);
+        MessageBox(NULL, "Not enough memory to add the entry!", "Error", MB_OK | MB_ICONERROR);
         return;
     }
-
-    // Move to end and check if file is non-empty and doesn't end with a newline
-    int needSep = 0;
-    if (fseek(file, 0, SEEK_END) == 0) {
-        long pos = ftell(file);
-        if (pos > 0) {
-            // Go back one char to read last byte
-            if (fseek(file, -1, SEEK_END) == 0) {
-                int last = fgetc(file);
-                if (last != '\n' && last != '\r') {
-                    needSep = 1;
-                }
-            }
-        }
+    GetWindowText(hwndInput, text, textLen + 1);
+
+    // Keep the log open across entries; see logwriter.h. A View mode save
+    // left half applied has to be finished before anything is appended.
+    if (!g_logWriter.file &&
+        (!RecoverLogSave() ||
+         !LogWriter_Open(&g_logWriter, "WorkLog.txt", g_durableLog ? LOGWRITER_DURABLE : LOGWRITER_BUFFERED,
+                         LOG_BUFFER_SIZE, LOG_FLUSH_INTERVAL_MS))) {
+        MessageBox(NULL, "Could not open log file!", "Error", MB_OK | MB_ICONERROR);
+        free(text);
+        free(entry);
+        return;
     }
+    // Without an index the next open rebuilds one from the log, so a failure
+    // here costs only the exact dates
+    OpenLogIndexes();
 
     time_t now = time(NULL);
     struct tm *t = localtime(&now);
 
-    if (needSep) {
-        // write CRLF separator
-        fputc('\r', file);
-        fputc('\n', file);
-    }
-
     // Convert to 12-hour format with am/pm
     int hour12 = t->tm_hour % 12;
     if (hour12 == 0) hour12 = 12; // midnight or noon -> 12
     const char *ampm = (t->tm_hour >= 12) ? "pm" : "am";
-    // Write entry with CRLF line ending and am/pm
-    fprintf(file, "[%d:%02d%s] %s\r\n", hour12, t->tm_min, ampm, text);
-    fclose(file);
+    // Write entry with CRLF line ending and am/pm; the writer adds a separator
+    // first if the file doesn't already end with a newline
+    int len = snprintf(entry, textLen + 32, "[%d:%02d%s] %s\r\n", hour12, t->tm_min, ampm, text);
+    free(text);
+    LONGLONG start = PerfStats_Start();
+    if (len < 0 || !LogWriter_Append(&g_logWriter, entry, (DWORD)len)) {
+        MessageBox(NULL, "Could not write to log file!", "Error", MB_OK | MB_ICONERROR);
+        free(entry);
+        return;
+    }
+    DWORD stamp = LOGINDEX_STAMP(t->tm_year + 1900, t->tm_mon + 1, t->tm_mday, t->tm_hour * 60 + t->tm_min);
+    LONGLONG offset = LogWriter_GetSize(&g_logWriter) - len;
+    LogIndex_Append(&g_logIndex, stamp, offset, (DWORD)len);
+    SearchIndex_AddEntry(&g_searchIndex, offset, entry, (DWORD)len, LogWriter_GetSize(&g_logWriter));
+    PerfStats_Stop(PERF_LOG_APPEND, start);
+    free(entry);
+
+    // Buffered entries reach the disk within LOG_FLUSH_INTERVAL_MS, and the
+    // search index is saved once they have
+    if ((LogWriter_HasPending(&g_logWriter) || g_searchIndex.dirty) && !g_logFlushTimerArmed) {
+        g_logFlushTimerArmed = SetTimer(GetParent(hwndInput), ID_LOG_FLUSH_TIMER, LOG_FLUSH_INTERVAL_MS, NULL) != 0;
+    }
 
     SetWindowText(hwndInput, ""); // clear input box
-    MessageBox(NULL, "Entry added to WorkLog.txt!", "Success", MB_OK | MB_ICONINFORMATION);
+
+    char status[64];
+    snprintf(status, sizeof(status), "Entry added to WorkLog.txt at %d:%02d%s", hour12, t->tm_min, ampm);
+    SetWindowText(g_hwndStatus, status);
 }
 
-// Export the log (just copies to a daily file)
-void ExportLog() {
-    char buffer[1024];
-    FILE *src = fopen("WorkLog.txt", "r");
-    if (!src) {
-        MessageBox(NULL, "No log file found!", "Error", MB_OK | MB_ICONERROR);
+// Put page index of the log into the input box
+void ShowLogPage(int index) {
+    DWORD len = 0;
+    char *text = LogPager_LoadPage(&g_logPager, index, &len);
+    if (!text) return;
+
+    SetWindowText(g_hwndInput, text);
+    free(text);
+    g_viewPage = index;
+
+    EnableWindow(hwndPrevPageBtn, LogPager_HasPage(&g_logPager, index - 1));
+    EnableWindow(hwndNextPageBtn, LogPager_HasPage(&g_logPager, index + 1));
+
+    char status[96];
+    int used = snprintf(status, sizeof(status), "Page %d (%d%% of log)", index + 1,
+                        LogPager_PercentThrough(&g_logPager, index));
+    int at = LogIndex_FindOffset(&g_logIndex, LogPager_PageStart(&g_logPager, index));
+    if (at >= 0 && used > 0 && used < (int)sizeof(status)) {
+        DWORD stamp = g_logIndex.records[at].stamp;
+        snprintf(status + used, sizeof(status) - used, ", %04d-%02d-%02d", LOGINDEX_STAMP_YEAR(stamp),
+                 LOGINDEX_STAMP_MONTH(stamp), LOGINDEX_STAMP_DATE(stamp));
+    }
+    SetWindowText(g_hwndStatus, status);
+}
+
+// Jump View mode to the first page of the next day with entries, or back to
+// the start of the current day (the previous one if already there). Seeks
+// through the index instead of paging through everything in between.
+void ShowLogDay(int direction) {
+    int at = LogIndex_FindOffset(&g_logIndex, LogPager_PageStart(&g_logPager, g_viewPage));
+    if (at < 0) return;
+
+    DWORD stamp = g_logIndex.records[at].stamp;
+    int target;
+    if (direction > 0) {
+        target = LogIndex_LowerBound(&g_logIndex, LOGINDEX_STAMP_NEXT_DAY(stamp));
+    } else {
+        target = LogIndex_LowerBound(&g_logIndex, LOGINDEX_STAMP_DAY(stamp));
+        if (LogPager_FindPage(&g_logPager, g_logIndex.records[target].offset) == g_viewPage) {
+            if (target == 0) return;
+            target = LogIndex_LowerBound(&g_logIndex, LOGINDEX_STAMP_DAY(g_logIndex.records[target - 1].stamp));
+        }
+    }
+    if (target >= g_logIndex.count) {
+        SetWindowText(g_hwndStatus, "No later entries");
         return;
     }
 
-    time_t now = time(NULL);
-    struct tm *t = localtime(&now);
-    char filename[64];
-    sprintf(filename, "WorkLog_%04d-%02d-%02d.txt",
-            t->tm_year + 1900, t->tm_mon + 1, t->tm_mday);
+    int page = LogPager_FindPage(&g_logPager, g_logIndex.records[target].offset);
+    if (page >= 0) ShowLogPage(page);
+}
 
-    FILE *dest = fopen(filename, "w");
-    if (!dest) {
-        MessageBox(NULL, "Could not create export file!", "Error", MB_OK | MB_ICONERROR);
-        fclose(src);
+// Hand the page on screen to the pager if the user changed it
+void KeepLogPageEdits(void) {
+    if (!SendMessage(g_hwndInput, EM_GETMODIFY, 0, 0)) return;
+
+    int len = GetWindowTextLength(g_hwndInput);
+    char *text = (char *)malloc(len + 1);
+    if (!text) return;
+    len = GetWindowText(g_hwndInput, text, len + 1);
+    LogPager_SetPageText(&g_logPager, g_viewPage, text, (DWORD)len);
+    SendMessage(g_hwndInput, EM_SETMODIFY, FALSE, 0);
+}
+
+// Open the date and word indexes of WorkLog.txt if they aren't yet. Buffered
+// entries are written first so both indexes see the whole log.
+void OpenLogIndexes(void) {
+    if (g_logWriter.file) LogWriter_Flush(&g_logWriter);
+    if (!g_logIndex.file) LogIndex_Open(&g_logIndex, "WorkLog.txt");
+    if (g_logIndex.file && !g_searchIndex.slots) SearchIndex_Open(&g_searchIndex, "WorkLog.txt", &g_logIndex);
+}
+
+// Finish a View mode save left half applied by a crash or a failed write.
+// The log changed under the indexes, so they are rebuilt, and the user is
+// told since the save had been reported as failed (or not at all). FALSE
+// if the journal still could not be applied.
+BOOL RecoverLogSave(void) {
+    BOOL replayed = FALSE;
+    if (!LogPager_Recover("WorkLog.txt", &replayed)) return FALSE;
+    if (replayed) {
+        // Offsets moved; entries keep their recorded dates
+        OpenLogIndexes();
+        if (g_logIndex.file && LogIndex_Rebuild(&g_logIndex) && g_searchIndex.slots) {
+            SearchIndex_Rebuild(&g_searchIndex, &g_logIndex);
+        }
+        MessageBox(NULL, "An interrupted save of your log changes has been completed.", "Success",
+                   MB_OK | MB_ICONINFORMATION);
+    }
+    return TRUE;
+}
+
+// Swap the match list and the input box
+void ShowSearchResults(BOOL show) {
+    ShowWindow(g_hwndResults, show ? SW_SHOW : SW_HIDE);
+    ShowWindow(g_hwndInput, show ? SW_HIDE : SW_SHOW);
+}
+
+// List the entries matching the search box, newest first, as their date
+// and first line
+void RunSearch(void) {
+    char query[256];
+    GetWindowText(g_hwndSearch, query, sizeof(query));
+    SendMessage(g_hwndResults, LB_RESETCONTENT, 0, 0);
+    if (isViewMode || !query[0]) {
+        ShowSearchResults(FALSE);
         return;
     }
 
-    while (fgets(buffer, sizeof(buffer), src)) {
-        fputs(buffer, dest);
+    OpenLogIndexes();
+    DWORD *ids = NULL;
+    int count = SearchIndex_Query(&g_searchIndex, query, &ids);
+    if (count < 0) {
+        SetWindowText(g_hwndStatus, "Search failed");
+        return;
     }
 
-    fclose(src);
-    fclose(dest);
+    HANDLE log = CreateFile("WorkLog.txt", GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                            NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    for (int i = count - 1; i >= 0 && count - i <= SEARCH_MAX_RESULTS && log != INVALID_HANDLE_VALUE; i--) {
+        LONGLONG offset = SearchIndex_EntryOffset(&g_searchIndex, ids[i]);
+        char line[160];
+        int used = 0;
+        int at = LogIndex_FindOffset(&g_logIndex, offset);
+        if (at >= 0) {
+            DWORD stamp = g_logIndex.records[at].stamp;
+            used = snprintf(line, sizeof(line), "%04d-%02d-%02d  ", LOGINDEX_STAMP_YEAR(stamp),
+                            LOGINDEX_STAMP_MONTH(stamp), LOGINDEX_STAMP_DATE(stamp));
+        }
 
-    MessageBox(NULL, "Daily log exported!", "Export Complete", MB_OK | MB_ICONINFORMATION);
+        // Only the entry's first line is read
+        LARGE_INTEGER pos;
+        pos.QuadPart = offset;
+        DWORD got = 0;
+        if (!SetFilePointerEx(log, pos, NULL, FILE_BEGIN) ||
+            !ReadFile(log, line + used, (DWORD)(sizeof(line) - used - 1), &got, NULL)) {
+            got = 0;
+        }
+        line[used + got] = '\0';
+        line[used + strcspn(line + used, "\r\n")] = '\0';
+
+        LRESULT item = SendMessage(g_hwndResults, LB_ADDSTRING, 0, (LPARAM)line);
+        if (item >= 0) SendMessage(g_hwndResults, LB_SETITEMDATA, (WPARAM)item, (LPARAM)ids[i]);
+    }
+    if (log != INVALID_HANDLE_VALUE) CloseHandle(log);
+    free(ids);
+
+    char status[64];
+    if (count > SEARCH_MAX_RESULTS) {
+        snprintf(status, sizeof(status), "%d matches, newest %d shown", count, SEARCH_MAX_RESULTS);
+    } else {
+        snprintf(status, sizeof(status), "%d %s", count, count == 1 ? "match" : "matches");
+    }
+    SetWindowText(g_hwndStatus, status);
+    ShowSearchResults(count > 0);
+}
+
+// Open View mode on the page holding the chosen match
+void OpenSearchResult(HWND hwnd) {
+    LRESULT item = SendMessage(g_hwndResults, LB_GETCURSEL, 0, 0);
+    if (item == LB_ERR) return;
+    DWORD id = (DWORD)SendMessage(g_hwndResults, LB_GETITEMDATA, (WPARAM)item, 0);
+    LONGLONG offset = SearchIndex_EntryOffset(&g_searchIndex, id);
+
+    SendMessage(hwnd, WM_COMMAND, ID_VIEW, 0);
+    if (!isViewMode) return;
+    int page = LogPager_FindPage(&g_logPager, offset);
+    if (page > 0) ShowLogPage(page);
+}
+
+// Export the log: a copy to a daily file, or with --archive-exports the new
+// part appended to this month's compressed archive. Either runs in the
+// background and reports through WM_APP_EXPORT_PROGRESS / WM_APP_EXPORT_DONE.
+void ExportLog(HWND hwnd) {
+    if (GetFileAttributes("WorkLog.txt") == INVALID_FILE_ATTRIBUTES) {
+        MessageBox(NULL, "No log file found!", "Error", MB_OK | MB_ICONERROR);
+        return;
+    }
+
+    time_t now = time(NULL);
+    struct tm *t = localtime(&now);
+    if (g_archiveExports) {
+        sprintf(g_exportFileName, "WorkLog_%04d-%02d.lga", t->tm_year + 1900, t->tm_mon + 1);
+        g_logExport = LogExport_StartArchive("WorkLog.txt", g_exportFileName, hwnd,
+                                             WM_APP_EXPORT_PROGRESS, WM_APP_EXPORT_DONE);
+    } else {
+        sprintf(g_exportFileName, "WorkLog_%04d-%02d-%02d.txt",
+                t->tm_year + 1900, t->tm_mon + 1, t->tm_mday);
+        g_logExport = LogExport_Start("WorkLog.txt", g_exportFileName, hwnd, WM_APP_EXPORT_PROGRESS, WM_APP_EXPORT_DONE);
+    }
+    if (!g_logExport) {
+        MessageBox(NULL, "Could not create export file!", "Error", MB_OK | MB_ICONERROR);
+        return;
+    }
+
+    SetWindowText(GetDlgItem(hwnd, ID_EXPORT), "Cancel Export");
+    SetWindowText(g_hwndStatus, "Exporting...");
 }
 
 // Subclassed edit control procedure to support Ctrl+A for 'select all' and spell checking
@@ -678,10 +1609,47 @@ LRESULT CALLBACK EditProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
             SendMessage(hwnd, EM_SETSEL, 0, -1);
             return 0; // handled
         }
-        // Trigger spell check on any key press
-        TriggerSpellCheck();
+        // Ctrl+PgUp / Ctrl+PgDn step through days while viewing the log
+        if (isViewMode && (GetKeyState(VK_CONTROL) & 0x8000) && (wParam == VK_PRIOR || wParam == VK_NEXT)) {
+            SendMessage(GetParent(hwnd), WM_COMMAND, wParam == VK_NEXT ? ID_DAY_NEXT : ID_DAY_PREV, 0);
+            return 0;
+        }
+        // Ctrl+Shift+D shows the timing window
+        if ((GetKeyState(VK_CONTROL) & 0x8000) && (GetKeyState(VK_SHIFT) & 0x8000) && wParam == 'D') {
+            SendMessage(GetParent(hwnd), WM_COMMAND, ID_DIAGNOSTICS, 0);
+            return 0;
+        }
+        // Ctrl+Shift+S shows the weekly and monthly summaries
+        if ((GetKeyState(VK_CONTROL) & 0x8000) && (GetKeyState(VK_SHIFT) & 0x8000) && wParam == 'S') {
+            SendMessage(GetParent(hwnd), WM_COMMAND, ID_SUMMARY, 0);
+            return 0;
+        }
+        // Checks are driven by EN_CHANGE (see OnInputChanged), so keys that
+        // don't edit the text don't schedule one
         break;
     
+    case WM_CHAR:
+        // A space, punctuation or new line finishes the word before it
+        g_spellCheckWordEnded = (wParam >= ' ' || wParam == '\r' || wParam == '\t') &&
+                                !Tokenizer_IsLetterW((WCHAR)wParam);
+        break;
+    
+    case WM_PAINT:
+        {
+            // Let the edit control draw its text, then put squiggles back on
+            // the part that was repainted
+            RECT damage;
+            if (!GetUpdateRect(hwnd, &damage, FALSE)) SetRectEmpty(&damage);
+            LRESULT result = CallWindowProcW(g_oldEditProc, hwnd, uMsg, wParam, lParam);
+            DrawMisspelledUnderlines(hwnd, &damage);
+            return result;
+        }
+
+    case WM_SETTEXT:
+        // Replaced text invalidates every squiggle position until the next check
+        g_squiggleCount = 0;
+        break;
+
     case WM_RBUTTONUP:
         // Handle right-click for spell check suggestions
         {
@@ -695,7 +1663,7 @@ LRESULT CALLBACK EditProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
             if (!HandleSpellCheckContextMenu(hwnd, pt.x, pt.y)) {
                 // No misspelled word found, show default context menu
                 if (g_oldEditProc) {
-                    return CallWindowProc(g_oldEditProc, hwnd, uMsg, wParam, lParam);
+                    return CallWindowProcW(g_oldEditProc, hwnd, uMsg, wParam, lParam);
                 }
             }
             return 0;
@@ -704,7 +1672,241 @@ LRESULT CALLBACK EditProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
 
     // Forward other messages to the original window procedure
     if (g_oldEditProc) {
-        return CallWindowProc(g_oldEditProc, hwnd, uMsg, wParam, lParam);
+        return CallWindowProcW(g_oldEditProc, hwnd, uMsg, wParam, lParam);
+    }
+    return DefWindowProcW(hwnd, uMsg, wParam, lParam);
+}
+
+// Search box: Enter runs the query, Escape goes back to the input box
+LRESULT CALLBACK SearchProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
+    if (uMsg == WM_KEYDOWN && wParam == VK_RETURN) {
+        RunSearch();
+        return 0;
+    }
+    if (uMsg == WM_KEYDOWN && wParam == VK_ESCAPE) {
+        ShowSearchResults(FALSE);
+        return 0;
+    }
+    // Swallow the matching WM_CHAR so the edit control doesn't beep
+    if (uMsg == WM_CHAR && (wParam == '\r' || wParam == 0x1B)) return 0;
+    return CallWindowProc(g_oldSearchProc, hwnd, uMsg, wParam, lParam);
+}
+
+// Show or hide the timing window (created on first use). It refreshes
+// itself while visible.
+void ToggleDiagnostics(HWND owner) {
+    if (!g_hwndDiagnostics) {
+        WNDCLASS wc = {0};
+        wc.lpfnWndProc = DiagnosticsProc;
+        wc.hInstance = GetModuleHandle(NULL);
+        wc.lpszClassName = "WorkLogDiagnosticsClass";
+        wc.hbrBackground = (HBRUSH)(COLOR_WINDOW + 1);
+        RegisterClass(&wc);
+        
+        g_hwndDiagnostics = CreateWindowEx(
+            WS_EX_TOOLWINDOW,
+            "WorkLogDiagnosticsClass",
+            "Logger - Performance",
+            WS_OVERLAPPEDWINDOW,
+            CW_USEDEFAULT, CW_USEDEFAULT, 640, 260,
+            owner,
+            NULL,
+            GetModuleHandle(NULL),
+            NULL
+        );
+        if (!g_hwndDiagnostics) return;
+    }
+    
+    if (IsWindowVisible(g_hwndDiagnostics)) {
+        SendMessage(g_hwndDiagnostics, WM_CLOSE, 0, 0);
+        return;
+    }
+    RefreshDiagnostics();
+    SetTimer(g_hwndDiagnostics, ID_DIAGNOSTICS_TIMER, DIAGNOSTICS_REFRESH_MS, NULL);
+    ShowWindow(g_hwndDiagnostics, SW_SHOW);
+}
+
+// Put the current timings into the diagnostics window
+void RefreshDiagnostics(void) {
+    if (!g_hwndDiagnosticsText) return;
+    
+    SpellCheckerStats stats;
+    // The loader holds the checker's lock until it is done
+    SpellChecker_GetStats(g_dictionaryLoader ? NULL : g_spellChecker, &stats);
+    DWORD lookups = stats.verdictHits + stats.verdictMisses;
+    
+    char text[2048];
+    int used = snprintf(text, sizeof(text), "Last check: %lu ms    Verdict cache: %lu hits, %lu misses (%d%%)\r\n\r\n",
+                        (unsigned long)stats.lastCheckTime, (unsigned long)stats.verdictHits,
+                        (unsigned long)stats.verdictMisses,
+                        lookups > 0 ? (int)((ULONGLONG)stats.verdictHits * 100 / lookups) : 0);
+    if (used < 0 || used >= (int)sizeof(text)) used = 0;
+    PerfStats_Format(text + used, sizeof(text) - used);
+    SetWindowText(g_hwndDiagnosticsText, text);
+}
+
+// Diagnostics window: a read-only text box of PerfStats_Format output.
+// Closing only hides it.
+LRESULT CALLBACK DiagnosticsProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
+    switch (uMsg) {
+    case WM_CREATE:
+        g_hwndDiagnosticsText = CreateWindowEx(
+            0,
+            "EDIT",
+            "",
+            WS_CHILD | WS_VISIBLE | ES_MULTILINE | ES_READONLY | ES_AUTOVSCROLL | WS_VSCROLL,
+            0, 0, 0, 0,
+            hwnd,
+            NULL,
+            GetModuleHandle(NULL),
+            NULL
+        );
+        // Columns only line up in a fixed-pitch font
+        SendMessage(g_hwndDiagnosticsText, WM_SETFONT, (WPARAM)GetStockObject(ANSI_FIXED_FONT), FALSE);
+        return 0;
+    
+    case WM_SIZE:
+        MoveWindow(g_hwndDiagnosticsText, 0, 0, LOWORD(lParam), HIWORD(lParam), TRUE);
+        return 0;
+    
+    case WM_TIMER:
+        if (wParam == ID_DIAGNOSTICS_TIMER) RefreshDiagnostics();
+        return 0;
+    
+    case WM_CLOSE:
+        KillTimer(hwnd, ID_DIAGNOSTICS_TIMER);
+        ShowWindow(hwnd, SW_HIDE);
+        return 0;
+    
+    case WM_DESTROY:
+        g_hwndDiagnostics = NULL;
+        g_hwndDiagnosticsText = NULL;
+        return 0;
     }
     return DefWindowProc(hwnd, uMsg, wParam, lParam);
-}
\ No newline at end of file
+}
+
+// Show or hide the summary window (created on first use). Each time it is
+// shown the rollups are brought up to date on a background thread.
+void ToggleSummary(HWND owner) {
+    if (!g_hwndSummary) {
+        WNDCLASS wc = {0};
+        wc.lpfnWndProc = SummaryProc;
+        wc.hInstance = GetModuleHandle(NULL);
+        wc.lpszClassName = "WorkLogSummaryClass";
+        wc.hbrBackground = (HBRUSH)(COLOR_WINDOW + 1);
+        RegisterClass(&wc);
+        
+        g_hwndSummary = CreateWindowEx(
+            WS_EX_TOOLWINDOW,
+            "WorkLogSummaryClass",
+            "Logger - Summary",
+            WS_OVERLAPPEDWINDOW,
+            CW_USEDEFAULT, CW_USEDEFAULT, 720, 480,
+            owner,
+            NULL,
+            GetModuleHandle(NULL),
+            NULL
+        );
+        if (!g_hwndSummary) return;
+    }
+    
+    if (IsWindowVisible(g_hwndSummary)) {
+        SendMessage(g_hwndSummary, WM_CLOSE, 0, 0);
+        return;
+    }
+    ShowWindow(g_hwndSummary, SW_SHOW);
+    RefreshSummary(owner);
+}
+
+// Weekly then monthly report, refreshed from the files on disk. Runs on
+// g_summaryBuilder; the text is the caller's to free.
+static char* BuildSummary(void) {
+    if (!g_logRollup.cachePath[0]) LogRollup_Open(&g_logRollup, "WorkLog.rollup");
+    LogRollup_Refresh(&g_logRollup, "WorkLog.txt", 0);
+    
+    char *weekly = LogRollup_Report(&g_logRollup, LOGROLLUP_WEEK);
+    char *monthly = LogRollup_Report(&g_logRollup, LOGROLLUP_MONTH);
+    char *text = NULL;
+    if (weekly && monthly) {
+        size_t weeklyLen = strlen(weekly);
+        text = (char *)malloc(weeklyLen + strlen(monthly) + 1);
+        if (text) {
+            memcpy(text, weekly, weeklyLen);
+            strcpy(text + weeklyLen, monthly);
+        }
+    }
+    free(weekly);
+    free(monthly);
+    return text;
+}
+
+static DWORD WINAPI SummaryBuilderThread(LPVOID param) {
+    char *text = BuildSummary();
+    if (!PostMessage((HWND)param, WM_APP_SUMMARY_DONE, 0, (LPARAM)text)) free(text);
+    return 0;
+}
+
+// Start bringing the summary up to date; hwnd is told through
+// WM_APP_SUMMARY_DONE. A refresh already running is left to finish.
+void RefreshSummary(HWND hwnd) {
+    if (g_summaryBuilder) return;
+    
+    // Entries still in the writer's buffer would be missing from the file
+    if (g_logWriter.file) LogWriter_Flush(&g_logWriter);
+    if (g_hwndSummaryText) SetWindowText(g_hwndSummaryText, "Summarizing the log history...");
+    
+    g_summaryBuilder = CreateThread(NULL, 0, SummaryBuilderThread, hwnd, 0, NULL);
+    if (!g_summaryBuilder) {
+        OnSummaryDone(BuildSummary());
+    }
+}
+
+// A refresh finished (WM_APP_SUMMARY_DONE); takes ownership of text
+void OnSummaryDone(char *text) {
+    if (g_summaryBuilder) {
+        WaitForSingleObject(g_summaryBuilder, INFINITE);
+        CloseHandle(g_summaryBuilder);
+        g_summaryBuilder = NULL;
+    }
+    if (g_hwndSummaryText) {
+        SetWindowText(g_hwndSummaryText, text ? text : "Could not build the summary (out of memory).");
+    }
+    free(text);
+}
+
+// Summary window: a read-only text box of LogRollup_Report output.
+// Closing only hides it.
+LRESULT CALLBACK SummaryProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
+    switch (uMsg) {
+    case WM_CREATE:
+        g_hwndSummaryText = CreateWindowEx(
+            0,
+            "EDIT",
+            "",
+            WS_CHILD | WS_VISIBLE | ES_MULTILINE | ES_READONLY | ES_AUTOVSCROLL | WS_VSCROLL,
+            0, 0, 0, 0,
+            hwnd,
+            NULL,
+            GetModuleHandle(NULL),
+            NULL
+        );
+        // Columns only line up in a fixed-pitch font
+        SendMessage(g_hwndSummaryText, WM_SETFONT, (WPARAM)GetStockObject(ANSI_FIXED_FONT), FALSE);
+        return 0;
+    
+    case WM_SIZE:
+        MoveWindow(g_hwndSummaryText, 0, 0, LOWORD(lParam), HIWORD(lParam), TRUE);
+        return 0;
+    
+    case WM_CLOSE:
+        ShowWindow(hwnd, SW_HIDE);
+        return 0;
+    
+    case WM_DESTROY:
+        g_hwndSummary = NULL;
+        g_hwndSummaryText = NULL;
+        return 0;
+    }
+    return DefWindowProc(hwnd, uMsg, wParam, lParam);
+}
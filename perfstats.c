@@ -0,0 +1,153 @@
+#include "perfstats.h"
+#include <stdio.h>
+#include <string.h>
+
+static PerfHistogram g_histograms[PERF_METRIC_COUNT];
+static LONGLONG g_frequency = 0;  // QPC ticks per second; every thread computes the same value
+
+static const char *g_metricNames[PERF_METRIC_COUNT] = {
+    "dictionary load",
+    "check",
+    "check range",
+    "suggest",
+    "log append",
+    "log flush",
+    "log export",
+    "log save"
+};
+
+LONGLONG PerfStats_Start(void) {
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return now.QuadPart;
+}
+
+static LONGLONG ElapsedMicros(LONGLONG start) {
+    if (g_frequency == 0) {
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        g_frequency = frequency.QuadPart;
+    }
+    LONGLONG ticks = PerfStats_Start() - start;
+    if (ticks < 0) return 0;
+    return ticks / g_frequency * 1000000 + ticks % g_frequency * 1000000 / g_frequency;
+}
+
+void PerfStats_Stop(PerfMetric metric, LONGLONG start) {
+    LONGLONG micros = ElapsedMicros(start);
+    PerfStats_Record(metric, micros > MAXDWORD ? MAXDWORD : (DWORD)micros);
+}
+
+DWORD PerfStats_ElapsedMs(LONGLONG start) {
+    return (DWORD)(ElapsedMicros(start) / 1000);
+}
+
+static int BucketFor(DWORD micros) {
+    if (micros < PERF_SUB_BUCKETS) return (int)micros;
+    int octave = 31;
+    while (!(micros & (1u << octave))) octave--;
+    return (octave - 1) * PERF_SUB_BUCKETS + (int)((micros >> (octave - 2)) & (PERF_SUB_BUCKETS - 1));
+}
+
+// Smallest value that lands in bucket, and the width of its range
+static double BucketLow(int bucket, double *width) {
+    if (bucket < PERF_SUB_BUCKETS) {
+        *width = 1;
+        return bucket;
+    }
+    int octave = bucket / PERF_SUB_BUCKETS + 1;
+    double step = (double)(1u << (octave - 2));
+    *width = step;
+    return (PERF_SUB_BUCKETS + bucket % PERF_SUB_BUCKETS) * step;
+}
+
+void PerfStats_Record(PerfMetric metric, DWORD micros) {
+    if ((unsigned)metric >= PERF_METRIC_COUNT) return;
+    PerfHistogram *h = &g_histograms[metric];
+    
+    InterlockedIncrement(&h->buckets[BucketFor(micros)]);
+    InterlockedExchangeAdd64(&h->totalMicros, (LONGLONG)micros);
+    
+    LONG seen = h->maxMicros;
+    LONG value = micros > 0x7FFFFFFF ? 0x7FFFFFFF : (LONG)micros;
+    while (value > seen) {
+        LONG previous = InterlockedCompareExchange(&h->maxMicros, value, seen);
+        if (previous == seen) break;
+        seen = previous;
+    }
+}
+
+// Value below which fraction of the samples fall, interpolated within
+// its bucket
+static double Percentile(const LONG *buckets, DWORD count, double fraction) {
+    double rank = fraction * count;
+    double below = 0;
+    for (int i = 0; i < PERF_BUCKETS; i++) {
+        if (buckets[i] == 0) continue;
+        if (below + buckets[i] >= rank) {
+            double width;
+            double low = BucketLow(i, &width);
+            return low + width * (rank - below) / buckets[i];
+        }
+        below += buckets[i];
+    }
+    return 0;
+}
+
+void PerfStats_Summarize(PerfMetric metric, PerfSummary *summary) {
+    if (!summary) return;
+    memset(summary, 0, sizeof(PerfSummary));
+    if ((unsigned)metric >= PERF_METRIC_COUNT) return;
+    
+    // Copy first: recorders keep going while this runs, so totals can be a
+    // few samples apart, which is fine for a readout
+    const PerfHistogram *h = &g_histograms[metric];
+    LONG buckets[PERF_BUCKETS];
+    DWORD count = 0;
+    for (int i = 0; i < PERF_BUCKETS; i++) {
+        buckets[i] = h->buckets[i];
+        count += (DWORD)buckets[i];
+    }
+    if (count == 0) return;
+    
+    // Interpolating in the top bucket can overshoot the largest sample
+    double maxMicros = h->maxMicros;
+    summary->count = count;
+    summary->meanMs = (double)h->totalMicros / count / 1000.0;
+    summary->p50Ms = min(Percentile(buckets, count, 0.50), maxMicros) / 1000.0;
+    summary->p90Ms = min(Percentile(buckets, count, 0.90), maxMicros) / 1000.0;
+    summary->p99Ms = min(Percentile(buckets, count, 0.99), maxMicros) / 1000.0;
+    summary->maxMs = maxMicros / 1000.0;
+}
+
+const char* PerfStats_MetricName(PerfMetric metric) {
+    return (unsigned)metric < PERF_METRIC_COUNT ? g_metricNames[metric] : "";
+}
+
+int PerfStats_Format(char *out, size_t size) {
+    if (!out || size == 0) return 0;
+    
+    // CRLF so the text shows as-is in an edit control
+    int used = snprintf(out, size, "%-16s %8s %10s %10s %10s %10s %10s\r\n",
+                        "metric", "count", "mean ms", "p50 ms", "p90 ms", "p99 ms", "max ms");
+    for (int m = 0; m < PERF_METRIC_COUNT && used >= 0 && (size_t)used < size; m++) {
+        PerfSummary s;
+        PerfStats_Summarize((PerfMetric)m, &s);
+        if (s.count == 0) continue;
+        used += snprintf(out + used, size - used, "%-16s %8lu %10.2f %10.2f %10.2f %10.2f %10.2f\r\n",
+                         g_metricNames[m], (unsigned long)s.count, s.meanMs, s.p50Ms, s.p90Ms, s.p99Ms, s.maxMs);
+    }
+    if (used < 0) used = 0;
+    return (size_t)used < size ? used : (int)size - 1;
+}
+
+BOOL PerfStats_WriteFile(const char *path) {
+    if (!path) return FALSE;
+    
+    char text[2048];
+    int len = PerfStats_Format(text, sizeof(text));
+    FILE *file = fopen(path, "wb");
+    if (!file) return FALSE;
+    BOOL ok = fwrite(text, 1, len, file) == (size_t)len;
+    return fclose(file) == 0 && ok;
+}
@@ -0,0 +1,61 @@
+#ifndef PERFSTATS_H
+#define PERFSTATS_H
+
+#include <windows.h>
+
+// Process-wide latency histograms for the hot paths, cheap enough to leave
+// on in release builds. Any thread may record; readers take a snapshot.
+typedef enum {
+    PERF_DICTIONARY_LOAD,    // SpellChecker_Load*Dictionary
+    PERF_CHECK,              // One full check pass (sequential or parallel)
+    PERF_CHECK_RANGE,        // One incremental re-check of an edited span
+    PERF_SUGGEST,            // Computing suggestions for a word (cache misses)
+    PERF_LOG_APPEND,         // AddLogEntry's write and index updates
+    PERF_LOG_FLUSH,          // Writing buffered entries out
+    PERF_LOG_EXPORT,         // The export copy, start to finish
+    PERF_LOG_SAVE,           // Writing View mode edits back to the log
+    PERF_METRIC_COUNT
+} PerfMetric;
+
+// Buckets are in microseconds: exact below 4, then four per power of two,
+// so a percentile read from them is within 25% of the true value
+#define PERF_SUB_BUCKETS 4
+#define PERF_BUCKETS 124
+
+typedef struct {
+    volatile LONG buckets[PERF_BUCKETS];
+    volatile LONG maxMicros;
+    volatile LONGLONG totalMicros;
+} PerfHistogram;
+
+typedef struct {
+    DWORD count;
+    double meanMs;
+    double p50Ms;
+    double p90Ms;
+    double p99Ms;
+    double maxMs;
+} PerfSummary;
+
+// Timestamp to pass to PerfStats_Stop
+LONGLONG PerfStats_Start(void);
+
+// Record the time since start (from PerfStats_Start) under metric
+void PerfStats_Stop(PerfMetric metric, LONGLONG start);
+
+void PerfStats_Record(PerfMetric metric, DWORD micros);
+
+// Milliseconds since start, for callers that also keep the last value
+DWORD PerfStats_ElapsedMs(LONGLONG start);
+
+void PerfStats_Summarize(PerfMetric metric, PerfSummary *summary);
+const char* PerfStats_MetricName(PerfMetric metric);
+
+// Table of every metric with samples: count, mean, p50/p90/p99 and max.
+// Returns the length written (truncated to fit size).
+int PerfStats_Format(char *out, size_t size);
+
+// PerfStats_Format to a file, replacing it
+BOOL PerfStats_WriteFile(const char *path);
+
+#endif // PERFSTATS_H
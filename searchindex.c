@@ -0,0 +1,567 @@
+#include "searchindex.h"
+#include "tokenizer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SEARCHINDEX_MIN_SLOTS 1024
+#define SEARCHINDEX_SPAN_BATCH 64
+
+static DWORD HashTerm(const char *term, size_t len) {
+    DWORD hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)term[i];
+        hash *= 16777619u;
+    }
+    return hash ? hash : 1;
+}
+
+static void LowerWord(const char *word, size_t len, char *out) {
+    for (size_t i = 0; i < len; i++) {
+        out[i] = (char)(word[i] | 0x20);  // Tokenizer words are ASCII letters
+    }
+    out[len] = '\0';
+}
+
+// Slot holding term, or the empty slot where it would go
+static int *FindSlot(const SearchIndex *index, const char *term, size_t len, DWORD hash) {
+    DWORD mask = index->slotCapacity - 1;
+    DWORD i = hash & mask;
+    while (index->slots[i] != 0) {
+        const SearchTerm *t = &index->terms[index->slots[i] - 1];
+        if (t->hash == hash && strncmp(t->term, term, len) == 0 && t->term[len] == '\0') break;
+        i = (i + 1) & mask;
+    }
+    return &index->slots[i];
+}
+
+static BOOL ResizeSlots(SearchIndex *index, DWORD capacity) {
+    int *slots = (int *)calloc(capacity, sizeof(int));
+    if (!slots) return FALSE;
+    
+    DWORD mask = capacity - 1;
+    for (int t = 0; t < index->termCount; t++) {
+        DWORD i = index->terms[t].hash & mask;
+        while (slots[i] != 0) i = (i + 1) & mask;
+        slots[i] = t + 1;
+    }
+    free(index->slots);
+    index->slots = slots;
+    index->slotCapacity = capacity;
+    return TRUE;
+}
+
+// Term index for a lowercased word, added if new; -1 on allocation failure
+static int InternTerm(SearchIndex *index, const char *term, size_t len) {
+    DWORD hash = HashTerm(term, len);
+    int *slot = FindSlot(index, term, len, hash);
+    if (*slot != 0) return *slot - 1;
+    
+    // Keep the load factor under 70% like WordTable
+    if ((DWORD)(index->termCount + 1) * 10 > index->slotCapacity * 7) {
+        if (!ResizeSlots(index, index->slotCapacity * 2)) return -1;
+        slot = FindSlot(index, term, len, hash);
+    }
+    if (index->termCount >= index->termCapacity) {
+        int newCapacity = index->termCapacity > 0 ? index->termCapacity * 2 : 1024;
+        SearchTerm *grown = (SearchTerm *)realloc(index->terms, newCapacity * sizeof(SearchTerm));
+        if (!grown) return -1;
+        index->terms = grown;
+        index->termCapacity = newCapacity;
+    }
+    
+    char *copy = StringArena_Alloc(&index->arena, len + 1);
+    if (!copy) return -1;
+    memcpy(copy, term, len);
+    copy[len] = '\0';
+    
+    SearchTerm *t = &index->terms[index->termCount];
+    memset(t, 0, sizeof(SearchTerm));
+    t->term = copy;
+    t->hash = hash;
+    *slot = ++index->termCount;
+    return index->termCount - 1;
+}
+
+static BOOL AppendPosting(SearchTerm *t, DWORD id) {
+    if (t->count > 0 && t->lastId == id) return TRUE;  // Word repeated within the entry
+    
+    if (t->postingBytes + 5 > t->postingCapacity) {
+        DWORD newCapacity = t->postingCapacity > 0 ? t->postingCapacity * 2 : 8;
+        BYTE *grown = (BYTE *)realloc(t->postings, newCapacity);
+        if (!grown) return FALSE;
+        t->postings = grown;
+        t->postingCapacity = newCapacity;
+    }
+    
+    // Gaps start from -1 so id 0 still encodes as a positive gap
+    DWORD gap = t->count > 0 ? id - t->lastId : id + 1;
+    while (gap >= 0x80) {
+        t->postings[t->postingBytes++] = (BYTE)(gap | 0x80);
+        gap >>= 7;
+    }
+    t->postings[t->postingBytes++] = (BYTE)gap;
+    t->lastId = id;
+    t->count++;
+    return TRUE;
+}
+
+static BOOL IndexText(SearchIndex *index, DWORD id, const char *text, DWORD len) {
+    TokenSpan spans[SEARCHINDEX_SPAN_BATCH];
+    char term[SEARCHINDEX_TERM_MAX + 1];
+    DWORD pos = 0;
+    while (pos < len) {
+        DWORD scanned = 0;
+        int count = Tokenizer_FindWords(text + pos, len - pos, spans, SEARCHINDEX_SPAN_BATCH, &scanned);
+        for (int i = 0; i < count; i++) {
+            if (spans[i].length > SEARCHINDEX_TERM_MAX) continue;
+            LowerWord(text + pos + spans[i].start, spans[i].length, term);
+            int t = InternTerm(index, term, spans[i].length);
+            if (t < 0 || !AppendPosting(&index->terms[t], id)) return FALSE;
+        }
+        if (scanned == 0) break;
+        pos += scanned;
+    }
+    return TRUE;
+}
+
+static BOOL AddEntryOffset(SearchIndex *index, LONGLONG offset) {
+    if (index->entryCount >= index->entryCapacity) {
+        DWORD newCapacity = index->entryCapacity > 0 ? index->entryCapacity * 2 : 1024;
+        LONGLONG *grown = (LONGLONG *)realloc(index->entries, newCapacity * sizeof(LONGLONG));
+        if (!grown) return FALSE;
+        index->entries = grown;
+        index->entryCapacity = newCapacity;
+    }
+    index->entries[index->entryCount++] = offset;
+    return TRUE;
+}
+
+BOOL SearchIndex_AddEntry(SearchIndex *index, LONGLONG offset, const char *text, DWORD len, LONGLONG logSize) {
+    if (!index || !index->slots || !text) return FALSE;
+    
+    DWORD id = index->entryCount;
+    if (!AddEntryOffset(index, offset)) return FALSE;
+    index->logSize = logSize;
+    index->dirty = TRUE;
+    return IndexText(index, id, text, len);
+}
+
+// Drop every term and entry, keeping the paths
+static void Reset(SearchIndex *index) {
+    for (int i = 0; i < index->termCount; i++) {
+        free(index->terms[i].postings);
+    }
+    free(index->terms);
+    free(index->slots);
+    free(index->sorted);
+    free(index->entries);
+    StringArena_Free(&index->arena);
+    
+    index->terms = NULL;
+    index->termCount = index->termCapacity = 0;
+    index->sorted = NULL;
+    index->sortedCount = 0;
+    index->entries = NULL;
+    index->entryCount = index->entryCapacity = 0;
+    index->logSize = 0;
+    index->slots = (int *)calloc(SEARCHINDEX_MIN_SLOTS, sizeof(int));
+    index->slotCapacity = index->slots ? SEARCHINDEX_MIN_SLOTS : 0;
+}
+
+static int CompareRecordOffsets(const void *a, const void *b) {
+    LONGLONG oa = ((const LogIndexRecord *)a)->offset;
+    LONGLONG ob = ((const LogIndexRecord *)b)->offset;
+    return oa < ob ? -1 : (oa > ob ? 1 : 0);
+}
+
+BOOL SearchIndex_Rebuild(SearchIndex *index, const LogIndex *entries) {
+    if (!index || !entries) return FALSE;
+    Reset(index);
+    if (!index->slots) return FALSE;
+    
+    HANDLE log = CreateFile(index->logPath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                            NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    LARGE_INTEGER size;
+    size.QuadPart = 0;
+    if (log != INVALID_HANDLE_VALUE && !GetFileSizeEx(log, &size)) size.QuadPart = 0;
+    
+    HANDLE mapping = NULL;
+    const char *text = NULL;
+    LogIndexRecord *records = NULL;
+    BOOL ok = TRUE;
+    if (size.QuadPart > 0 && entries->count > 0) {
+        mapping = CreateFileMapping(log, NULL, PAGE_READONLY, 0, 0, NULL);
+        text = mapping ? (const char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+        records = (LogIndexRecord *)malloc(entries->count * sizeof(LogIndexRecord));
+        ok = text && records;
+    }
+    
+    // Ids follow file order, which the log index only keeps by stamp
+    if (ok && text) {
+        memcpy(records, entries->records, entries->count * sizeof(LogIndexRecord));
+        qsort(records, entries->count, sizeof(LogIndexRecord), CompareRecordOffsets);
+        for (int i = 0; i < entries->count && ok; i++) {
+            const LogIndexRecord *r = &records[i];
+            if (r->offset + r->length > size.QuadPart) continue;
+            ok = SearchIndex_AddEntry(index, r->offset, text + r->offset, r->length, size.QuadPart);
+        }
+    }
+    index->logSize = size.QuadPart;
+    
+    free(records);
+    if (text) UnmapViewOfFile(text);
+    if (mapping) CloseHandle(mapping);
+    if (log != INVALID_HANDLE_VALUE) CloseHandle(log);
+    index->dirty = TRUE;
+    return ok && SearchIndex_Save(index);
+}
+
+static BYTE *Put(BYTE *p, const void *data, size_t len) {
+    if (len > 0) memcpy(p, data, len);
+    return p + len;
+}
+
+BOOL SearchIndex_Save(SearchIndex *index) {
+    if (!index || !index->slots) return FALSE;
+    
+    // Serialize into one block so the file is written in a single call
+    size_t size = sizeof(SearchIndexHeader) + index->entryCount * sizeof(LONGLONG);
+    for (int i = 0; i < index->termCount; i++) {
+        size += sizeof(WORD) + 3 * sizeof(DWORD) + strlen(index->terms[i].term) + index->terms[i].postingBytes;
+    }
+    if (size > MAXDWORD) return FALSE;
+    BYTE *block = (BYTE *)malloc(size);
+    if (!block) return FALSE;
+    
+    SearchIndexHeader header = { SEARCHINDEX_MAGIC, SEARCHINDEX_VERSION, index->entryCount,
+                                 (DWORD)index->termCount, index->logSize };
+    BYTE *p = Put(block, &header, sizeof(header));
+    p = Put(p, index->entries, index->entryCount * sizeof(LONGLONG));
+    for (int i = 0; i < index->termCount; i++) {
+        const SearchTerm *t = &index->terms[i];
+        WORD length = (WORD)strlen(t->term);
+        p = Put(p, &length, sizeof(length));
+        p = Put(p, &t->count, sizeof(DWORD));
+        p = Put(p, &t->lastId, sizeof(DWORD));
+        p = Put(p, &t->postingBytes, sizeof(DWORD));
+        p = Put(p, t->term, length);
+        p = Put(p, t->postings, t->postingBytes);
+    }
+    
+    char tempPath[MAX_PATH + 4];
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", index->path);
+    HANDLE temp = CreateFile(tempPath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    DWORD written = 0;
+    BOOL ok = temp != INVALID_HANDLE_VALUE && WriteFile(temp, block, (DWORD)size, &written, NULL) &&
+              written == size;
+    if (temp != INVALID_HANDLE_VALUE) CloseHandle(temp);
+    free(block);
+    
+    if (!ok || !MoveFileEx(tempPath, index->path, MOVEFILE_REPLACE_EXISTING)) {
+        DeleteFile(tempPath);
+        return FALSE;
+    }
+    index->dirty = FALSE;
+    return TRUE;
+}
+
+// A loaded posting list must decode to exactly count ascending ids below
+// entryCount, ending at lastId, within its bytes; queries decode it unchecked
+static BOOL ValidPostings(const SearchTerm *t, DWORD entryCount) {
+    DWORD id = (DWORD)-1;
+    DWORD pos = 0;
+    for (DWORD n = 0; n < t->count; n++) {
+        DWORD gap = 0;
+        int shift = 0;
+        BYTE b;
+        do {
+            if (pos >= t->postingBytes || shift > 28) return FALSE;
+            b = t->postings[pos++];
+            gap |= (DWORD)(b & 0x7F) << shift;
+            shift += 7;
+        } while (b & 0x80);
+        if (gap == 0 || gap > entryCount - 1 - id) return FALSE;
+        id += gap;
+    }
+    return pos == t->postingBytes && (t->count == 0 || id == t->lastId);
+}
+
+// Read the saved index; FALSE if it is missing or unusable
+static BOOL Load(SearchIndex *index) {
+    HANDLE file = CreateFile(index->path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return FALSE;
+    
+    LARGE_INTEGER size;
+    BYTE *block = NULL;
+    DWORD got = 0;
+    BOOL ok = GetFileSizeEx(file, &size) && size.QuadPart >= (LONGLONG)sizeof(SearchIndexHeader) &&
+              size.QuadPart < 0x40000000 && (block = (BYTE *)malloc((size_t)size.QuadPart)) != NULL &&
+              ReadFile(file, block, (DWORD)size.QuadPart, &got, NULL) && got == size.QuadPart;
+    CloseHandle(file);
+    
+    const BYTE *p = block;
+    const BYTE *end = block + (ok ? size.QuadPart : 0);
+    SearchIndexHeader header;
+    if (ok) {
+        memcpy(&header, p, sizeof(header));
+        p += sizeof(header);
+        ok = header.magic == SEARCHINDEX_MAGIC && header.version == SEARCHINDEX_VERSION &&
+             (size_t)(end - p) / sizeof(LONGLONG) >= header.entryCount;
+    }
+    for (DWORD i = 0; ok && i < header.entryCount; i++) {
+        LONGLONG offset;
+        memcpy(&offset, p, sizeof(offset));
+        p += sizeof(offset);
+        ok = AddEntryOffset(index, offset);
+    }
+    
+    for (DWORD i = 0; ok && i < header.termCount; i++) {
+        WORD length;
+        DWORD fields[3];  // count, lastId, postingBytes
+        ok = end - p >= (ptrdiff_t)(sizeof(length) + sizeof(fields));
+        if (!ok) break;
+        memcpy(&length, p, sizeof(length));
+        memcpy(fields, p + sizeof(length), sizeof(fields));
+        p += sizeof(length) + sizeof(fields);
+    
+        ok = length > 0 && length <= SEARCHINDEX_TERM_MAX && (size_t)(end - p) >= length + (size_t)fields[2];
+        int before = index->termCount;
+        int t = ok ? InternTerm(index, (const char *)p, length) : -1;
+        ok = t >= 0 && t == before;  // Each term once
+        if (!ok) break;
+    
+        SearchTerm *term = &index->terms[t];
+        term->postings = (BYTE *)malloc(fields[2] > 0 ? fields[2] : 1);
+        ok = term->postings != NULL;
+        if (!ok) break;
+        memcpy(term->postings, p + length, fields[2]);
+        term->count = fields[0];
+        term->lastId = fields[1];
+        term->postingBytes = term->postingCapacity = fields[2];
+        ok = ValidPostings(term, header.entryCount);
+        p += length + fields[2];
+    }
+    
+    if (ok) index->logSize = header.logSize;
+    free(block);
+    return ok;
+}
+
+BOOL SearchIndex_Open(SearchIndex *index, const char *logPath, const LogIndex *entries) {
+    if (!index || !logPath || !entries) return FALSE;
+    memset(index, 0, sizeof(SearchIndex));
+    snprintf(index->logPath, sizeof(index->logPath), "%s", logPath);
+    
+    // Same base name as the date index, with its own extension
+    LogIndex_PathFor(logPath, index->path, sizeof(index->path) - 1);
+    strcpy(index->path + strlen(index->path) - 3, "fts");
+    
+    Reset(index);
+    if (!index->slots) return FALSE;
+    
+    // Usable only if it covers the whole log as the date index sees it
+    LARGE_INTEGER size;
+    size.QuadPart = 0;
+    HANDLE log = CreateFile(logPath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                            NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (log != INVALID_HANDLE_VALUE) {
+        if (!GetFileSizeEx(log, &size)) size.QuadPart = 0;
+        CloseHandle(log);
+    }
+    if (Load(index) && index->logSize == size.QuadPart && index->entryCount == (DWORD)entries->count) {
+        return TRUE;
+    }
+    
+    // A rebuild that only failed to save is still usable this session
+    if (!SearchIndex_Rebuild(index, entries) && index->entryCount < (DWORD)entries->count) {
+        SearchIndex_Close(index);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+void SearchIndex_Close(SearchIndex *index) {
+    if (!index) return;
+    if (index->dirty) SearchIndex_Save(index);
+    for (int i = 0; i < index->termCount; i++) {
+        free(index->terms[i].postings);
+    }
+    free(index->terms);
+    free(index->slots);
+    free(index->sorted);
+    free(index->entries);
+    StringArena_Free(&index->arena);
+    memset(index, 0, sizeof(SearchIndex));
+}
+
+LONGLONG SearchIndex_EntryOffset(const SearchIndex *index, DWORD id) {
+    return index && id < index->entryCount ? index->entries[id] : -1;
+}
+
+static int CompareTermPointers(const void *a, const void *b) {
+    return strcmp((*(const SearchTerm * const *)a)->term, (*(const SearchTerm * const *)b)->term);
+}
+
+// Bring the sorted view up to date with terms added since it was built
+static BOOL EnsureSorted(SearchIndex *index) {
+    if (index->sorted && index->sortedCount == index->termCount) return TRUE;
+    
+    const SearchTerm **order = (const SearchTerm **)malloc((index->termCount + 1) * sizeof(SearchTerm *));
+    int *sorted = (int *)realloc(index->sorted, (index->termCount + 1) * sizeof(int));
+    if (!order || !sorted) {
+        free(order);
+        if (sorted) index->sorted = sorted;
+        return FALSE;
+    }
+    for (int i = 0; i < index->termCount; i++) {
+        order[i] = &index->terms[i];
+    }
+    qsort(order, index->termCount, sizeof(SearchTerm *), CompareTermPointers);
+    for (int i = 0; i < index->termCount; i++) {
+        sorted[i] = (int)(order[i] - index->terms);
+    }
+    free(order);
+    
+    index->sorted = sorted;
+    index->sortedCount = index->termCount;
+    return TRUE;
+}
+
+// Decode a posting list into ascending ids; out holds t->count
+static void DecodePostings(const SearchTerm *t, DWORD *out) {
+    DWORD id = (DWORD)-1;
+    DWORD pos = 0;
+    for (DWORD n = 0; n < t->count; n++) {
+        DWORD gap = 0;
+        int shift = 0;
+        BYTE b;
+        do {
+            b = t->postings[pos++];
+            gap |= (DWORD)(b & 0x7F) << shift;
+            shift += 7;
+        } while (b & 0x80);
+        id += gap;
+        out[n] = id;
+    }
+}
+
+// Ids of entries with a word starting with prefix, merged through a bitmap
+static DWORD *MatchPrefix(SearchIndex *index, const char *prefix, size_t len, int *count) {
+    *count = 0;
+    if (!EnsureSorted(index)) return NULL;
+    
+    // First term >= prefix in the sorted view
+    int lo = 0, hi = index->sortedCount;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (strcmp(index->terms[index->sorted[mid]].term, prefix) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    
+    BYTE *seen = (BYTE *)calloc(index->entryCount + 1, 1);
+    DWORD *scratch = NULL;
+    DWORD scratchSize = 0;
+    if (!seen) return NULL;
+    for (int i = lo; i < index->sortedCount; i++) {
+        const SearchTerm *t = &index->terms[index->sorted[i]];
+        if (strncmp(t->term, prefix, len) != 0) break;
+        if (t->count > scratchSize) {
+            DWORD *grown = (DWORD *)realloc(scratch, t->count * sizeof(DWORD));
+            if (!grown) {
+                free(scratch);
+                free(seen);
+                return NULL;
+            }
+            scratch = grown;
+            scratchSize = t->count;
+        }
+        DecodePostings(t, scratch);
+        for (DWORD n = 0; n < t->count; n++) {
+            if (scratch[n] < index->entryCount) seen[scratch[n]] = 1;
+        }
+    }
+    free(scratch);
+    
+    DWORD *ids = (DWORD *)malloc((index->entryCount + 1) * sizeof(DWORD));
+    if (ids) {
+        for (DWORD id = 0; id < index->entryCount; id++) {
+            if (seen[id]) ids[(*count)++] = id;
+        }
+    }
+    free(seen);
+    return ids;
+}
+
+static DWORD *MatchTerm(SearchIndex *index, const char *term, size_t len, int *count) {
+    *count = 0;
+    int *slot = FindSlot(index, term, len, HashTerm(term, len));
+    if (*slot == 0) return (DWORD *)malloc(sizeof(DWORD));  // No match, but not a failure
+    
+    const SearchTerm *t = &index->terms[*slot - 1];
+    DWORD *ids = (DWORD *)malloc((t->count + 1) * sizeof(DWORD));
+    if (!ids) return NULL;
+    DecodePostings(t, ids);
+    *count = (int)t->count;
+    return ids;
+}
+
+// Keep the ids of a that are also in b; both ascending
+static int Intersect(DWORD *a, int countA, const DWORD *b, int countB) {
+    int i = 0, j = 0, out = 0;
+    while (i < countA && j < countB) {
+        if (a[i] < b[j]) i++;
+        else if (a[i] > b[j]) j++;
+        else {
+            a[out++] = a[i];
+            i++;
+            j++;
+        }
+    }
+    return out;
+}
+
+int SearchIndex_Query(SearchIndex *index, const char *query, DWORD **ids) {
+    *ids = NULL;
+    if (!index || !index->slots || !query) return -1;
+    
+    TokenSpan spans[SEARCHINDEX_SPAN_BATCH];
+    DWORD scanned = 0;
+    DWORD queryLen = (DWORD)strlen(query);
+    int words = Tokenizer_FindWords(query, queryLen, spans, SEARCHINDEX_SPAN_BATCH, &scanned);
+    
+    DWORD *result = NULL;
+    int resultCount = 0;
+    for (int i = 0; i < words; i++) {
+        const TokenSpan *span = &spans[i];
+        BOOL prefix = span->start + span->length < queryLen && query[span->start + span->length] == '*';
+    
+        int count = 0;
+        DWORD *matches;
+        if (span->length > SEARCHINDEX_TERM_MAX) {
+            matches = (DWORD *)malloc(sizeof(DWORD));  // Never indexed
+        } else {
+            char term[SEARCHINDEX_TERM_MAX + 1];
+            LowerWord(query + span->start, span->length, term);
+            matches = prefix ? MatchPrefix(index, term, span->length, &count)
+                             : MatchTerm(index, term, span->length, &count);
+        }
+        if (!matches) {
+            free(result);
+            return -1;
+        }
+    
+        if (i == 0) {
+            result = matches;
+            resultCount = count;
+        } else {
+            resultCount = Intersect(result, resultCount, matches, count);
+            free(matches);
+        }
+        if (resultCount == 0) break;
+    }
+    
+    *ids = result ? result : (DWORD *)malloc(sizeof(DWORD));
+    return *ids ? resultCount : -1;
+}
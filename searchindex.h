@@ -0,0 +1,86 @@
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <windows.h>
+#include "logindex.h"
+#include "stringarena.h"
+
+// Full-text index over the entries of a log, saved next to it
+// (WorkLog.txt -> WorkLog.fts). Exports are copies of the log, so indexing
+// it covers the whole archive. Layout, all little-endian:
+//
+//   SearchIndexHeader
+//   LONGLONG offsets[entryCount]   log offset of each entry id
+//   per term: WORD length, DWORD count, DWORD lastId, DWORD postingBytes,
+//             char term[length], BYTE postings[postingBytes]
+//
+// Entry ids number the entries in file order. A posting list stores the
+// ids containing a term as varint gaps (LEB128, 7 bits per byte), so most
+// postings take a single byte.
+#define SEARCHINDEX_MAGIC   0x53544657u  // "WFTS"
+#define SEARCHINDEX_VERSION 1
+#define SEARCHINDEX_TERM_MAX 32          // Longer words are not indexed
+
+typedef struct {
+    DWORD magic;
+    DWORD version;
+    DWORD entryCount;
+    DWORD termCount;
+    LONGLONG logSize;        // Bytes of the log the index covers
+} SearchIndexHeader;
+
+typedef struct {
+    const char *term;        // Lowercased, in the index's arena
+    DWORD hash;
+    BYTE *postings;
+    DWORD postingBytes;
+    DWORD postingCapacity;
+    DWORD count;             // Entries containing the term
+    DWORD lastId;            // Newest id in postings, for the next gap
+} SearchTerm;
+
+// Terms are found by hash for updates and through a sorted view, rebuilt
+// when terms were added, for prefix queries. Not thread-safe; the UI
+// thread owns it.
+typedef struct {
+    char path[MAX_PATH];
+    char logPath[MAX_PATH];
+    SearchTerm *terms;
+    int termCount;
+    int termCapacity;
+    int *slots;              // Open addressing: term index + 1, 0 = empty
+    DWORD slotCapacity;      // Power of two
+    int *sorted;             // Term indexes in term order
+    int sortedCount;         // Terms covered by sorted; stale if < termCount
+    LONGLONG *entries;       // Log offset of each entry id
+    DWORD entryCount;
+    DWORD entryCapacity;
+    LONGLONG logSize;
+    BOOL dirty;              // Changed since the last save
+    StringArena arena;
+} SearchIndex;
+
+// Load the index saved for logPath, rebuilding it from the log when it is
+// missing or doesn't cover the whole log. entries gives the entry bounds.
+BOOL SearchIndex_Open(SearchIndex *index, const char *logPath, const LogIndex *entries);
+
+// Save if changed and release everything
+void SearchIndex_Close(SearchIndex *index);
+
+// Index one entry just appended at offset; logSize is the log's length
+// after it
+BOOL SearchIndex_AddEntry(SearchIndex *index, LONGLONG offset, const char *text, DWORD len, LONGLONG logSize);
+
+// Re-index every entry, e.g. after the log was rewritten
+BOOL SearchIndex_Rebuild(SearchIndex *index, const LogIndex *entries);
+
+BOOL SearchIndex_Save(SearchIndex *index);
+
+// Entries matching every word of query; a word ending in '*' matches
+// words starting with it. Sets *ids to a malloc'd ascending array (caller
+// frees) and returns its length, or -1 on allocation failure.
+int SearchIndex_Query(SearchIndex *index, const char *query, DWORD **ids);
+
+LONGLONG SearchIndex_EntryOffset(const SearchIndex *index, DWORD id);
+
+#endif // SEARCHINDEX_H
@@ -1,4 +1,6 @@
 #include "spellchecker.h"
+#include "tokenizer.h"
+#include "editdistance.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -6,89 +8,252 @@
 
 #define INITIAL_DICT_CAPACITY 10000
 #define INITIAL_MISSPELLED_CAPACITY 100
+#define INITIAL_WORDTABLE_CAPACITY 16384
+#define USER_JOURNAL_COMPACT_LIMIT 64  // Appended lines before the file is rewritten
+#define SUGGESTION_MAX_DISTANCE 2
+#define SUGGESTION_MAX_RESULTS 5
+#define CHECK_SPAN_BATCH 256           // Word spans tokenized per pass in CheckSpan
+#define SUGGESTION_SCAN_BATCH 256      // Candidates scored per EditDistance_Batch call
+#define PARALLEL_MIN_CHUNK (256 * 1024) // Below two chunks' worth a check stays on one thread
+#define PARALLEL_CHUNKS_PER_THREAD 4   // Spare chunks let fast threads pick up slack
+#define INITIAL_MISSPELLED_POOL 4096
+#define INITIAL_MISSPELLED_SLOTS 256
 
-// Case-insensitive comparator for qsort
-// Used for sorting both main and user dictionaries
+// Dictionary entries live in each Dictionary's arena as "key\0Original\0":
+// words[] points at the lowercased key used for sorting and lookups, and the
+// original spelling (shown in suggestions and saved to disk) follows it.
+// Words are UTF-8; keys fold letters outside ASCII too (Tokenizer_FoldUtf8),
+// which never changes their length.
+static const char *OriginalForm(const char *key) {
+    return key + strlen(key) + 1;
+}
+
+// Keys are already lowercase, so sorting is a plain byte comparison
 static int DictionaryComparator(const void *a, const void *b) {
     const char *s1 = *(const char * const *)a;
     const char *s2 = *(const char * const *)b;
-    
-    while (*s1 && *s2) {
-        int c1 = tolower((unsigned char)*s1);
-        int c2 = tolower((unsigned char)*s2);
-        if (c1 != c2) return c1 - c2;
-        s1++;
-        s2++;
+    return strcmp(s1, s2);
+}
+
+// Compare a lowercased key against len bytes of a word of any case
+static int CompareKeyToWord(const char *key, const char *word, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        int c2 = tolower((unsigned char)word[i]);
+        if ((unsigned char)key[i] != c2) return (unsigned char)key[i] - c2;
+    }
+    return key[len] != '\0';
+}
+
+// Binary search for dictionary lookup; word is a view of len bytes
+static BOOL BinarySearchDictionary(Dictionary *dict, const char *word, size_t len) {
+    int left = 0, right = dict->count - 1;
+    while (left <= right) {
+        int mid = left + (right - left) / 2;
+        int cmp = CompareKeyToWord(dict->words[mid], word, len);
+        if (cmp == 0) return TRUE;
+        if (cmp < 0) left = mid + 1;
+        else right = mid - 1;
+    }
+    return FALSE;
+}
+
+// Make room for at least 'needed' entries in dict->words
+static BOOL ReserveWords(Dictionary *dict, int needed) {
+    if (needed <= dict->capacity) return TRUE;
+    
+    int newCapacity = dict->capacity > 0 ? dict->capacity : 16;
+    while (newCapacity < needed) newCapacity *= 2;
+    char **newWords = (char **)realloc(dict->words, newCapacity * sizeof(char *));
+    if (!newWords) return FALSE;
+    dict->words = newWords;
+    dict->capacity = newCapacity;
+    return TRUE;
+}
+
+// Copy a word into the dictionary's arena as key + original
+static char *StoreWord(Dictionary *dict, const char *word, size_t len) {
+    char *key = StringArena_Alloc(&dict->arena, 2 * len + 2);
+    if (!key) return NULL;
+    Tokenizer_FoldUtf8(word, (DWORD)len, key);
+    key[len] = '\0';
+    memcpy(key + len + 1, word, len);
+    key[2 * len + 1] = '\0';
+    return key;
+}
+
+// Register a freshly stored entry with the lookup structures (caller holds sc->lock)
+static BOOL IndexWord(SpellChecker *sc, char *key, DWORD tag) {
+    if (sc->backend == DICTIONARY_BACKEND_HASH && !WordTable_Add(&sc->wordTable, key, tag)) {
+        return FALSE;
+    }
+    // Index for suggestions; ignored words are never offered
+    if (tag != DICT_TAG_IGNORED) {
+        BKTree_Insert(&sc->suggestionIndex, key);
     }
-    return tolower((unsigned char)*s1) - tolower((unsigned char)*s2);
+    return TRUE;
 }
 
-// Levenshtein distance calculation
-static int LevenshteinDistance(const char *s1, const char *s2) {
-    int len1 = strlen(s1);
-    int len2 = strlen(s2);
+// Load a one-word-per-line file into dict (caller holds sc->lock). If
+// canonical is given it reports whether the file was already sorted with no
+// duplicate keys, i.e. exactly what a rewrite would produce.
+// The whole file is read with one fread into the tail of a single arena
+// block of 2 * size + 2 bytes, and entries are rewritten in place from the
+// front of that block. Every line of n bytes consumes n + 1 input bytes and
+// emits at most 2n + 2, so the write cursor never overtakes unread input.
+static BOOL LoadWordFile(SpellChecker *sc, Dictionary *dict, const char *filePath, BOOL skipComments, DWORD tag,
+                         BOOL *canonical) {
+    if (canonical) *canonical = TRUE;
+    
+    FILE *file = fopen(filePath, "rb");
+    if (!file) return FALSE;
+    
+    long fileSize = -1;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        fileSize = ftell(file);
+        fseek(file, 0, SEEK_SET);
+    }
+    if (fileSize <= 0) {
+        fclose(file);
+        return fileSize == 0;
+    }
     
-    if (len1 == 0) return len2;
-    if (len2 == 0) return len1;
+    size_t size = (size_t)fileSize;
+    size_t blockSize = 2 * size + 2;
+    char *block = StringArena_AllocBlock(&dict->arena, blockSize);
+    if (!block) {
+        fclose(file);
+        return FALSE;
+    }
     
-    int *d = (int *)malloc((len2 + 1) * sizeof(int));
-    if (!d) return -1;
+    char *in = block + blockSize - size;
+    size_t bytesRead = fread(in, 1, size, file);
+    fclose(file);
+    if (bytesRead != size) return FALSE;
     
-    for (int i = 0; i <= len2; i++) {
-        d[i] = i;
+    // Size the word array once up front
+    int lines = 1;
+    for (const char *nl = in; (nl = (const char *)memchr(nl, '\n', in + size - nl)) != NULL; nl++) {
+        lines++;
     }
-    
-    for (int i = 1; i <= len1; i++) {
-        int prev_diag = i - 1;
-        d[0] = i;
+    if (!ReserveWords(dict, dict->count + lines)) return FALSE;
+    
+    char *out = block;
+    const char *p = in;
+    const char *end = in + size;
+    while (p < end) {
+        const char *nl = (const char *)memchr(p, '\n', end - p);
+        const char *lineEnd = nl ? nl : end;
+        const char *next = nl ? nl + 1 : end;
         
-        for (int j = 1; j <= len2; j++) {
-            int cost = (s1[i - 1] == s2[j - 1]) ? 0 : 1;
-            int temp = d[j];
-            d[j] = (d[j] + 1 < d[j - 1] + 1) ? (d[j] + 1) : (d[j - 1] + 1);
-            d[j] = (d[j] < prev_diag + cost) ? d[j] : (prev_diag + cost);
-            prev_diag = temp;
+        // Remove trailing whitespace
+        size_t len = lineEnd - p;
+        while (len > 0 && isspace((unsigned char)p[len - 1])) {
+            len--;
+        }
+        
+        // Skip empty lines and (for the main dictionary) comments
+        if (len > 0 && !(skipComments && p[0] == '#')) {
+            char *key = out;
+            Tokenizer_FoldUtf8(p, (DWORD)len, key);
+            key[len] = '\0';
+            memmove(key + len + 1, p, len);
+            key[2 * len + 1] = '\0';
+            out += 2 * len + 2;
+            
+            dict->words[dict->count++] = key;
+            if (!IndexWord(sc, key, tag)) return FALSE;
         }
+        p = next;
     }
     
-    int result = d[len2];
-    free(d);
-    return result;
+    // Sort for binary search, unless the file was written sorted
+    BOOL sorted = TRUE;
+    for (int i = 1; i < dict->count && sorted; i++) {
+        sorted = strcmp(dict->words[i - 1], dict->words[i]) < 0;
+    }
+    if (!sorted) {
+        qsort(dict->words, dict->count, sizeof(char *), DictionaryComparator);
+    }
+    if (canonical) *canonical = sorted;
+    return TRUE;
 }
 
-// Case-insensitive string comparison
-static int strcasecmp_custom(const char *s1, const char *s2) {
-    while (*s1 && *s2) {
-        int c1 = tolower((unsigned char)*s1);
-        int c2 = tolower((unsigned char)*s2);
-        if (c1 != c2) return c1 - c2;
-        s1++;
-        s2++;
+// Drop adjacent entries with equal keys from a sorted dictionary
+static void RemoveDuplicateWords(Dictionary *dict) {
+    if (dict->count < 2) return;
+    
+    int kept = 1;
+    for (int i = 1; i < dict->count; i++) {
+        if (strcmp(dict->words[kept - 1], dict->words[i]) != 0) {
+            dict->words[kept++] = dict->words[i];
+        }
     }
-    return tolower((unsigned char)*s1) - tolower((unsigned char)*s2);
+    dict->count = kept;
 }
 
-// Binary search for dictionary lookup
-static BOOL BinarySearchDictionary(Dictionary *dict, const char *word) {
-    int left = 0, right = dict->count - 1;
-    while (left <= right) {
+// Find key in a sorted dictionary, or the position that keeps it sorted
+static int FindInsertPosition(Dictionary *dict, const char *key, BOOL *found) {
+    int left = 0, right = dict->count;
+    while (left < right) {
         int mid = left + (right - left) / 2;
-        int cmp = strcasecmp_custom(dict->words[mid], word);
-        if (cmp == 0) return TRUE;
-        if (cmp < 0) left = mid + 1;
-        else right = mid - 1;
+        if (strcmp(dict->words[mid], key) < 0) left = mid + 1;
+        else right = mid;
     }
-    return FALSE;
+    *found = left < dict->count && strcmp(dict->words[left], key) == 0;
+    return left;
+}
+
+// Forget cached verdicts after a word list changed (caller holds sc->lock).
+// Checks running on other threads flush their own caches when they see the
+// new listVersion.
+static void FlushVerdicts(SpellChecker *sc) {
+    VerdictCache_Clear(&sc->verdictCache);
+    sc->listVersion++;
+}
+
+// Insert a word at its sorted position; returns the stored key, or NULL if
+// it was already present or storage failed (caller holds sc->lock)
+static char *InsertSortedWord(SpellChecker *sc, Dictionary *dict, const char *word, DWORD tag) {
+    size_t len = strlen(word);
+    if (len == 0 || !ReserveWords(dict, dict->count + 1)) return NULL;
+    
+    // Fold into a stack buffer first so duplicates cost no arena space
+    char lower[256];
+    if (len >= sizeof(lower)) return NULL;
+    Tokenizer_FoldUtf8(word, (DWORD)len, lower);
+    lower[len] = '\0';
+    
+    BOOL found;
+    int pos = FindInsertPosition(dict, lower, &found);
+    if (found) return NULL;
+    
+    char *key = StoreWord(dict, word, len);
+    if (!key) return NULL;
+    
+    memmove(&dict->words[pos + 1], &dict->words[pos], (dict->count - pos) * sizeof(char *));
+    dict->words[pos] = key;
+    dict->count++;
+    IndexWord(sc, key, tag);
+    FlushVerdicts(sc);  // Cached "misspelled" verdicts may now be wrong
+    return key;
 }
 
 // Create spell checker instance
-SpellChecker* SpellChecker_Create(void) {
+SpellChecker* SpellChecker_Create(DictionaryBackend backend) {
     SpellChecker *sc = (SpellChecker *)malloc(sizeof(SpellChecker));
     if (!sc) return NULL;
     
     memset(sc, 0, sizeof(SpellChecker));
+    InitializeSRWLock(&sc->lock);
+    Tokenizer_Init();  // Before the worker thread can tokenize
     sc->enabled = TRUE;
     sc->suggestionsEnabled = TRUE;
+    sc->backend = backend;
+    
+    if (backend == DICTIONARY_BACKEND_HASH && !WordTable_Init(&sc->wordTable, INITIAL_WORDTABLE_CAPACITY)) {
+        SpellChecker_Destroy(sc);
+        return NULL;
+    }
     
     // Initialize dictionaries
     sc->mainDictionary.capacity = INITIAL_DICT_CAPACITY;
@@ -115,281 +280,1103 @@ SpellChecker* SpellChecker_Create(void) {
 void SpellChecker_Destroy(SpellChecker *sc) {
     if (!sc) return;
     
-    for (int i = 0; i < sc->mainDictionary.count; i++) {
-        free(sc->mainDictionary.words[i]);
-    }
+    // Word storage goes with one call per dictionary
+    StringArena_Free(&sc->mainDictionary.arena);
     free(sc->mainDictionary.words);
-    
-    for (int i = 0; i < sc->userDictionary.count; i++) {
-        free(sc->userDictionary.words[i]);
+    for (int i = 0; i < sc->layerCount; i++) {
+        DictBinary_Close(&sc->layers[i]);
     }
+    
+    StringArena_Free(&sc->userDictionary.arena);
     free(sc->userDictionary.words);
     
-    for (int i = 0; i < sc->ignoredWords.count; i++) {
-        free(sc->ignoredWords.words[i]);
-    }
+    StringArena_Free(&sc->ignoredWords.arena);
     free(sc->ignoredWords.words);
     
-    free(sc->misspelled.words);
+    SpellChecker_FreeMisspelledList(&sc->misspelled);
+    WordTable_Free(&sc->wordTable);
+    BKTree_Free(&sc->suggestionIndex);
+    SuggestionCache_Free(&sc->suggestionCache);
     free(sc);
 }
 
+// Load dictionary from file (caller holds sc->lock)
+static BOOL LoadMainDictionary(SpellChecker *sc, const char *filePath) {
+    if (!LoadWordFile(sc, &sc->mainDictionary, filePath, TRUE, DICT_TAG_MAIN, NULL)) {
+        return FALSE;
+    }
+    return sc->mainDictionary.count > 0;
+}
+
+// Path of the compiled image for a text dictionary: same name, .bin extension
+static void BinaryPathFor(const char *textPath, char *binPath, size_t size) {
+    snprintf(binPath, size, "%s", textPath);
+    char *dot = strrchr(binPath, '.');
+    char *slash = strrchr(binPath, '\\');
+    if (!slash) slash = strrchr(binPath, '/');
+    if (dot && (!slash || dot > slash)) *dot = '\0';
+    size_t len = strlen(binPath);
+    snprintf(binPath + len, size - len, ".bin");
+}
+
+// Load user dictionary from file (caller holds sc->lock). The file doubles
+// as an append-only journal: words added later are appended to it as they
+// happen, so it may arrive unsorted or with duplicates.
+static BOOL LoadUserDictionary(SpellChecker *sc, const char *filePath) {
+    snprintf(sc->userDictionaryPath, sizeof(sc->userDictionaryPath), "%s", filePath);
+    sc->userJournalCount = 0;
+    
+    FILE *file = fopen(filePath, "rb");
+    if (!file) {
+        return TRUE; // Not an error if user dict doesn't exist yet
+    }
+    fclose(file);
+    
+    BOOL canonical;
+    int before = sc->userDictionary.count;
+    if (!LoadWordFile(sc, &sc->userDictionary, filePath, FALSE, DICT_TAG_USER, &canonical)) {
+        return FALSE;
+    }
+    RemoveDuplicateWords(&sc->userDictionary);
+    
+    // Words loaded from an unsorted journal count toward compaction
+    if (!canonical) {
+        sc->userJournalCount = sc->userDictionary.count - before;
+    }
+    return TRUE;
+}
+
+// Image for a text dictionary, parsed and indexed exactly as a private load
+// would (malloc'd), or NULL
+static BYTE *CompileImage(const char *textPath, DWORD *size) {
+    SpellChecker *sc = SpellChecker_Create(DICTIONARY_BACKEND_SORTED_ARRAY);
+    if (!sc) return NULL;
+    
+    BYTE *image = NULL;
+    if (LoadMainDictionary(sc, textPath) && !sc->suggestionIndex.incomplete) {
+        image = DictBinary_Build(textPath, sc->mainDictionary.words, sc->mainDictionary.count,
+                                 &sc->suggestionIndex, size);
+    }
+    SpellChecker_Destroy(sc);
+    return image;
+}
+
+// Map the shared image of a read-only dictionary: the one another process
+// published, else the compiled .bin, else one compiled here and published
+// for the next process
+static BOOL OpenSharedLayer(DictBinary *bin, const char *filePath) {
+    char binPath[MAX_PATH];
+    char name[MAX_PATH];
+    BinaryPathFor(filePath, binPath, sizeof(binPath));
+    if (!DictBinary_SharedName(filePath, name, sizeof(name)) &&
+        !DictBinary_SharedName(binPath, name, sizeof(name))) {
+        return FALSE;
+    }
+    
+    HANDLE lock = DictBinary_LockShared(name);
+    BOOL result = DictBinary_OpenShared(bin, name, binPath, filePath);
+    if (!result) {
+        DWORD size;
+        BYTE *image = CompileImage(filePath, &size);
+        result = image && DictBinary_Publish(bin, name, image, size);
+        free(image);
+    }
+    DictBinary_UnlockShared(lock);
+    
+    if (result && bin->header->wordCount == 0) {
+        DictBinary_Close(bin);
+        result = FALSE;
+    }
+    return result;
+}
+
+// Add a read-only dictionary as the next layer, or to the private main
+// dictionary when it can't be shared (caller holds sc->lock)
+static BOOL LoadReadOnlyDictionary(SpellChecker *sc, const char *filePath) {
+    if (sc->layerCount < SPELLCHECKER_MAX_LAYERS && OpenSharedLayer(&sc->layers[sc->layerCount], filePath)) {
+        sc->layerCount++;
+        return TRUE;
+    }
+    return LoadMainDictionary(sc, filePath);
+}
+
 // Load dictionary from file
 BOOL SpellChecker_LoadDictionary(SpellChecker *sc, const char *filePath) {
     if (!sc || !filePath) return FALSE;
     
-    FILE *file = fopen(filePath, "r");
-    if (!file) {
-        return FALSE;
+    LONGLONG start = PerfStats_Start();
+    AcquireSRWLockExclusive(&sc->lock);
+    BOOL result = LoadReadOnlyDictionary(sc, filePath);
+    sc->generation++;
+    FlushVerdicts(sc);
+    ReleaseSRWLockExclusive(&sc->lock);
+    PerfStats_Stop(PERF_DICTIONARY_LOAD, start);
+    return result;
+}
+
+BOOL SpellChecker_AddDictionary(SpellChecker *sc, const char *filePath) {
+    return SpellChecker_LoadDictionary(sc, filePath);
+}
+
+// Compile a text dictionary into a mapped image
+BOOL SpellChecker_CompileDictionary(const char *textPath, const char *binPath) {
+    if (!textPath || !binPath) return FALSE;
+    
+    // A throwaway checker parses and indexes exactly as a text load would
+    SpellChecker *sc = SpellChecker_Create(DICTIONARY_BACKEND_SORTED_ARRAY);
+    if (!sc) return FALSE;
+    
+    BOOL result = LoadMainDictionary(sc, textPath) && !sc->suggestionIndex.incomplete &&
+                  DictBinary_Write(binPath, textPath, sc->mainDictionary.words, sc->mainDictionary.count,
+                                   &sc->suggestionIndex);
+    SpellChecker_Destroy(sc);
+    return result;
+}
+
+// Load user dictionary from file
+BOOL SpellChecker_LoadUserDictionary(SpellChecker *sc, const char *filePath) {
+    if (!sc || !filePath) return FALSE;
+    
+    LONGLONG start = PerfStats_Start();
+    AcquireSRWLockExclusive(&sc->lock);
+    BOOL result = LoadUserDictionary(sc, filePath);
+    sc->generation++;
+    FlushVerdicts(sc);
+    ReleaseSRWLockExclusive(&sc->lock);
+    PerfStats_Stop(PERF_DICTIONARY_LOAD, start);
+    return result;
+}
+
+// Layer lookups, one probe of each image's own table (caller holds sc->lock)
+static BOOL LookupLayers(SpellChecker *sc, const char *word, size_t len) {
+    for (int i = 0; i < sc->layerCount; i++) {
+        if (DictBinary_Lookup(&sc->layers[i], word, len)) return TRUE;
+    }
+    return FALSE;
+}
+
+// Dictionary lookup behind the verdict cache (caller holds sc->lock)
+static BOOL LookupWordNoLock(SpellChecker *sc, const char *word, size_t len) {
+    // Most correct words are in a layer, so those are asked first
+    if (LookupLayers(sc, word, len)) return TRUE;
+    
+    // One probe answers for all three private lists
+    if (sc->backend == DICTIONARY_BACKEND_HASH) {
+        return WordTable_Lookup(&sc->wordTable, word, len) != 0;
     }
     
-    char line[256];
-    while (fgets(line, sizeof(line), file)) {
-        // Remove trailing whitespace
-        int len = strlen(line);
-        while (len > 0 && isspace((unsigned char)line[len - 1])) {
-            line[--len] = '\0';
+    // Check ignore list first (ignored words are treated as correct)
+    if (BinarySearchDictionary(&sc->ignoredWords, word, len)) return TRUE;
+    
+    // Check main dictionary
+    if (BinarySearchDictionary(&sc->mainDictionary, word, len)) return TRUE;
+    
+    // Check user dictionary
+    return BinarySearchDictionary(&sc->userDictionary, word, len);
+}
+
+// Check if the len bytes at word are a correct word (caller holds sc->lock).
+// Repeated tokens are answered from cache: sc->verdictCache normally, or a
+// thread's private one during a parallel check (NULL skips caching).
+static BOOL IsWordCorrectNoLock(SpellChecker *sc, VerdictCache *cache, const char *word, size_t len) {
+    if (!word || len == 0) return TRUE;
+    if (!cache) return LookupWordNoLock(sc, word, len);
+    
+    BOOL correct;
+    DWORD hash = VerdictCache_Hash(word, len);
+    if (VerdictCache_Find(cache, word, len, hash, &correct)) return correct;
+    
+    correct = LookupWordNoLock(sc, word, len);
+    VerdictCache_Store(cache, word, len, hash, correct);
+    return correct;
+}
+
+// Check if a word is correct
+BOOL SpellChecker_IsWordCorrect(SpellChecker *sc, const char *word) {
+    if (!sc || !word || strlen(word) == 0) return TRUE;
+    
+    // Lookups only fold ASCII themselves
+    char folded[3 * MAX_CHECKED_WORD];
+    size_t len = strlen(word);
+    if (len <= sizeof(folded)) {
+        Tokenizer_FoldUtf8(word, (DWORD)len, folded);
+        word = folded;
+    }
+    
+    AcquireSRWLockExclusive(&sc->lock);
+    BOOL result = IsWordCorrectNoLock(sc, &sc->verdictCache, word, len);
+    ReleaseSRWLockExclusive(&sc->lock);
+    return result;
+}
+
+static DWORD HashSpelling(const char *word, size_t len) {
+    DWORD hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)word[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Double the intern table and re-slot every pooled spelling
+static BOOL GrowMisspelledSlots(MisspelledWordList *list) {
+    DWORD newCapacity = list->slotCapacity > 0 ? list->slotCapacity * 2 : INITIAL_MISSPELLED_SLOTS;
+    DWORD *newSlots = (DWORD *)calloc(newCapacity, sizeof(DWORD));
+    if (!newSlots) return FALSE;
+    
+    for (DWORD i = 0; i < list->slotCapacity; i++) {
+        if (list->slots[i] == 0) continue;
+        const char *word = list->pool + list->slots[i] - 1;
+        DWORD at = HashSpelling(word, strlen(word)) & (newCapacity - 1);
+        while (newSlots[at] != 0) at = (at + 1) & (newCapacity - 1);
+        newSlots[at] = list->slots[i];
+    }
+    free(list->slots);
+    list->slots = newSlots;
+    list->slotCapacity = newCapacity;
+    return TRUE;
+}
+
+// Pool offset of word[0, len), adding it if the list hasn't seen it.
+// Returns FALSE when out of memory.
+static BOOL InternMisspelled(MisspelledWordList *list, const char *word, DWORD len, DWORD *offset) {
+    if ((list->slotsUsed + 1) * 2 > list->slotCapacity && !GrowMisspelledSlots(list)) return FALSE;
+    
+    DWORD mask = list->slotCapacity - 1;
+    DWORD at = HashSpelling(word, len) & mask;
+    for (; list->slots[at] != 0; at = (at + 1) & mask) {
+        const char *existing = list->pool + list->slots[at] - 1;
+        if (strncmp(existing, word, len) == 0 && existing[len] == '\0') {
+            *offset = list->slots[at] - 1;
+            return TRUE;
         }
+    }
+    
+    if (list->poolUsed + len + 1 > list->poolCapacity) {
+        DWORD newCapacity = list->poolCapacity > 0 ? list->poolCapacity : INITIAL_MISSPELLED_POOL;
+        while (newCapacity < list->poolUsed + len + 1) newCapacity *= 2;
+        char *newPool = (char *)realloc(list->pool, newCapacity);
+        if (!newPool) return FALSE;
+        list->pool = newPool;
+        list->poolCapacity = newCapacity;
+    }
+    memcpy(list->pool + list->poolUsed, word, len);
+    list->pool[list->poolUsed + len] = '\0';
+    *offset = list->poolUsed;
+    list->poolUsed += len + 1;
+    list->slots[at] = *offset + 1;
+    list->slotsUsed++;
+    return TRUE;
+}
+
+// Empty a list for a new pass, keeping its storage
+static void ResetMisspelled(MisspelledWordList *list) {
+    list->count = 0;
+    list->poolUsed = 0;
+    list->poolCompacted = 0;
+    list->slotsUsed = 0;
+    if (list->slots) memset(list->slots, 0, list->slotCapacity * sizeof(DWORD));
+}
+
+// Hand src's pool (and intern table) to dst, leaving src without one
+static void MoveMisspelledPool(MisspelledWordList *dst, MisspelledWordList *src) {
+    dst->pool = src->pool;
+    dst->poolUsed = src->poolUsed;
+    dst->poolCapacity = src->poolCapacity;
+    dst->poolCompacted = src->poolCompacted;
+    dst->slots = src->slots;
+    dst->slotCapacity = src->slotCapacity;
+    dst->slotsUsed = src->slotsUsed;
+    src->pool = NULL;
+    src->poolUsed = src->poolCapacity = src->poolCompacted = 0;
+    src->slots = NULL;
+    src->slotCapacity = src->slotsUsed = 0;
+}
+
+// Range re-checks only add spellings, so once the pool has doubled since it
+// was last rebuilt, rebuild it from the spellings the entries still use
+static void CompactMisspelledPool(MisspelledWordList *list) {
+    if (list->poolUsed / 2 < max(list->poolCompacted, (DWORD)INITIAL_MISSPELLED_POOL)) return;
+    
+    // New offsets are kept aside until every spelling fits, so a failure
+    // leaves the list as it was
+    MisspelledWordList fresh = {0};
+    DWORD *offsets = (DWORD *)malloc((list->count + 1) * sizeof(DWORD));
+    BOOL ok = offsets != NULL;
+    for (int i = 0; ok && i < list->count; i++) {
+        const char *spelling = list->pool + list->words[i].word;
+        ok = InternMisspelled(&fresh, spelling, (DWORD)strlen(spelling), &offsets[i]);
+    }
+    if (ok) {
+        for (int i = 0; i < list->count; i++) {
+            list->words[i].word = offsets[i];
+        }
+        free(list->pool);
+        free(list->slots);
+        MoveMisspelledPool(list, &fresh);
+    }
+    free(offsets);
+    free(fresh.pool);
+    free(fresh.slots);
+    list->poolCompacted = list->poolUsed;  // Even on failure: retry after another doubling
+}
+
+// Append a misspelled word spelled word[0, len) to a list, growing it as
+// needed
+static BOOL AppendMisspelled(MisspelledWordList *list, DWORD startPos, DWORD endPos, const char *word, DWORD len) {
+    if (list->count >= list->capacity) {
+        int newCapacity = list->capacity > 0 ? list->capacity * 2 : INITIAL_MISSPELLED_CAPACITY;
+        MisspelledWord *newWords = (MisspelledWord *)realloc(list->words, newCapacity * sizeof(MisspelledWord));
+        if (!newWords) return FALSE;
+        list->words = newWords;
+        list->capacity = newCapacity;
+    }
+    
+    DWORD offset;
+    if (!InternMisspelled(list, word, len, &offset)) return FALSE;
+    list->words[list->count].startPos = startPos;
+    list->words[list->count].endPos = endPos;
+    list->words[list->count].word = offset;
+    list->count++;
+    return TRUE;
+}
+
+// Checks hold sc->lock one batch of words at a time, so an addition or a
+// suggestion request waits for at most one batch: exclusive when they
+// memoize into sc->verdictCache, shared with a thread's own cache (or none).
+// A word list changed between batches applies from the next batch on.
+static void LockForCheck(SpellChecker *sc, VerdictCache *cache) {
+    if (cache == &sc->verdictCache) {
+        AcquireSRWLockExclusive(&sc->lock);
+        return;
+    }
+    AcquireSRWLockShared(&sc->lock);
+    if (cache && cache->version != sc->listVersion) {
+        VerdictCache_Clear(cache);
+        cache->version = sc->listVersion;
+    }
+}
+
+static void UnlockForCheck(SpellChecker *sc, const VerdictCache *cache) {
+    if (cache == &sc->verdictCache) ReleaseSRWLockExclusive(&sc->lock);
+    else ReleaseSRWLockShared(&sc->lock);
+}
+
+static void RecordCheckTime(SpellChecker *sc, LONGLONG start) {
+    AcquireSRWLockExclusive(&sc->lock);
+    sc->lastCheckTime = PerfStats_ElapsedMs(start);
+    ReleaseSRWLockExclusive(&sc->lock);
+}
+
+// Tokenize text[start, end) and append every misspelled word to the list.
+// start must sit on a word boundary; words running past end are still read
+// to completion (up to textLen, the buffer size) so a span never splits a
+// word. Words are looked up in place; only misspelled ones are interned
+// into the list's pool. text need not be NUL-terminated. sc->lock is taken
+// per batch, so the caller must not hold it.
+static void CheckSpan(SpellChecker *sc, VerdictCache *cache, const char *text, DWORD textLen, DWORD start, DWORD end,
+                      MisspelledWordList *list) {
+    TokenSpan spans[CHECK_SPAN_BATCH];
+    DWORD pos = start;
+    
+    while (pos < end) {
+        DWORD scanned;
+        int count = Tokenizer_FindWords(text + pos, end - pos, spans, CHECK_SPAN_BATCH, &scanned);
         
-        if (len == 0 || line[0] == '#') continue; // Skip empty lines and comments
-        
-        // Check if we need to expand capacity
-        if (sc->mainDictionary.count >= sc->mainDictionary.capacity) {
-            sc->mainDictionary.capacity *= 2;
-            char **newWords = (char **)realloc(sc->mainDictionary.words, 
-                                              sc->mainDictionary.capacity * sizeof(char *));
-            if (!newWords) {
-                fclose(file);
-                return FALSE;
+        LockForCheck(sc, cache);
+        for (int i = 0; i < count; i++) {
+            DWORD wordStart = pos + spans[i].start;
+            DWORD wordEnd = wordStart + spans[i].length;
+            if (wordEnd == end) {
+                while (wordEnd < textLen && Tokenizer_IsLetter(text[wordEnd])) wordEnd++;
+            }
+            
+            // Overlong runs are checked in pieces, as long as each piece
+            // still starts inside the span
+            for (DWORD pieceStart = wordStart; pieceStart < wordEnd && pieceStart < end;
+                 pieceStart += MAX_CHECKED_WORD) {
+                DWORD pieceEnd = min(wordEnd, pieceStart + (DWORD)MAX_CHECKED_WORD);
+                if (!IsWordCorrectNoLock(sc, cache, text + pieceStart, pieceEnd - pieceStart) &&
+                    !AppendMisspelled(list, pieceStart, pieceEnd, text + pieceStart, pieceEnd - pieceStart)) {
+                    UnlockForCheck(sc, cache);
+                    return;
+                }
             }
-            sc->mainDictionary.words = newWords;
         }
+        UnlockForCheck(sc, cache);
         
-        // Add word to dictionary
-        sc->mainDictionary.words[sc->mainDictionary.count] = (char *)malloc(len + 1);
-        if (!sc->mainDictionary.words[sc->mainDictionary.count]) {
-            fclose(file);
-            return FALSE;
+        if (scanned == 0) break;
+        pos += scanned;
+    }
+}
+
+// CheckSpan over UTF-16 text, positions counting WCHARs. Each word is
+// encoded case-folded into UTF-8 on the stack for the lookup, and only a
+// misspelled one again in its own case for the list's pool.
+static void CheckSpanW(SpellChecker *sc, VerdictCache *cache, const WCHAR *text, DWORD textLen, DWORD start,
+                       DWORD end, MisspelledWordList *list) {
+    TokenSpan spans[CHECK_SPAN_BATCH];
+    char key[3 * MAX_CHECKED_WORD];
+    char spelling[3 * MAX_CHECKED_WORD];
+    DWORD pos = start;
+    
+    while (pos < end) {
+        DWORD scanned;
+        int count = Tokenizer_FindWordsW(text + pos, end - pos, spans, CHECK_SPAN_BATCH, &scanned);
+        
+        LockForCheck(sc, cache);
+        for (int i = 0; i < count; i++) {
+            DWORD wordStart = pos + spans[i].start;
+            DWORD wordEnd = wordStart + spans[i].length;
+            if (wordEnd == end) {
+                while (wordEnd < textLen && Tokenizer_IsLetterW(text[wordEnd])) wordEnd++;
+            }
+            
+            for (DWORD pieceStart = wordStart; pieceStart < wordEnd && pieceStart < end;
+                 pieceStart += MAX_CHECKED_WORD) {
+                DWORD pieceEnd = min(wordEnd, pieceStart + (DWORD)MAX_CHECKED_WORD);
+                DWORD pieceLen = pieceEnd - pieceStart;
+                DWORD keyLen = Tokenizer_ToUtf8(text + pieceStart, pieceLen, TRUE, key, sizeof(key));
+                if (IsWordCorrectNoLock(sc, cache, key, keyLen)) continue;
+                
+                DWORD spellingLen = Tokenizer_ToUtf8(text + pieceStart, pieceLen, FALSE, spelling, sizeof(spelling));
+                if (!AppendMisspelled(list, pieceStart, pieceEnd, spelling, spellingLen)) {
+                    UnlockForCheck(sc, cache);
+                    return;
+                }
+            }
         }
-        strcpy(sc->mainDictionary.words[sc->mainDictionary.count], line);
-        sc->mainDictionary.count++;
+        UnlockForCheck(sc, cache);
+        
+        if (scanned == 0) break;
+        pos += scanned;
     }
+}
+
+// The span checker for a document's encoding
+static void CheckDocumentSpan(SpellChecker *sc, VerdictCache *cache, const SpellCheckDocument *doc, DWORD start,
+                              DWORD end, MisspelledWordList *list) {
+    if (doc->wideText) {
+        CheckSpanW(sc, cache, doc->wideText, doc->len, start, end, list);
+    } else {
+        CheckSpan(sc, cache, doc->text, doc->len, start, end, list);
+    }
+}
+
+// Extract words from text and check spelling into the caller's list
+void SpellChecker_CheckInto(SpellChecker *sc, const char *text, MisspelledWordList *list) {
+    if (!list) return;
     
-    fclose(file);
+    // Reset misspelled list at start of every pass
+    ResetMisspelled(list);
+    
+    if (!sc || !sc->enabled) return;
     
-    // Sort the main dictionary for binary search
-    if (sc->mainDictionary.count > 0) {
-        qsort(sc->mainDictionary.words, sc->mainDictionary.count, sizeof(char *), DictionaryComparator);
+    // Empty text has nothing to check; whitespace-only text simply yields
+    // no words from the tokenizer
+    if (!text || text[0] == '\0') {
+        return;
     }
     
-    return sc->mainDictionary.count > 0;
+    DWORD len = (DWORD)strlen(text);
+    LONGLONG start = PerfStats_Start();
+    CheckSpan(sc, &sc->verdictCache, text, len, 0, len, list);
+    RecordCheckTime(sc, start);
+    PerfStats_Stop(PERF_CHECK, start);
 }
 
-// Load user dictionary from file
-BOOL SpellChecker_LoadUserDictionary(SpellChecker *sc, const char *filePath) {
-    if (!sc || !filePath) return FALSE;
-    
-    FILE *file = fopen(filePath, "r");
-    if (!file) {
-        return TRUE; // Not an error if user dict doesn't exist yet
+void SpellChecker_CheckIntoW(SpellChecker *sc, const WCHAR *text, DWORD len, MisspelledWordList *list) {
+    if (!list) return;
+    ResetMisspelled(list);
+    if (!sc || !sc->enabled || !text || len == 0) return;
+    
+    LONGLONG start = PerfStats_Start();
+    CheckSpanW(sc, &sc->verdictCache, text, len, 0, len, list);
+    RecordCheckTime(sc, start);
+    PerfStats_Stop(PERF_CHECK, start);
+}
+
+// Extract words from text and check spelling
+void SpellChecker_Check(SpellChecker *sc, const char *text) {
+    if (!sc) return;
+    SpellChecker_CheckInto(sc, text, &sc->misspelled);
+}
+
+// One slice of a parallel check; start and end sit on word boundaries.
+// A document checked as a single chunk writes straight into its own list.
+typedef struct {
+    SpellCheckDocument *doc;
+    DWORD start;
+    DWORD end;
+    MisspelledWordList *out;
+    MisspelledWordList list;   // Private results when the document is split
+} CheckChunk;
+
+typedef struct {
+    SpellChecker *sc;
+    CheckChunk *chunks;
+    LONG chunkCount;
+    volatile LONG nextChunk;   // Chunks are claimed in order by whichever thread is free
+    volatile LONG hits;        // Private verdict cache counters, folded in at the end
+    volatile LONG misses;
+} ParallelCheck;
+
+// Thread pool callback (also run on the calling thread): check chunks until
+// none are left. The dictionaries are only read, under sc->lock shared.
+static VOID CALLBACK CheckChunkWork(PTP_CALLBACK_INSTANCE instance, PVOID context, PTP_WORK work) {
+    ParallelCheck *job = (ParallelCheck *)context;
+    (void)instance;
+    (void)work;
+    
+    // sc->verdictCache is not thread-safe; each thread memoizes on its own
+    VerdictCache *cache = (VerdictCache *)calloc(1, sizeof(VerdictCache));
+    
+    for (;;) {
+        LONG index = InterlockedIncrement(&job->nextChunk) - 1;
+        if (index >= job->chunkCount) break;
+        CheckChunk *chunk = &job->chunks[index];
+        CheckDocumentSpan(job->sc, cache, chunk->doc, chunk->start, chunk->end, chunk->out);
     }
     
-    char line[256];
-    while (fgets(line, sizeof(line), file)) {
-        int len = strlen(line);
-        while (len > 0 && isspace((unsigned char)line[len - 1])) {
-            line[--len] = '\0';
+    if (cache) {
+        InterlockedExchangeAdd(&job->hits, (LONG)cache->hits);
+        InterlockedExchangeAdd(&job->misses, (LONG)cache->misses);
+        free(cache);
+    }
+}
+
+// Number of slices a document is worth: one per PARALLEL_MIN_CHUNK, capped
+static int ChunksForDocument(const SpellCheckDocument *doc, int maxChunks) {
+    DWORD slices = doc->len / PARALLEL_MIN_CHUNK;
+    return slices < 2 ? 1 : (int)min(slices, (DWORD)maxChunks);
+}
+
+// Split doc into up to maxChunks near-equal slices, moving each cut forward
+// off any word it lands in. Returns the number of non-empty chunks.
+static int SplitIntoChunks(SpellCheckDocument *doc, CheckChunk *chunks, int maxChunks) {
+    int count = 0;
+    DWORD pos = 0;
+    for (int i = 0; i < maxChunks && pos < doc->len; i++) {
+        DWORD cut = (i == maxChunks - 1) ? doc->len : (DWORD)((ULONGLONG)doc->len * (i + 1) / maxChunks);
+        if (cut < pos) cut = pos;
+        while (cut < doc->len &&
+               (doc->wideText ? Tokenizer_IsLetterW(doc->wideText[cut]) : Tokenizer_IsLetter(doc->text[cut]))) {
+            cut++;
         }
+        if (cut == pos) continue;
         
-        if (len == 0) continue;
-        
-        if (sc->userDictionary.count >= sc->userDictionary.capacity) {
-            sc->userDictionary.capacity *= 2;
-            char **newWords = (char **)realloc(sc->userDictionary.words,
-                                              sc->userDictionary.capacity * sizeof(char *));
-            if (!newWords) {
-                fclose(file);
-                return FALSE;
-            }
-            sc->userDictionary.words = newWords;
+        chunks[count].doc = doc;
+        chunks[count].start = pos;
+        chunks[count].end = cut;
+        chunks[count].out = maxChunks > 1 ? &chunks[count].list : &doc->list;
+        count++;
+        pos = cut;
+    }
+    return count;
+}
+
+// Concatenate a split document's chunk results (already in text order),
+// re-interning their spellings into the document's pool
+static BOOL MergeChunks(const CheckChunk *chunks, int chunkCount, MisspelledWordList *list) {
+    int total = 0;
+    for (int i = 0; i < chunkCount; i++) {
+        total += chunks[i].list.count;
+    }
+    if (total > list->capacity) {
+        MisspelledWord *newWords = (MisspelledWord *)realloc(list->words, total * sizeof(MisspelledWord));
+        if (!newWords) return FALSE;
+        list->words = newWords;
+        list->capacity = total;
+    }
+    
+    ResetMisspelled(list);
+    for (int i = 0; i < chunkCount; i++) {
+        const MisspelledWordList *part = &chunks[i].list;
+        for (int w = 0; w < part->count; w++) {
+            MisspelledWord *mw = &list->words[list->count];
+            *mw = part->words[w];
+            const char *spelling = part->pool + mw->word;
+            if (!InternMisspelled(list, spelling, (DWORD)strlen(spelling), &mw->word)) return FALSE;
+            list->count++;
         }
-        
-        sc->userDictionary.words[sc->userDictionary.count] = (char *)malloc(len + 1);
-        if (!sc->userDictionary.words[sc->userDictionary.count]) {
-            fclose(file);
-            return FALSE;
+    }
+    return TRUE;
+}
+
+void SpellChecker_CheckDocuments(SpellChecker *sc, SpellCheckDocument *docs, int docCount, int maxThreads) {
+    if (!docs) return;
+    for (int d = 0; d < docCount; d++) {
+        ResetMisspelled(&docs[d].list);
+    }
+    if (!sc || !sc->enabled || docCount <= 0) return;
+    
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    int threads = (int)info.dwNumberOfProcessors;
+    if (maxThreads > 0 && maxThreads < threads) threads = maxThreads;
+    if (threads < 1) threads = 1;
+    int maxChunks = threads * PARALLEL_CHUNKS_PER_THREAD;
+    
+    int totalChunks = 0;
+    for (int d = 0; d < docCount; d++) {
+        totalChunks += ChunksForDocument(&docs[d], maxChunks);
+    }
+    CheckChunk *chunks = (CheckChunk *)calloc(totalChunks, sizeof(CheckChunk));
+    
+    LONGLONG start = PerfStats_Start();
+    if (!chunks) {
+        // No room to plan; check everything on this thread
+        for (int d = 0; d < docCount; d++) {
+            CheckDocumentSpan(sc, &sc->verdictCache, &docs[d], 0, docs[d].len, &docs[d].list);
         }
-        strcpy(sc->userDictionary.words[sc->userDictionary.count], line);
-        sc->userDictionary.count++;
+        RecordCheckTime(sc, start);
+        PerfStats_Stop(PERF_CHECK, start);
+        return;
     }
     
-    fclose(file);
+    ParallelCheck job = {0};
+    job.sc = sc;
+    job.chunks = chunks;
+    for (int d = 0; d < docCount; d++) {
+        if (!docs[d].text && !docs[d].wideText) continue;
+        job.chunkCount += SplitIntoChunks(&docs[d], &chunks[job.chunkCount], ChunksForDocument(&docs[d], maxChunks));
+    }
     
-    // Sort the user dictionary for binary search
-    if (sc->userDictionary.count > 0) {
-        qsort(sc->userDictionary.words, sc->userDictionary.count, sizeof(char *), DictionaryComparator);
+    // The calling thread works too, so one fewer pool callback
+    int helpers = min(threads, (int)job.chunkCount) - 1;
+    PTP_WORK work = helpers > 0 ? CreateThreadpoolWork(CheckChunkWork, &job, NULL) : NULL;
+    for (int i = 0; work && i < helpers; i++) {
+        SubmitThreadpoolWork(work);
+    }
+    CheckChunkWork(NULL, &job, NULL);
+    if (work) {
+        WaitForThreadpoolWorkCallbacks(work, FALSE);
+        CloseThreadpoolWork(work);
     }
     
-    return TRUE;
+    AcquireSRWLockExclusive(&sc->lock);
+    sc->verdictCache.hits += (DWORD)job.hits;
+    sc->verdictCache.misses += (DWORD)job.misses;
+    ReleaseSRWLockExclusive(&sc->lock);
+    
+    // Gather each split document's slices, which sit next to each other
+    for (int i = 0; i < job.chunkCount; ) {
+        SpellCheckDocument *doc = job.chunks[i].doc;
+        int first = i;
+        while (i < job.chunkCount && job.chunks[i].doc == doc) i++;
+        if (job.chunks[first].out == &doc->list) continue;
+        
+        if (!MergeChunks(&job.chunks[first], i - first, &doc->list)) {
+            // Out of memory for the merged list; one sequential pass into it
+            ResetMisspelled(&doc->list);
+            CheckDocumentSpan(sc, &sc->verdictCache, doc, 0, doc->len, &doc->list);
+        }
+    }
+    RecordCheckTime(sc, start);
+    PerfStats_Stop(PERF_CHECK, start);
+    
+    for (int i = 0; i < job.chunkCount; i++) {
+        SpellChecker_FreeMisspelledList(&job.chunks[i].list);
+    }
+    free(chunks);
 }
 
-// Check if a word is correct
-BOOL SpellChecker_IsWordCorrect(SpellChecker *sc, const char *word) {
-    if (!sc || !word || strlen(word) == 0) return TRUE;
+void SpellChecker_CheckParallelInto(SpellChecker *sc, const char *text, DWORD len, MisspelledWordList *list) {
+    if (!list) return;
     
-    // Check ignore list first (ignored words are treated as correct)
-    if (BinarySearchDictionary(&sc->ignoredWords, word)) return TRUE;
+    // Borrow the caller's list storage for the duration of the check
+    SpellCheckDocument doc = { text, text ? len : 0, *list, NULL };
+    SpellChecker_CheckDocuments(sc, &doc, 1, 0);
+    *list = doc.list;
+}
+
+void SpellChecker_CheckParallelIntoW(SpellChecker *sc, const WCHAR *text, DWORD len, MisspelledWordList *list) {
+    if (!list) return;
     
-    // Check main dictionary
-    if (BinarySearchDictionary(&sc->mainDictionary, word)) return TRUE;
+    SpellCheckDocument doc = { NULL, text ? len : 0, *list, text };
+    SpellChecker_CheckDocuments(sc, &doc, 1, 0);
+    *list = doc.list;
+}
+
+// Put the re-checked span [scanStart, scanEnd) (post-edit coordinates)
+// into list, which still describes the buffer before the edit: entries that
+// overlapped the span are replaced by fresh's, and the ones after it are
+// shifted. fresh shares list's pool. FALSE if the list couldn't grow.
+static BOOL SpliceRecheckedSpan(MisspelledWordList *list, const MisspelledWordList *fresh, DWORD scanStart,
+                                DWORD scanEnd, DWORD oldLen, DWORD newLen) {
+    // Same boundary expressed in pre-edit coordinates
+    DWORD oldScanEnd = scanEnd - newLen + oldLen;
+    
+    // Entries [first, last) fell inside the re-scanned span; everything from
+    // 'last' onward sits after the edit and only needs its offsets shifted
+    int first = 0;
+    while (first < list->count && list->words[first].endPos <= scanStart) {
+        first++;
+    }
+    int last = first;
+    while (last < list->count && list->words[last].startPos < oldScanEnd) {
+        last++;
+    }
     
-    // Check user dictionary
-    if (BinarySearchDictionary(&sc->userDictionary, word)) return TRUE;
+    int newCount = list->count - (last - first) + fresh->count;
+    if (newCount > list->capacity) {
+        int newCapacity = list->capacity > 0 ? list->capacity : INITIAL_MISSPELLED_CAPACITY;
+        while (newCapacity < newCount) newCapacity *= 2;
+        MisspelledWord *newWords = (MisspelledWord *)realloc(list->words, newCapacity * sizeof(MisspelledWord));
+        if (!newWords) return FALSE;
+        list->words = newWords;
+        list->capacity = newCapacity;
+    }
     
-    return FALSE;
+    for (int i = last; i < list->count; i++) {
+        list->words[i].startPos = list->words[i].startPos - oldLen + newLen;
+        list->words[i].endPos = list->words[i].endPos - oldLen + newLen;
+    }
+    if (last < list->count) {
+        memmove(&list->words[first + fresh->count], &list->words[last],
+                (list->count - last) * sizeof(MisspelledWord));
+    }
+    if (fresh->count > 0) {
+        memcpy(&list->words[first], fresh->words, fresh->count * sizeof(MisspelledWord));
+    }
+    list->count = newCount;
+    return TRUE;
 }
 
-// Extract words from text and check spelling
-void SpellChecker_Check(SpellChecker *sc, const char *text) {
-    if (!sc || !sc->enabled) {
-        if (sc) sc->misspelled.count = 0;
+// Re-check only the words touched by an edit. The edit replaced oldLen
+// characters at editStart with newLen characters; text is the full buffer
+// after the edit and list must describe the buffer before it.
+void SpellChecker_CheckRangeInto(SpellChecker *sc, const char *text, DWORD editStart, DWORD oldLen, DWORD newLen,
+                                 MisspelledWordList *list) {
+    if (!list) return;
+    if (!sc || !sc->enabled || !text) {
+        ResetMisspelled(list);
         return;
     }
     
-    // Reset misspelled list at start of every pass
-    sc->misspelled.count = 0;
-    
-    // Detect empty or whitespace-only text and reset state
-    if (!text || text[0] == '\0') {
-        sc->misspelled.count = 0;
+    DWORD textLen = (DWORD)strlen(text);
+    if (editStart > textLen || newLen > textLen - editStart) {
+        // Range doesn't fit the buffer; fall back to a full pass
+        SpellChecker_CheckInto(sc, text, list);
         return;
     }
     
-    // Check if text is only whitespace
-    const char *checkPtr = text;
-    BOOL onlyWhitespace = TRUE;
-    while (*checkPtr) {
-        if (!isspace((unsigned char)*checkPtr)) {
-            onlyWhitespace = FALSE;
-            break;
-        }
-        checkPtr++;
+    // Widen the dirty span out to the enclosing word boundaries
+    DWORD scanStart = editStart;
+    while (scanStart > 0 && Tokenizer_IsLetter(text[scanStart - 1])) {
+        scanStart--;
+    }
+    DWORD scanEnd = editStart + newLen;
+    while (scanEnd < textLen && Tokenizer_IsLetter(text[scanEnd])) {
+        scanEnd++;
     }
     
-    if (onlyWhitespace) {
-        sc->misspelled.count = 0;
+    // Re-tokenize the span into a scratch list and splice it in. The scratch
+    // list borrows this list's pool, so the spliced entries need no copying.
+    MisspelledWordList fresh = {0};
+    MoveMisspelledPool(&fresh, list);
+    LONGLONG start = PerfStats_Start();
+    CheckSpan(sc, &sc->verdictCache, text, textLen, scanStart, scanEnd, &fresh);
+    RecordCheckTime(sc, start);
+    PerfStats_Stop(PERF_CHECK_RANGE, start);
+    MoveMisspelledPool(list, &fresh);
+    
+    if (!SpliceRecheckedSpan(list, &fresh, scanStart, scanEnd, oldLen, newLen)) {
+        SpellChecker_CheckInto(sc, text, list);
+    }
+    CompactMisspelledPool(list);
+    free(fresh.words);
+}
+
+void SpellChecker_CheckRangeIntoW(SpellChecker *sc, const WCHAR *text, DWORD len, DWORD editStart, DWORD oldLen,
+                                  DWORD newLen, MisspelledWordList *list) {
+    if (!list) return;
+    if (!sc || !sc->enabled || !text) {
+        ResetMisspelled(list);
+        return;
+    }
+    if (editStart > len || newLen > len - editStart) {
+        SpellChecker_CheckIntoW(sc, text, len, list);
         return;
     }
     
-    const char *ptr = text;
-    DWORD pos = 0;
+    DWORD scanStart = editStart;
+    while (scanStart > 0 && Tokenizer_IsLetterW(text[scanStart - 1])) {
+        scanStart--;
+    }
+    DWORD scanEnd = editStart + newLen;
+    while (scanEnd < len && Tokenizer_IsLetterW(text[scanEnd])) {
+        scanEnd++;
+    }
     
-    while (*ptr) {
-        // Skip non-alphabetic characters
-        while (*ptr && !isalpha((unsigned char)*ptr)) {
-            ptr++;
-            pos++;
-        }
-        
-        if (!*ptr) break;
-        
-        // Extract word
-        DWORD wordStart = pos;
-        char word[256] = {0};
-        int wordLen = 0;
-        
-        while (*ptr && isalpha((unsigned char)*ptr) && wordLen < sizeof(word) - 1) {
-            word[wordLen++] = *ptr;
-            ptr++;
-            pos++;
-        }
-        word[wordLen] = '\0';
-        
-        // Check spelling
-        if (!SpellChecker_IsWordCorrect(sc, word)) {
-            // Add to misspelled list
-            if (sc->misspelled.count >= sc->misspelled.capacity) {
-                sc->misspelled.capacity *= 2;
-                MisspelledWord *newWords = (MisspelledWord *)realloc(sc->misspelled.words,
-                                                                     sc->misspelled.capacity * sizeof(MisspelledWord));
-                if (!newWords) return;
-                sc->misspelled.words = newWords;
-            }
-            
-            sc->misspelled.words[sc->misspelled.count].startPos = wordStart;
-            sc->misspelled.words[sc->misspelled.count].endPos = pos;
-            strcpy(sc->misspelled.words[sc->misspelled.count].word, word);
-            sc->misspelled.count++;
-        }
+    MisspelledWordList fresh = {0};
+    MoveMisspelledPool(&fresh, list);
+    LONGLONG start = PerfStats_Start();
+    CheckSpanW(sc, &sc->verdictCache, text, len, scanStart, scanEnd, &fresh);
+    RecordCheckTime(sc, start);
+    PerfStats_Stop(PERF_CHECK_RANGE, start);
+    MoveMisspelledPool(list, &fresh);
+    
+    if (!SpliceRecheckedSpan(list, &fresh, scanStart, scanEnd, oldLen, newLen)) {
+        SpellChecker_CheckIntoW(sc, text, len, list);
     }
+    CompactMisspelledPool(list);
+    free(fresh.words);
 }
 
-// Get suggestions for a misspelled word
-char** SpellChecker_GetSuggestions(SpellChecker *sc, const char *word, int *count) {
-    if (!sc || !word || !count) return NULL;
+// Re-check only the words touched by an edit, updating sc->misspelled
+void SpellChecker_CheckRange(SpellChecker *sc, const char *text, DWORD editStart, DWORD oldLen, DWORD newLen) {
+    if (!sc) return;
+    SpellChecker_CheckRangeInto(sc, text, editStart, oldLen, newLen, &sc->misspelled);
+}
+
+// Find the single span that differs between two snapshots of a buffer:
+// common prefix and suffix are trimmed, the rest is the edit
+void SpellChecker_ComputeEditRange(const char *oldText, int oldTextLen, const char *newText, int newTextLen,
+                                   DWORD *editStart, DWORD *oldLen, DWORD *newLen) {
+    int prefix = 0;
+    int maxPrefix = oldTextLen < newTextLen ? oldTextLen : newTextLen;
+    while (prefix < maxPrefix && oldText[prefix] == newText[prefix]) {
+        prefix++;
+    }
     
-    *count = 0;
+    int suffix = 0;
+    while (suffix < maxPrefix - prefix &&
+           oldText[oldTextLen - 1 - suffix] == newText[newTextLen - 1 - suffix]) {
+        suffix++;
+    }
     
-    typedef struct {
-        char *word;
-        int distance;
-    } Suggestion;
+    *editStart = (DWORD)prefix;
+    *oldLen = (DWORD)(oldTextLen - prefix - suffix);
+    *newLen = (DWORD)(newTextLen - prefix - suffix);
+}
+
+void SpellChecker_ComputeEditRangeW(const WCHAR *oldText, int oldTextLen, const WCHAR *newText, int newTextLen,
+                                    DWORD *editStart, DWORD *oldLen, DWORD *newLen) {
+    int prefix = 0;
+    int maxPrefix = oldTextLen < newTextLen ? oldTextLen : newTextLen;
+    while (prefix < maxPrefix && oldText[prefix] == newText[prefix]) {
+        prefix++;
+    }
     
-    Suggestion *suggestions = (Suggestion *)malloc(10 * sizeof(Suggestion));
-    if (!suggestions) return NULL;
+    int suffix = 0;
+    while (suffix < maxPrefix - prefix &&
+           oldText[oldTextLen - 1 - suffix] == newText[newTextLen - 1 - suffix]) {
+        suffix++;
+    }
     
-    int suggestCount = 0;
-    int maxDistance = 2; // Only suggest words within edit distance of 2
+    *editStart = (DWORD)prefix;
+    *oldLen = (DWORD)(oldTextLen - prefix - suffix);
+    *newLen = (DWORD)(newTextLen - prefix - suffix);
+}
+
+// Release a list's storage
+void SpellChecker_FreeMisspelledList(MisspelledWordList *list) {
+    if (!list) return;
+    free(list->words);
+    free(list->pool);
+    free(list->slots);
+    memset(list, 0, sizeof(MisspelledWordList));
+}
+
+// Replace dst's contents with a copy of src
+BOOL SpellChecker_CopyMisspelledList(MisspelledWordList *dst, const MisspelledWordList *src) {
+    if (!dst || !src) return FALSE;
+    
+    if (src->count > dst->capacity) {
+        MisspelledWord *newWords = (MisspelledWord *)realloc(dst->words, src->count * sizeof(MisspelledWord));
+        if (!newWords) return FALSE;
+        dst->words = newWords;
+        dst->capacity = src->count;
+    }
+    if (src->poolUsed > dst->poolCapacity) {
+        char *newPool = (char *)realloc(dst->pool, src->poolUsed);
+        if (!newPool) return FALSE;
+        dst->pool = newPool;
+        dst->poolCapacity = src->poolUsed;
+    }
+    if (src->slotCapacity != dst->slotCapacity) {
+        free(dst->slots);
+        dst->slots = src->slotCapacity > 0 ? (DWORD *)malloc(src->slotCapacity * sizeof(DWORD)) : NULL;
+        dst->slotCapacity = dst->slots ? src->slotCapacity : 0;
+        if (!dst->slots && src->slotCapacity > 0) return FALSE;
+    }
     
-    // Check main dictionary
-    for (int i = 0; i < sc->mainDictionary.count && suggestCount < 10; i++) {
-        int dist = LevenshteinDistance(word, sc->mainDictionary.words[i]);
-        if (dist > 0 && dist <= maxDistance) {
-            suggestions[suggestCount].word = sc->mainDictionary.words[i];
-            suggestions[suggestCount].distance = dist;
-            suggestCount++;
+    if (src->count > 0) {
+        memcpy(dst->words, src->words, src->count * sizeof(MisspelledWord));
+    }
+    if (src->poolUsed > 0) memcpy(dst->pool, src->pool, src->poolUsed);
+    if (src->slotCapacity > 0) memcpy(dst->slots, src->slots, src->slotCapacity * sizeof(DWORD));
+    dst->count = src->count;
+    dst->poolUsed = src->poolUsed;
+    dst->poolCompacted = src->poolCompacted;
+    dst->slotsUsed = src->slotsUsed;
+    return TRUE;
+}
+
+// Rank every private main and user word by brute force; only used when the
+// suggestion index could not be built
+static int ScanDictionariesForSuggestions(SpellChecker *sc, const char *word, BKTreeMatch *matches, int maxMatches) {
+    int found = 0;
+    int bound = SUGGESTION_MAX_DISTANCE;
+    int distances[SUGGESTION_SCAN_BATCH];
+    Dictionary *dicts[2] = { &sc->mainDictionary, &sc->userDictionary };
+    
+    EditDistanceQuery query;
+    EditDistance_Init(&query);
+    EditDistance_Prepare(&query, word);
+    
+    for (int d = 0; d < 2; d++) {
+        for (int first = 0; first < dicts[d]->count; first += SUGGESTION_SCAN_BATCH) {
+            const char * const *batch = (const char * const *)&dicts[d]->words[first];
+            int batchCount = min(dicts[d]->count - first, SUGGESTION_SCAN_BATCH);
+            if (EditDistance_Batch(&query, batch, batchCount, bound, distances) == 0) continue;
+            
+            for (int i = 0; i < batchCount; i++) {
+                if (distances[i] == 0 || distances[i] > bound) continue;
+                BKTree_AddMatch(matches, &found, maxMatches, batch[i], distances[i]);
+                // With a full list nothing farther than the worst match can win
+                if (found == maxMatches && matches[found - 1].distance < bound) {
+                    bound = matches[found - 1].distance;
+                }
+            }
         }
     }
     
-    // Sort by distance
-    for (int i = 0; i < suggestCount - 1; i++) {
-        for (int j = i + 1; j < suggestCount; j++) {
-            if (suggestions[j].distance < suggestions[i].distance) {
-                Suggestion temp = suggestions[i];
-                suggestions[i] = suggestions[j];
-                suggestions[j] = temp;
-            }
+    EditDistance_Free(&query);
+    return found;
+}
+
+// Add a layer's best candidates to the ranked matches, skipping words a
+// lower layer or the user dictionary already offered. Returns the new count.
+static int MergeLayerSuggestions(const DictBinary *layer, const char *word, BKTreeMatch *matches, int count) {
+    // A full list only takes candidates closer than its worst
+    int bound = count == SUGGESTION_MAX_RESULTS ? matches[count - 1].distance : SUGGESTION_MAX_DISTANCE;
+    BKTreeMatch found[SUGGESTION_MAX_RESULTS];
+    int foundCount = DictBinary_Query(layer, word, bound, found, SUGGESTION_MAX_RESULTS);
+    
+    for (int i = 0; i < foundCount; i++) {
+        BOOL offered = FALSE;
+        for (int j = 0; j < count && !offered; j++) {
+            offered = strcmp(matches[j].word, found[i].word) == 0;
         }
+        if (!offered) {
+            BKTree_AddMatch(matches, &count, SUGGESTION_MAX_RESULTS, found[i].word, found[i].distance);
+        }
+    }
+    return count;
+}
+
+// Point originals[] at the ranked suggestions for word, from the cache when
+// it holds a list for the current generation and computed (then cached)
+// otherwise. The pointers stay valid while sc->lock is held.
+static int FindSuggestionsNoLock(SpellChecker *sc, const char *word, const char **originals) {
+    char key[SUGGESTION_CACHE_KEY_MAX];
+    SuggestionCache_MakeKey(word, key);
+    
+    const SuggestionCacheEntry *cached = SuggestionCache_Find(&sc->suggestionCache, key, sc->generation);
+    if (cached) {
+        const char *p = cached->results;
+        for (int i = 0; i < cached->count; i++) {
+            originals[i] = p;
+            p += strlen(p) + 1;
+        }
+        return cached->count;
+    }
+    
+    // Top candidates ranked by distance, then alphabetically
+    LONGLONG start = PerfStats_Start();
+    BKTreeMatch matches[SUGGESTION_MAX_RESULTS];
+    int suggestCount;
+    if (sc->suggestionIndex.count > 0 && !sc->suggestionIndex.incomplete) {
+        suggestCount = BKTree_Query(&sc->suggestionIndex, word, SUGGESTION_MAX_DISTANCE,
+                                    matches, SUGGESTION_MAX_RESULTS);
+    } else {
+        suggestCount = ScanDictionariesForSuggestions(sc, word, matches, SUGGESTION_MAX_RESULTS);
+    }
+    for (int i = 0; i < sc->layerCount; i++) {
+        suggestCount = MergeLayerSuggestions(&sc->layers[i], word, matches, suggestCount);
     }
     
-    // Limit to top 5 suggestions
-    if (suggestCount > 5) suggestCount = 5;
+    for (int i = 0; i < suggestCount; i++) {
+        originals[i] = OriginalForm(matches[i].word);
+    }
+    // A failed store only costs a recomputation next time
+    SuggestionCache_Store(&sc->suggestionCache, key, sc->generation, originals, suggestCount);
+    PerfStats_Stop(PERF_SUGGEST, start);
+    return suggestCount;
+}
+
+// Get suggestions for a misspelled word
+char** SpellChecker_GetSuggestions(SpellChecker *sc, const char *word, int *count) {
+    if (!sc || !word || !count) return NULL;
+    
+    *count = 0;
+    
+    // Suggestions point into the cache or dictionary storage, so hold the
+    // lock until copied
+    const char *originals[SUGGESTION_MAX_RESULTS];
+    AcquireSRWLockExclusive(&sc->lock);
+    int suggestCount = FindSuggestionsNoLock(sc, word, originals);
     
     // Convert to result array
     char **result = (char **)malloc((suggestCount + 1) * sizeof(char *));
     if (!result) {
-        free(suggestions);
+        ReleaseSRWLockExclusive(&sc->lock);
         return NULL;
     }
     
     for (int i = 0; i < suggestCount; i++) {
-        int len = strlen(suggestions[i].word);
+        int len = strlen(originals[i]);
         result[i] = (char *)malloc(len + 1);
         if (!result[i]) {
             for (int j = 0; j < i; j++) free(result[j]);
             free(result);
-            free(suggestions);
+            ReleaseSRWLockExclusive(&sc->lock);
             return NULL;
         }
-        strcpy(result[i], suggestions[i].word);
+        strcpy(result[i], originals[i]);
     }
     result[suggestCount] = NULL;
+    ReleaseSRWLockExclusive(&sc->lock);
     
-    free(suggestions);
     *count = suggestCount;
     return result;
 }
 
+void SpellChecker_PrefetchSuggestions(SpellChecker *sc, const char *word) {
+    if (!sc || !word || !word[0]) return;
+    
+    const char *originals[SUGGESTION_MAX_RESULTS];
+    AcquireSRWLockExclusive(&sc->lock);
+    FindSuggestionsNoLock(sc, word, originals);
+    ReleaseSRWLockExclusive(&sc->lock);
+}
+
+void SpellChecker_GetVerdictCacheStats(SpellChecker *sc, DWORD *hits, DWORD *misses) {
+    if (!sc) return;
+    
+    AcquireSRWLockExclusive(&sc->lock);
+    if (hits) *hits = sc->verdictCache.hits;
+    if (misses) *misses = sc->verdictCache.misses;
+    ReleaseSRWLockExclusive(&sc->lock);
+}
+
+void SpellChecker_GetStats(SpellChecker *sc, SpellCheckerStats *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(SpellCheckerStats));
+    if (sc) {
+        AcquireSRWLockExclusive(&sc->lock);
+        stats->lastCheckTime = sc->lastCheckTime;
+        stats->verdictHits = sc->verdictCache.hits;
+        stats->verdictMisses = sc->verdictCache.misses;
+        ReleaseSRWLockExclusive(&sc->lock);
+    }
+    for (int m = 0; m < PERF_METRIC_COUNT; m++) {
+        PerfStats_Summarize((PerfMetric)m, &stats->timings[m]);
+    }
+}
+
 // Free suggestions array
 void SpellChecker_FreeSuggestions(char **suggestions, int count) {
     if (!suggestions) return;
@@ -408,101 +1395,131 @@ MisspelledWordList* SpellChecker_GetMisspelledWords(SpellChecker *sc) {
 BOOL SpellChecker_IsMisspelledAtPosition(SpellChecker *sc, DWORD pos, char *outWord, int outWordLen) {
     if (!sc) return FALSE;
     
-    for (int i = 0; i < sc->misspelled.count; i++) {
-        if (pos >= sc->misspelled.words[i].startPos && pos < sc->misspelled.words[i].endPos) {
-            if (outWord && outWordLen > 0) {
-                strncpy(outWord, sc->misspelled.words[i].word, outWordLen - 1);
-                outWord[outWordLen - 1] = '\0';
-            }
-            return TRUE;
+    int index = SpellChecker_FindMisspelledAt(&sc->misspelled, pos);
+    if (index < 0) return FALSE;
+    
+    if (outWord && outWordLen > 0) {
+        strncpy(outWord, SpellChecker_MisspelledText(&sc->misspelled, index), outWordLen - 1);
+        outWord[outWordLen - 1] = '\0';
+    }
+    return TRUE;
+}
+
+// Binary search; lists are built in text order and spans never overlap
+int SpellChecker_FindMisspelledAt(const MisspelledWordList *list, DWORD pos) {
+    if (!list) return -1;
+    
+    int lo = 0, hi = list->count - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        const MisspelledWord *mw = &list->words[mid];
+        if (pos < mw->startPos) hi = mid - 1;
+        else if (pos >= mw->endPos) lo = mid + 1;
+        else return mid;
+    }
+    return -1;
+}
+
+// Rewrite the user dictionary sorted and deduplicated (caller holds sc->lock).
+// Written to a temp file that then replaces it, so a failed or interrupted
+// write leaves the old file, with every word added so far, in place.
+static BOOL WriteUserDictionary(SpellChecker *sc, const char *filePath) {
+    char tempPath[MAX_PATH + 4];
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", filePath);
+    FILE *file = fopen(tempPath, "w");
+    if (!file) return FALSE;
+    
+    for (int i = 0; i < sc->userDictionary.count; i++) {
+        fprintf(file, "%s\n", OriginalForm(sc->userDictionary.words[i]));
+    }
+    BOOL ok = fflush(file) == 0 && !ferror(file);
+    if (fclose(file) != 0) ok = FALSE;
+    if (!ok || !MoveFileEx(tempPath, filePath, MOVEFILE_REPLACE_EXISTING)) {
+        DeleteFile(tempPath);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+// Persist one addition by appending it to the journal (caller holds sc->lock)
+static void JournalUserWord(SpellChecker *sc, const char *key) {
+    if (!sc->userDictionaryPath[0]) return;
+    
+    sc->userJournalCount++;
+    if (sc->userJournalCount >= USER_JOURNAL_COMPACT_LIMIT) {
+        if (WriteUserDictionary(sc, sc->userDictionaryPath)) {
+            sc->userJournalCount = 0;
         }
+        return;
     }
     
-    return FALSE;
+    FILE *file = fopen(sc->userDictionaryPath, "a");
+    if (!file) return;
+    fprintf(file, "%s\n", OriginalForm(key));
+    fclose(file);
+}
+
+// Add word to user dictionary (caller holds sc->lock)
+static void AddUserWord(SpellChecker *sc, const char *word) {
+    char *key = InsertSortedWord(sc, &sc->userDictionary, word, DICT_TAG_USER);
+    if (key) {
+        JournalUserWord(sc, key);
+    }
 }
 
 // Add word to user dictionary
 void SpellChecker_AddToUserDictionary(SpellChecker *sc, const char *word) {
     if (!sc || !word) return;
     
-    // Check if already in user dictionary
-    if (BinarySearchDictionary(&sc->userDictionary, word)) return;
-    
-    if (sc->userDictionary.count >= sc->userDictionary.capacity) {
-        sc->userDictionary.capacity *= 2;
-        char **newWords = (char **)realloc(sc->userDictionary.words,
-                                          sc->userDictionary.capacity * sizeof(char *));
-        if (!newWords) return;
-        sc->userDictionary.words = newWords;
-    }
-    
-    int len = strlen(word);
-    sc->userDictionary.words[sc->userDictionary.count] = (char *)malloc(len + 1);
-    if (!sc->userDictionary.words[sc->userDictionary.count]) return;
-    
-    strcpy(sc->userDictionary.words[sc->userDictionary.count], word);
-    sc->userDictionary.count++;
-    
-    // Re-sort the user dictionary to maintain sorted order for binary search
-    if (sc->userDictionary.count > 0) {
-        qsort(sc->userDictionary.words, sc->userDictionary.count, sizeof(char *), DictionaryComparator);
-    }
+    AcquireSRWLockExclusive(&sc->lock);
+    AddUserWord(sc, word);
+    sc->generation++;  // The new word can now be suggested
+    ReleaseSRWLockExclusive(&sc->lock);
 }
 
-// Save user dictionary to file
+// Save user dictionary to file, compacting the journal. Additions are
+// already on disk, so this only rewrites when there is something to fold in
+// or the target is not the journal itself.
 void SpellChecker_SaveUserDictionary(SpellChecker *sc, const char *filePath) {
     if (!sc || !filePath) return;
     
-    FILE *file = fopen(filePath, "w");
-    if (!file) return;
-    
-    // Ensure sorted before saving
-    if (sc->userDictionary.count > 0) {
-        qsort(sc->userDictionary.words, sc->userDictionary.count, sizeof(char *), DictionaryComparator);
-    }
-    
-    for (int i = 0; i < sc->userDictionary.count; i++) {
-        fprintf(file, "%s\n", sc->userDictionary.words[i]);
+    AcquireSRWLockExclusive(&sc->lock);
+    BOOL isJournal = strcmp(filePath, sc->userDictionaryPath) == 0;
+    if (!isJournal || sc->userJournalCount > 0) {
+        if (WriteUserDictionary(sc, filePath) && isJournal) {
+            sc->userJournalCount = 0;
+        }
     }
-    
-    fclose(file);
+    ReleaseSRWLockExclusive(&sc->lock);
+}
+
+// Add word to ignore list (caller holds sc->lock)
+static void AddIgnoredWord(SpellChecker *sc, const char *word) {
+    InsertSortedWord(sc, &sc->ignoredWords, word, DICT_TAG_IGNORED);
 }
 
 // Add word to ignore list (session-only, not persisted)
 void SpellChecker_AddToIgnoreList(SpellChecker *sc, const char *word) {
     if (!sc || !word) return;
     
-    // Check if already in ignore list
-    if (BinarySearchDictionary(&sc->ignoredWords, word)) return;
-    
-    if (sc->ignoredWords.count >= sc->ignoredWords.capacity) {
-        sc->ignoredWords.capacity *= 2;
-        char **newWords = (char **)realloc(sc->ignoredWords.words,
-                                          sc->ignoredWords.capacity * sizeof(char *));
-        if (!newWords) return;
-        sc->ignoredWords.words = newWords;
-    }
-    
-    int len = strlen(word);
-    sc->ignoredWords.words[sc->ignoredWords.count] = (char *)malloc(len + 1);
-    if (!sc->ignoredWords.words[sc->ignoredWords.count]) return;
-    
-    strcpy(sc->ignoredWords.words[sc->ignoredWords.count], word);
-    sc->ignoredWords.count++;
-    
-    // Re-sort the ignore list to maintain sorted order for binary search
-    if (sc->ignoredWords.count > 0) {
-        qsort(sc->ignoredWords.words, sc->ignoredWords.count, sizeof(char *), DictionaryComparator);
-    }
+    AcquireSRWLockExclusive(&sc->lock);
+    AddIgnoredWord(sc, word);
+    ReleaseSRWLockExclusive(&sc->lock);
 }
 
 // Clear all ignored words (useful for starting a new session)
 void SpellChecker_ClearIgnoreList(SpellChecker *sc) {
     if (!sc) return;
     
-    for (int i = 0; i < sc->ignoredWords.count; i++) {
-        free(sc->ignoredWords.words[i]);
-    }
+    // Storage stays in the arena until Destroy: the hash table may still
+    // reference these keys, and ignore lists are small
+    AcquireSRWLockExclusive(&sc->lock);
     sc->ignoredWords.count = 0;
+    
+    if (sc->backend == DICTIONARY_BACKEND_HASH) {
+        WordTable_ClearTag(&sc->wordTable, DICT_TAG_IGNORED);
+    }
+    FlushVerdicts(sc);
+    ReleaseSRWLockExclusive(&sc->lock);
 }
 
@@ -2,46 +2,162 @@
 #define SPELLCHECKER_H
 
 #include <windows.h>
+#include "wordtable.h"
+#include "bktree.h"
+#include "stringarena.h"
+#include "dictbinary.h"
+#include "suggestioncache.h"
+#include "verdictcache.h"
+#include "perfstats.h"
 
+#define MAX_CHECKED_WORD 255           // Longer runs are checked in pieces
+#define MAX_MISSPELLED_TEXT (3 * MAX_CHECKED_WORD) // Bytes of the longest spelling in a list (a piece in UTF-8)
+
+// One flagged word: its span in the checked text and where its spelling is
+// kept in the owning list's pool (SpellChecker_MisspelledText)
 typedef struct {
     DWORD startPos;
     DWORD endPos;
-    char word[256];
+    DWORD word;          // Offset into the list's pool
 } MisspelledWord;
 
+// Entries in text order. Each distinct spelling is stored once in pool, so
+// a text full of the same unknown token costs 12 bytes per repeat. A full
+// pass empties the pool; range re-checks add to it, and rebuild it from the
+// live entries once it has doubled.
 typedef struct {
     MisspelledWord *words;
     int count;
     int capacity;
+    char *pool;          // NUL-terminated spellings
+    DWORD poolUsed;
+    DWORD poolCapacity;
+    DWORD poolCompacted; // poolUsed when the pool was last emptied or rebuilt
+    DWORD *slots;        // Intern table over pool: offset + 1, 0 = empty
+    DWORD slotCapacity;  // Power of two
+    DWORD slotsUsed;
 } MisspelledWordList;
 
+// Spelling of entry index; valid until the list is next changed
+static __inline const char* SpellChecker_MisspelledText(const MisspelledWordList *list, int index) {
+    return list->pool + list->words[index].word;
+}
+
+// One buffer for SpellChecker_CheckDocuments; list receives its results.
+// A document with wideText set is UTF-16 (text is ignored, len counts
+// WCHARs) and is checked like SpellChecker_CheckIntoW.
 typedef struct {
-    char **words;
+    const char *text;
+    DWORD len;
+    MisspelledWordList list;
+    const WCHAR *wideText;
+} SpellCheckDocument;
+
+typedef struct {
+    char **words;        // Sorted lowercased keys; original spelling follows each key
     int count;
     int capacity;
+    StringArena arena;   // Owns every key/original pair
 } Dictionary;
 
+// Lookup engine selected at creation time
+typedef enum {
+    DICTIONARY_BACKEND_SORTED_ARRAY, // Binary search over each sorted list
+    DICTIONARY_BACKEND_HASH          // One hash probe covering all lists
+} DictionaryBackend;
+
+// Read-only dictionaries (the language dictionary, then team or domain word
+// lists) are stacked as layers under the private user dictionary and ignore
+// list, and one lookup consults them all
+#define SPELLCHECKER_MAX_LAYERS 8
+
+// All entry points are safe to call from any thread: dictionary state is
+// guarded by 'lock', which checks take one batch of words at a time so other
+// callers are not held up for a whole pass. 'misspelled' belongs to the
+// thread driving the *_Check wrappers; background checks should use the
+// *Into variants with their own list.
 typedef struct {
+    SRWLOCK lock;                 // Not recursive
     BOOL enabled;
     BOOL suggestionsEnabled;
-    Dictionary mainDictionary;
+    DictionaryBackend backend;
+    WordTable wordTable;          // Used by DICTIONARY_BACKEND_HASH
+    Dictionary mainDictionary;    // Read-only words that couldn't be shared
+    DictBinary layers[SPELLCHECKER_MAX_LAYERS]; // Shared read-only dictionaries, used in place
+    int layerCount;
     Dictionary userDictionary;
+    char userDictionaryPath[MAX_PATH]; // Journal that additions are appended to
+    int userJournalCount;         // Entries appended since the file was last rewritten
     Dictionary ignoredWords;
+    BKTree suggestionIndex;       // Private words, built as they load (layers carry their own)
+    DWORD generation;             // Bumped whenever the suggestible word set changes
+    SuggestionCache suggestionCache; // Recent suggestion lists, valid for one generation
+    VerdictCache verdictCache;    // Recent correct/misspelled answers, flushed when a list changes
+    DWORD listVersion;            // Bumped with each flush, for the caches of parallel checks
     MisspelledWordList misspelled;
-    DWORD lastCheckTime;
+    DWORD lastCheckTime;          // Milliseconds the most recent full or range check took
 } SpellChecker;
 
+// Snapshot for diagnostics: this checker's state plus the process-wide
+// timings from perfstats.h
+typedef struct {
+    DWORD lastCheckTime;
+    DWORD verdictHits;
+    DWORD verdictMisses;
+    PerfSummary timings[PERF_METRIC_COUNT];
+} SpellCheckerStats;
+
 // Initialization and cleanup
-SpellChecker* SpellChecker_Create(void);
+SpellChecker* SpellChecker_Create(DictionaryBackend backend);
 void SpellChecker_Destroy(SpellChecker *sc);
 BOOL SpellChecker_LoadDictionary(SpellChecker *sc, const char *filePath);
 BOOL SpellChecker_LoadUserDictionary(SpellChecker *sc, const char *filePath);
 
+// Stack another read-only word list (team or domain terms, same format as
+// dictionary.txt) on the main dictionary. Like the main dictionary it is
+// mapped from its compiled image, or compiled once and published, under a
+// name every Logger in the session shares; only if that fails is it loaded
+// privately.
+BOOL SpellChecker_AddDictionary(SpellChecker *sc, const char *filePath);
+
+// Build the compiled image SpellChecker_LoadDictionary prefers over the text
+// file (dictionary.txt -> dictionary.bin)
+BOOL SpellChecker_CompileDictionary(const char *textPath, const char *binPath);
+
 // Spell checking
 void SpellChecker_Check(SpellChecker *sc, const char *text);
+void SpellChecker_CheckRange(SpellChecker *sc, const char *text, DWORD editStart, DWORD oldLen, DWORD newLen);
+void SpellChecker_CheckInto(SpellChecker *sc, const char *text, MisspelledWordList *list);
+// Same result as CheckInto for text[0, len) (no NUL needed, e.g. a mapped
+// file), with large texts split at word boundaries and checked on the
+// Windows thread pool.
+void SpellChecker_CheckParallelInto(SpellChecker *sc, const char *text, DWORD len, MisspelledWordList *list);
+
+// Check many buffers in one pool run: small documents are one chunk each,
+// big ones are split. maxThreads 0 means one thread per processor. Words
+// added or ignored meanwhile count from the next batch each thread checks.
+void SpellChecker_CheckDocuments(SpellChecker *sc, SpellCheckDocument *docs, int docCount, int maxThreads);
+void SpellChecker_CheckRangeInto(SpellChecker *sc, const char *text, DWORD editStart, DWORD oldLen, DWORD newLen,
+                                 MisspelledWordList *list);
+void SpellChecker_ComputeEditRange(const char *oldText, int oldTextLen, const char *newText, int newTextLen,
+                                   DWORD *editStart, DWORD *oldLen, DWORD *newLen);
+
+// UTF-16 counterparts for text straight from a Unicode edit control. Words
+// are runs of Tokenizer_IsLetterW and are looked up as case-folded UTF-8;
+// positions count WCHARs, so they are the control's character indexes.
+// Spellings in the list are UTF-8.
+void SpellChecker_CheckIntoW(SpellChecker *sc, const WCHAR *text, DWORD len, MisspelledWordList *list);
+void SpellChecker_CheckParallelIntoW(SpellChecker *sc, const WCHAR *text, DWORD len, MisspelledWordList *list);
+void SpellChecker_CheckRangeIntoW(SpellChecker *sc, const WCHAR *text, DWORD len, DWORD editStart, DWORD oldLen,
+                                  DWORD newLen, MisspelledWordList *list);
+void SpellChecker_ComputeEditRangeW(const WCHAR *oldText, int oldTextLen, const WCHAR *newText, int newTextLen,
+                                    DWORD *editStart, DWORD *oldLen, DWORD *newLen);
+
+// word is UTF-8; letters outside ASCII are folded like dictionary keys
 BOOL SpellChecker_IsWordCorrect(SpellChecker *sc, const char *word);
 
-// User dictionary management
+// User dictionary management. Additions are appended to the file passed to
+// SpellChecker_LoadUserDictionary immediately; Save compacts it.
 void SpellChecker_AddToUserDictionary(SpellChecker *sc, const char *word);
 void SpellChecker_SaveUserDictionary(SpellChecker *sc, const char *filePath);
 
@@ -53,8 +169,27 @@ void SpellChecker_ClearIgnoreList(SpellChecker *sc);
 char** SpellChecker_GetSuggestions(SpellChecker *sc, const char *word, int *count);
 void SpellChecker_FreeSuggestions(char **suggestions, int count);
 
+// Compute and cache suggestions for word ahead of a GetSuggestions call
+// (e.g. from a background thread right after the word is flagged)
+void SpellChecker_PrefetchSuggestions(SpellChecker *sc, const char *word);
+
+// Verdict cache effectiveness since creation: lookups answered from the
+// cache vs. ones that probed the dictionaries
+void SpellChecker_GetVerdictCacheStats(SpellChecker *sc, DWORD *hits, DWORD *misses);
+
+// Everything above plus load, check and suggestion latencies
+void SpellChecker_GetStats(SpellChecker *sc, SpellCheckerStats *stats);
+
 // Query results
 MisspelledWordList* SpellChecker_GetMisspelledWords(SpellChecker *sc);
 BOOL SpellChecker_IsMisspelledAtPosition(SpellChecker *sc, DWORD pos, char *outWord, int outWordLen);
 
+// Index of the entry covering character pos, or -1. Lists are kept sorted
+// by startPos, so this is O(log n).
+int SpellChecker_FindMisspelledAt(const MisspelledWordList *list, DWORD pos);
+
+// Misspelled list helpers for callers that own their own lists
+void SpellChecker_FreeMisspelledList(MisspelledWordList *list);
+BOOL SpellChecker_CopyMisspelledList(MisspelledWordList *dst, const MisspelledWordList *src);
+
 #endif // SPELLCHECKER_H
@@ -0,0 +1,187 @@
+#include "spellworker.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define SPELLWORKER_PREFETCH_LIMIT 16  // Suggestion lists warmed per snapshot (well under the cache size)
+
+struct SpellWorker {
+    SpellChecker *sc;
+    HWND hwndNotify;
+    UINT notifyMsg;
+    HANDLE thread;
+    HANDLE wakeEvent;
+    
+    // Pending snapshot, guarded by queueLock
+    CRITICAL_SECTION queueLock;
+    WCHAR *pendingText;
+    int pendingLen;
+    DWORD pendingGeneration;
+    BOOL pendingFullPass;
+    BOOL stopRequested;
+    
+    // Worker-thread private state: the last checked text and its results,
+    // used as the baseline for incremental re-checks
+    WCHAR *baselineText;
+    int baselineLen;
+    MisspelledWordList baseline;
+};
+
+static BOOL HasPendingWork(SpellWorker *worker) {
+    EnterCriticalSection(&worker->queueLock);
+    BOOL pending = worker->pendingText != NULL || worker->stopRequested;
+    LeaveCriticalSection(&worker->queueLock);
+    return pending;
+}
+
+// Warm the suggestion cache for flagged words touching [from, to] so the
+// context menu opens without a search. Newer snapshots take priority.
+static void PrefetchSuggestions(SpellWorker *worker, DWORD from, DWORD to) {
+    if (!worker->sc->suggestionsEnabled) return;
+    
+    int fetched = 0;
+    for (int i = 0; i < worker->baseline.count && fetched < SPELLWORKER_PREFETCH_LIMIT; i++) {
+        const MisspelledWord *word = &worker->baseline.words[i];
+        if (word->endPos < from) continue;
+        if (word->startPos > to || HasPendingWork(worker)) break;
+        SpellChecker_PrefetchSuggestions(worker->sc, SpellChecker_MisspelledText(&worker->baseline, i));
+        fetched++;
+    }
+}
+
+static void CheckSnapshot(SpellWorker *worker, WCHAR *text, int textLen, DWORD generation, BOOL fullPass) {
+    // Span whose flagged words may be new to the user
+    DWORD changedFrom = 0, changedTo = (DWORD)textLen;
+    
+    if (worker->baselineText && !fullPass) {
+        DWORD editStart, oldLen, newLen;
+        SpellChecker_ComputeEditRangeW(worker->baselineText, worker->baselineLen, text, textLen,
+                                      &editStart, &oldLen, &newLen);
+        if (oldLen != 0 || newLen != 0) {
+            SpellChecker_CheckRangeIntoW(worker->sc, text, (DWORD)textLen, editStart, oldLen, newLen,
+                                         &worker->baseline);
+        }
+        changedFrom = editStart;
+        changedTo = editStart + newLen;
+    } else {
+        // Full passes over big buffers (View mode pages, pasted logs) fan out
+        SpellChecker_CheckParallelIntoW(worker->sc, text, (DWORD)textLen, &worker->baseline);
+    }
+    
+    free(worker->baselineText);
+    worker->baselineText = text;
+    worker->baselineLen = textLen;
+    
+    // Post a private copy; the UI thread swaps it in if it is still current
+    SpellCheckResult *result = (SpellCheckResult *)calloc(1, sizeof(SpellCheckResult));
+    if (!result) return;
+    result->generation = generation;
+    if (!SpellChecker_CopyMisspelledList(&result->list, &worker->baseline) ||
+        !PostMessage(worker->hwndNotify, worker->notifyMsg, (WPARAM)generation, (LPARAM)result)) {
+        SpellWorker_FreeResult(result);
+        return;
+    }
+    
+    PrefetchSuggestions(worker, changedFrom, changedTo);
+}
+
+static DWORD WINAPI SpellWorkerThread(LPVOID param) {
+    SpellWorker *worker = (SpellWorker *)param;
+    
+    for (;;) {
+        WaitForSingleObject(worker->wakeEvent, INFINITE);
+        
+        EnterCriticalSection(&worker->queueLock);
+        BOOL stop = worker->stopRequested;
+        WCHAR *text = worker->pendingText;
+        int textLen = worker->pendingLen;
+        DWORD generation = worker->pendingGeneration;
+        BOOL fullPass = worker->pendingFullPass;
+        worker->pendingText = NULL;
+        worker->pendingFullPass = FALSE;
+        LeaveCriticalSection(&worker->queueLock);
+        
+        if (stop) {
+            free(text);
+            break;
+        }
+        if (text) {
+            CheckSnapshot(worker, text, textLen, generation, fullPass);
+        }
+    }
+    
+    return 0;
+}
+
+SpellWorker* SpellWorker_Start(SpellChecker *sc, HWND hwndNotify, UINT notifyMsg) {
+    if (!sc || !hwndNotify) return NULL;
+    
+    SpellWorker *worker = (SpellWorker *)calloc(1, sizeof(SpellWorker));
+    if (!worker) return NULL;
+    
+    worker->sc = sc;
+    worker->hwndNotify = hwndNotify;
+    worker->notifyMsg = notifyMsg;
+    InitializeCriticalSection(&worker->queueLock);
+    
+    // Auto-reset: one wake per batch of submissions
+    worker->wakeEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+    if (!worker->wakeEvent) {
+        DeleteCriticalSection(&worker->queueLock);
+        free(worker);
+        return NULL;
+    }
+    
+    worker->thread = CreateThread(NULL, 0, SpellWorkerThread, worker, 0, NULL);
+    if (!worker->thread) {
+        CloseHandle(worker->wakeEvent);
+        DeleteCriticalSection(&worker->queueLock);
+        free(worker);
+        return NULL;
+    }
+    
+    return worker;
+}
+
+void SpellWorker_Stop(SpellWorker *worker) {
+    if (!worker) return;
+    
+    EnterCriticalSection(&worker->queueLock);
+    worker->stopRequested = TRUE;
+    LeaveCriticalSection(&worker->queueLock);
+    SetEvent(worker->wakeEvent);
+    
+    WaitForSingleObject(worker->thread, INFINITE);
+    CloseHandle(worker->thread);
+    CloseHandle(worker->wakeEvent);
+    DeleteCriticalSection(&worker->queueLock);
+    
+    free(worker->pendingText);
+    free(worker->baselineText);
+    SpellChecker_FreeMisspelledList(&worker->baseline);
+    free(worker);
+}
+
+BOOL SpellWorker_Submit(SpellWorker *worker, WCHAR *text, int textLen, DWORD generation, BOOL fullPass) {
+    if (!worker || !text) {
+        free(text);
+        return FALSE;
+    }
+    
+    EnterCriticalSection(&worker->queueLock);
+    // An unchecked older snapshot is superseded; its dictionary-change flag carries over
+    free(worker->pendingText);
+    worker->pendingText = text;
+    worker->pendingLen = textLen;
+    worker->pendingGeneration = generation;
+    worker->pendingFullPass = worker->pendingFullPass || fullPass;
+    LeaveCriticalSection(&worker->queueLock);
+    
+    SetEvent(worker->wakeEvent);
+    return TRUE;
+}
+
+void SpellWorker_FreeResult(SpellCheckResult *result) {
+    if (!result) return;
+    SpellChecker_FreeMisspelledList(&result->list);
+    free(result);
+}
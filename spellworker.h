@@ -0,0 +1,32 @@
+#ifndef SPELLWORKER_H
+#define SPELLWORKER_H
+
+#include <windows.h>
+#include "spellchecker.h"
+
+// Result posted back to the UI thread as notifyMsg with
+// wParam = generation and lParam = SpellCheckResult*.
+// The receiver owns the result and releases it with SpellWorker_FreeResult.
+typedef struct {
+    DWORD generation;
+    MisspelledWordList list;
+} SpellCheckResult;
+
+typedef struct SpellWorker SpellWorker;
+
+// Start the checker thread; results are posted to hwndNotify
+SpellWorker* SpellWorker_Start(SpellChecker *sc, HWND hwndNotify, UINT notifyMsg);
+
+// Stop the thread and release any queued snapshot
+void SpellWorker_Stop(SpellWorker *worker);
+
+// Queue a snapshot for checking. Takes ownership of text (malloc'd UTF-16
+// from the edit control, NUL terminated); result positions are character
+// indexes into it. A snapshot still waiting in the queue is replaced, so only
+// the newest generation is ever checked. fullPass discards the worker's
+// incremental baseline (e.g. after a dictionary change).
+BOOL SpellWorker_Submit(SpellWorker *worker, WCHAR *text, int textLen, DWORD generation, BOOL fullPass);
+
+void SpellWorker_FreeResult(SpellCheckResult *result);
+
+#endif // SPELLWORKER_H
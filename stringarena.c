@@ -0,0 +1,68 @@
+#include "stringarena.h"
+#include <stdlib.h>
+
+#define ARENA_BLOCK_SIZE 4096
+
+static ArenaBlock *NewBlock(size_t size) {
+    ArenaBlock *block = (ArenaBlock *)malloc(sizeof(ArenaBlock) + size);
+    if (!block) return NULL;
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+    return block;
+}
+
+char *StringArena_Alloc(StringArena *arena, size_t n) {
+    if (!arena) return NULL;
+    
+    ArenaBlock *block = arena->head;
+    if (!block || block->size - block->used < n) {
+        // Oversized requests get their own block behind the current one so
+        // the partially filled block keeps serving small allocations
+        if (n > ARENA_BLOCK_SIZE / 4 && block) {
+            ArenaBlock *big = NewBlock(n);
+            if (!big) return NULL;
+            big->used = n;
+            big->next = block->next;
+            block->next = big;
+            return big->data;
+        }
+        
+        block = NewBlock(n > ARENA_BLOCK_SIZE ? n : ARENA_BLOCK_SIZE);
+        if (!block) return NULL;
+        block->next = arena->head;
+        arena->head = block;
+    }
+    
+    char *p = block->data + block->used;
+    block->used += n;
+    return p;
+}
+
+char *StringArena_AllocBlock(StringArena *arena, size_t n) {
+    if (!arena) return NULL;
+    
+    ArenaBlock *block = NewBlock(n);
+    if (!block) return NULL;
+    block->used = n;
+    
+    // Keep the head as the block serving small allocations
+    if (arena->head) {
+        block->next = arena->head->next;
+        arena->head->next = block;
+    } else {
+        arena->head = block;
+    }
+    return block->data;
+}
+
+void StringArena_Free(StringArena *arena) {
+    if (!arena) return;
+    ArenaBlock *block = arena->head;
+    while (block) {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->head = NULL;
+}
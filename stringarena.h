@@ -0,0 +1,28 @@
+#ifndef STRINGARENA_H
+#define STRINGARENA_H
+
+#include <stddef.h>
+
+// Chained-block string pool. Allocations are never freed individually and
+// never move, so pointers into the arena stay valid until StringArena_Free.
+typedef struct ArenaBlock {
+    struct ArenaBlock *next;
+    size_t size;
+    size_t used;
+    char data[1];
+} ArenaBlock;
+
+typedef struct {
+    ArenaBlock *head;
+} StringArena;
+
+// Allocate n bytes from the current block, starting a new one when full
+char *StringArena_Alloc(StringArena *arena, size_t n);
+
+// Allocate a dedicated block of exactly n bytes (e.g. a whole file's contents)
+char *StringArena_AllocBlock(StringArena *arena, size_t n);
+
+// Release every block with one call
+void StringArena_Free(StringArena *arena);
+
+#endif // STRINGARENA_H
@@ -0,0 +1,76 @@
+#include "suggestioncache.h"
+#include <stdlib.h>
+#include <string.h>
+
+void SuggestionCache_Free(SuggestionCache *cache) {
+    if (!cache) return;
+    for (int i = 0; i < SUGGESTION_CACHE_SIZE; i++) {
+        free(cache->entries[i].results);
+    }
+    memset(cache, 0, sizeof(SuggestionCache));
+}
+
+void SuggestionCache_MakeKey(const char *word, char *key) {
+    int i = 0;
+    for (; word[i] && i < SUGGESTION_CACHE_KEY_MAX - 1; i++) {
+        unsigned char c = (unsigned char)word[i];
+        key[i] = (char)((c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c);
+    }
+    key[i] = '\0';
+}
+
+static SuggestionCacheEntry *FindKey(SuggestionCache *cache, const char *key) {
+    for (int i = 0; i < SUGGESTION_CACHE_SIZE; i++) {
+        SuggestionCacheEntry *entry = &cache->entries[i];
+        if (entry->key[0] && strcmp(entry->key, key) == 0) return entry;
+    }
+    return NULL;
+}
+
+const SuggestionCacheEntry *SuggestionCache_Find(SuggestionCache *cache, const char *key, DWORD generation) {
+    if (!cache || !key || !key[0]) return NULL;
+    
+    SuggestionCacheEntry *entry = FindKey(cache, key);
+    if (!entry || entry->generation != generation) return NULL;
+    entry->lastUsed = ++cache->clock;
+    return entry;
+}
+
+BOOL SuggestionCache_Store(SuggestionCache *cache, const char *key, DWORD generation,
+                           const char * const *results, int count) {
+    if (!cache || !key || !key[0] || strlen(key) >= SUGGESTION_CACHE_KEY_MAX) return FALSE;
+    
+    size_t size = 0;
+    for (int i = 0; i < count; i++) {
+        size += strlen(results[i]) + 1;
+    }
+    char *block = (char *)malloc(size > 0 ? size : 1);
+    if (!block) return FALSE;
+    
+    char *p = block;
+    for (int i = 0; i < count; i++) {
+        size_t len = strlen(results[i]) + 1;
+        memcpy(p, results[i], len);
+        p += len;
+    }
+    
+    // Reuse the key's own slot, else a free one, else the oldest
+    SuggestionCacheEntry *slot = FindKey(cache, key);
+    for (int i = 0; !slot && i < SUGGESTION_CACHE_SIZE; i++) {
+        if (!cache->entries[i].key[0]) slot = &cache->entries[i];
+    }
+    if (!slot) {
+        slot = &cache->entries[0];
+        for (int i = 1; i < SUGGESTION_CACHE_SIZE; i++) {
+            if (cache->entries[i].lastUsed < slot->lastUsed) slot = &cache->entries[i];
+        }
+    }
+    
+    free(slot->results);
+    strcpy(slot->key, key);
+    slot->generation = generation;
+    slot->lastUsed = ++cache->clock;
+    slot->count = count;
+    slot->results = block;
+    return TRUE;
+}
@@ -0,0 +1,43 @@
+#ifndef SUGGESTIONCACHE_H
+#define SUGGESTIONCACHE_H
+
+#include <windows.h>
+
+#define SUGGESTION_CACHE_SIZE 64
+#define SUGGESTION_CACHE_KEY_MAX 256
+
+// One remembered suggestion list. results holds count NUL-terminated
+// strings back to back, so an entry costs a single allocation.
+typedef struct {
+    char key[SUGGESTION_CACHE_KEY_MAX];  // Lowercased word; "" marks a free slot
+    DWORD generation;    // Dictionary generation the results were computed for
+    DWORD lastUsed;      // Cache clock at the last hit, for LRU eviction
+    int count;
+    char *results;
+} SuggestionCacheEntry;
+
+// Small LRU of suggestion lists keyed on the lowercased word. The cache has
+// no lock of its own; callers serialize access (SpellChecker holds its lock).
+// Entries from an older dictionary generation are treated as misses and
+// recycled, so invalidation is just bumping the caller's generation.
+typedef struct {
+    SuggestionCacheEntry entries[SUGGESTION_CACHE_SIZE];
+    DWORD clock;
+} SuggestionCache;
+
+// Release every entry's results and empty the cache
+void SuggestionCache_Free(SuggestionCache *cache);
+
+// Lowercase word into key (truncating to SUGGESTION_CACHE_KEY_MAX - 1)
+void SuggestionCache_MakeKey(const char *word, char *key);
+
+// Entry for key computed under generation, or NULL. A hit refreshes its
+// LRU position.
+const SuggestionCacheEntry *SuggestionCache_Find(SuggestionCache *cache, const char *key, DWORD generation);
+
+// Remember results for key, replacing a stale entry for the same key or the
+// least recently used one. Returns FALSE if the copy could not be allocated.
+BOOL SuggestionCache_Store(SuggestionCache *cache, const char *key, DWORD generation,
+                           const char * const *results, int count);
+
+#endif // SUGGESTIONCACHE_H
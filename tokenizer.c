@@ -0,0 +1,424 @@
+#include "tokenizer.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define TOKENIZER_X86 1
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// gcc/clang only emit AVX2 inside functions that ask for it; MSVC always can
+#if defined(TOKENIZER_X86) && (defined(__GNUC__) || defined(__clang__))
+#define TOKENIZER_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TOKENIZER_TARGET_AVX2
+#endif
+
+#if defined(_MSC_VER)
+static __inline DWORD LowestBit(DWORD mask) {
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (DWORD)index;
+}
+#else
+#define LowestBit(mask) ((DWORD)__builtin_ctz(mask))
+#endif
+
+typedef int (*FindWordsFn)(const char *text, DWORD len, TokenSpan *spans, int maxSpans, DWORD *scanned);
+
+// Scan state shared by the block loops and the scalar tail
+typedef struct {
+    TokenSpan *spans;
+    int maxSpans;
+    int count;
+    BOOL inWord;
+    DWORD wordStart;
+} ScanState;
+
+// Walk the word start/end events of one block. letters has bit i set when
+// byte base + i is a letter. Returns FALSE once spans is full, with *stop
+// set to the start of the word that didn't fit.
+static __inline BOOL EmitBlock(ScanState *st, DWORD base, DWORD letters, DWORD blockMask, DWORD *stop) {
+    DWORD shifted = ((letters << 1) | (st->inWord ? 1u : 0u)) & blockMask;
+    DWORD starts = letters & ~shifted;
+    DWORD ends = ~letters & shifted & blockMask;
+    DWORD events = starts | ends;
+    
+    while (events) {
+        DWORD bit = LowestBit(events);
+        DWORD flag = 1u << bit;
+        if (starts & flag) {
+            if (st->count >= st->maxSpans) {
+                *stop = base + bit;
+                return FALSE;
+            }
+            st->wordStart = base + bit;
+            st->inWord = TRUE;
+        } else {
+            st->spans[st->count].start = st->wordStart;
+            st->spans[st->count].length = base + bit - st->wordStart;
+            st->count++;
+            st->inWord = FALSE;
+        }
+        events &= events - 1;
+    }
+    // Carry the last byte's class into the next block
+    st->inWord = (letters & (blockMask ^ (blockMask >> 1))) != 0;
+    return TRUE;
+}
+
+// Byte-at-a-time from pos to len; also the tail of the vector variants
+static int FinishScalar(ScanState *st, const char *text, DWORD pos, DWORD len, DWORD *scanned) {
+    for (; pos < len; pos++) {
+        BOOL letter = Tokenizer_IsLetter(text[pos]);
+        if (letter && !st->inWord) {
+            if (st->count >= st->maxSpans) {
+                *scanned = pos;
+                return st->count;
+            }
+            st->wordStart = pos;
+            st->inWord = TRUE;
+        } else if (!letter && st->inWord) {
+            st->spans[st->count].start = st->wordStart;
+            st->spans[st->count].length = pos - st->wordStart;
+            st->count++;
+            st->inWord = FALSE;
+        }
+    }
+    
+    // A word still open at len ends there. Words are only opened while
+    // count < maxSpans, so its slot is free.
+    if (st->inWord) {
+        st->spans[st->count].start = st->wordStart;
+        st->spans[st->count].length = len - st->wordStart;
+        st->count++;
+    }
+    *scanned = len;
+    return st->count;
+}
+
+static int FindWordsScalar(const char *text, DWORD len, TokenSpan *spans, int maxSpans, DWORD *scanned) {
+    ScanState st = { spans, maxSpans, 0, FALSE, 0 };
+    return FinishScalar(&st, text, 0, len, scanned);
+}
+
+#ifdef TOKENIZER_X86
+
+// Letter test on 16 bytes: (c | 0x20) - 'a' < 26 unsigned. SSE2 only has a
+// signed compare, so the range is biased to start at -128.
+static __inline DWORD LetterMask16(const char *p) {
+    __m128i v = _mm_loadu_si128((const __m128i *)p);
+    __m128i folded = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i biased = _mm_add_epi8(folded, _mm_set1_epi8((char)(128 - 'a')));
+    __m128i letters = _mm_cmplt_epi8(biased, _mm_set1_epi8((char)(-128 + 26)));
+    return (DWORD)_mm_movemask_epi8(letters);
+}
+
+static int FindWordsSSE2(const char *text, DWORD len, TokenSpan *spans, int maxSpans, DWORD *scanned) {
+    ScanState st = { spans, maxSpans, 0, FALSE, 0 };
+    DWORD pos = 0;
+    
+    for (; pos + 16 <= len; pos += 16) {
+        DWORD letters = LetterMask16(text + pos);
+        // Runs of spaces or of letters have no events to walk
+        if ((letters == 0 && !st.inWord) || (letters == 0xFFFF && st.inWord)) continue;
+        if (!EmitBlock(&st, pos, letters, 0xFFFF, scanned)) return st.count;
+    }
+    return FinishScalar(&st, text, pos, len, scanned);
+}
+
+TOKENIZER_TARGET_AVX2
+static int FindWordsAVX2(const char *text, DWORD len, TokenSpan *spans, int maxSpans, DWORD *scanned) {
+    ScanState st = { spans, maxSpans, 0, FALSE, 0 };
+    DWORD pos = 0;
+    const __m256i caseBit = _mm256_set1_epi8(0x20);
+    const __m256i bias = _mm256_set1_epi8((char)(128 - 'a'));
+    const __m256i limit = _mm256_set1_epi8((char)(-128 + 26));
+    
+    for (; pos + 32 <= len; pos += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(text + pos));
+        __m256i biased = _mm256_add_epi8(_mm256_or_si256(v, caseBit), bias);
+        DWORD letters = (DWORD)_mm256_movemask_epi8(_mm256_cmpgt_epi8(limit, biased));
+        if ((letters == 0 && !st.inWord) || (letters == 0xFFFFFFFFu && st.inWord)) continue;
+        if (!EmitBlock(&st, pos, letters, 0xFFFFFFFFu, scanned)) return st.count;
+    }
+    return FinishScalar(&st, text, pos, len, scanned);
+}
+
+static BOOL CpuHasSSE2(void) {
+#if defined(_M_X64) || defined(__x86_64__)
+    return TRUE;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    unsigned int a, b, c, d;
+    return __get_cpuid(1, &a, &b, &c, &d) && (d & bit_SSE2);
+#endif
+}
+
+// AVX2 needs the CPU feature and the OS saving YMM state (OSXSAVE + XCR0)
+static BOOL CpuHasAVX2(void) {
+    unsigned int ecx1, ebx7;
+    unsigned long long xcr0;
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return FALSE;
+    __cpuid(info, 1);
+    ecx1 = (unsigned int)info[2];
+    if (!(ecx1 & (1u << 27)) || !(ecx1 & (1u << 28))) return FALSE;
+    xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    ebx7 = (unsigned int)info[1];
+#else
+    unsigned int a, b, d, lo, hi;
+    if (__get_cpuid_max(0, NULL) < 7) return FALSE;
+    __cpuid(1, a, b, ecx1, d);
+    if (!(ecx1 & bit_OSXSAVE) || !(ecx1 & bit_AVX)) return FALSE;
+    __asm__ volatile ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    xcr0 = ((unsigned long long)hi << 32) | lo;
+    __cpuid_count(7, 0, a, ebx7, ecx1, d);
+#endif
+    return (xcr0 & 6) == 6 && (ebx7 & (1u << 5)) != 0;
+}
+
+#endif // TOKENIZER_X86
+
+static FindWordsFn g_findWords = NULL;
+static TokenizerKind g_kind = TOKENIZER_SCALAR;
+
+static BOOL KindSupported(TokenizerKind kind) {
+#ifdef TOKENIZER_X86
+    if (kind == TOKENIZER_AVX2) return CpuHasAVX2();
+    if (kind == TOKENIZER_SSE2) return CpuHasSSE2();
+#endif
+    return kind == TOKENIZER_SCALAR;
+}
+
+BOOL Tokenizer_SetKind(TokenizerKind kind) {
+    if (!KindSupported(kind)) return FALSE;
+    
+    switch (kind) {
+#ifdef TOKENIZER_X86
+    case TOKENIZER_AVX2: g_findWords = FindWordsAVX2; break;
+    case TOKENIZER_SSE2: g_findWords = FindWordsSSE2; break;
+#endif
+    default:             g_findWords = FindWordsScalar; break;
+    }
+    g_kind = kind;
+    return TRUE;
+}
+
+void Tokenizer_Init(void) {
+    if (g_findWords) return;
+    if (!Tokenizer_SetKind(TOKENIZER_AVX2) && !Tokenizer_SetKind(TOKENIZER_SSE2)) {
+        Tokenizer_SetKind(TOKENIZER_SCALAR);
+    }
+}
+
+TokenizerKind Tokenizer_GetKind(void) {
+    Tokenizer_Init();
+    return g_kind;
+}
+
+int Tokenizer_FindWords(const char *text, DWORD len, TokenSpan *spans, int maxSpans, DWORD *scanned) {
+    DWORD ignored;
+    if (!scanned) scanned = &ignored;
+    *scanned = 0;
+    if (!text || !spans || maxSpans <= 0) return 0;
+    
+    Tokenizer_Init();
+    return g_findWords(text, len, spans, maxSpans, scanned);
+}
+
+// Letters outside ASCII, sorted: Latin, Greek, Cyrillic, Armenian, Hebrew,
+// Arabic and Georgian, with the combining diacritics that decomposed
+// accents are written with
+static const WCHAR g_wideLetters[][2] = {
+    { 0x00AA, 0x00AA }, { 0x00B5, 0x00B5 }, { 0x00BA, 0x00BA },
+    { 0x00C0, 0x00D6 }, { 0x00D8, 0x00F6 }, { 0x00F8, 0x02C1 },  // Latin-1, Extended-A/B, IPA
+    { 0x02C6, 0x02D1 }, { 0x02E0, 0x02E4 },
+    { 0x0300, 0x036F },                                          // Combining diacritics
+    { 0x0370, 0x0374 }, { 0x0376, 0x0377 }, { 0x037A, 0x037D },  // Greek
+    { 0x037F, 0x037F }, { 0x0386, 0x0386 }, { 0x0388, 0x038A },
+    { 0x038C, 0x038C }, { 0x038E, 0x03A1 }, { 0x03A3, 0x03F5 },
+    { 0x03F7, 0x0481 }, { 0x0483, 0x052F },                      // Cyrillic
+    { 0x0531, 0x0556 }, { 0x0559, 0x0559 }, { 0x0560, 0x0588 },  // Armenian
+    { 0x0591, 0x05BD }, { 0x05BF, 0x05BF }, { 0x05C1, 0x05C2 },  // Hebrew
+    { 0x05C4, 0x05C5 }, { 0x05C7, 0x05C7 }, { 0x05D0, 0x05EA },
+    { 0x05EF, 0x05F2 },
+    { 0x0610, 0x061A }, { 0x0620, 0x065F }, { 0x066E, 0x06D3 },  // Arabic
+    { 0x06D5, 0x06DC }, { 0x06DF, 0x06E8 }, { 0x06EA, 0x06FC },
+    { 0x06FF, 0x06FF },
+    { 0x10A0, 0x10C5 }, { 0x10C7, 0x10C7 }, { 0x10CD, 0x10CD },  // Georgian
+    { 0x10D0, 0x10FA }, { 0x10FC, 0x10FF },
+    { 0x1AB0, 0x1AFF }, { 0x1DC0, 0x1DFF },                      // More combining marks
+    { 0x1E00, 0x1F15 }, { 0x1F18, 0x1F1D }, { 0x1F20, 0x1F45 },  // Latin Additional, Greek Extended
+    { 0x1F48, 0x1F4D }, { 0x1F50, 0x1F57 }, { 0x1F59, 0x1F59 },
+    { 0x1F5B, 0x1F5B }, { 0x1F5D, 0x1F5D }, { 0x1F5F, 0x1F7D },
+    { 0x1F80, 0x1FB4 }, { 0x1FB6, 0x1FBC }, { 0x1FC2, 0x1FC4 },
+    { 0x1FC6, 0x1FCC }, { 0x1FD0, 0x1FD3 }, { 0x1FD6, 0x1FDB },
+    { 0x1FE0, 0x1FEC }, { 0x1FF2, 0x1FF4 }, { 0x1FF6, 0x1FFC },
+    { 0x2C60, 0x2C7F }, { 0x2DE0, 0x2DFF },                      // Latin Extended-C, Cyrillic Extended-A
+    { 0xA640, 0xA66F }, { 0xA674, 0xA67D }, { 0xA67F, 0xA69F },  // Cyrillic Extended-B
+    { 0xA722, 0xA788 }, { 0xA78B, 0xA7FF },                      // Latin Extended-D
+    { 0xFB00, 0xFB06 },                                          // Latin ligatures
+};
+
+BOOL Tokenizer_IsWideLetter(WCHAR c) {
+    int lo = 0, hi = (int)(sizeof(g_wideLetters) / sizeof(g_wideLetters[0])) - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (c < g_wideLetters[mid][0]) {
+            hi = mid - 1;
+        } else if (c > g_wideLetters[mid][1]) {
+            lo = mid + 1;
+        } else {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+WCHAR Tokenizer_FoldW(WCHAR c) {
+    if (c < 0x80) return (c >= 'A' && c <= 'Z') ? (WCHAR)(c + 0x20) : c;
+    if (c < 0x0100) return (c >= 0x00C0 && c <= 0x00DE && c != 0x00D7) ? (WCHAR)(c + 0x20) : c;
+    
+    // Latin Extended-A pairs: even upper in most blocks, odd upper in two.
+    // U+0130 (dotted I) folds to ASCII 'i', a length change, so it stays.
+    if (c < 0x0180) {
+        if ((c < 0x0138 && c != 0x0130) || (c >= 0x014A && c < 0x0178)) return (c & 1) ? c : (WCHAR)(c + 1);
+        if ((c >= 0x0139 && c < 0x0149) || (c >= 0x0179 && c < 0x017F)) return (c & 1) ? (WCHAR)(c + 1) : c;
+        return c == 0x0178 ? 0x00FF : c;
+    }
+    
+    // Latin Extended-B: the DŽ/LJ/NJ/DZ digraphs (capital and title case fold
+    // to the lowercase form), odd-upper pinyin vowels, then even-upper pairs.
+    // The unpaired letters below U+01C4 are left as they are.
+    if (c >= 0x01C4 && c < 0x0234) {
+        if (c < 0x01CD) return (c - 0x01C4) % 3 == 2 ? c : (WCHAR)(c + 2 - (c - 0x01C4) % 3);
+        if (c < 0x01DD) return (c & 1) ? (WCHAR)(c + 1) : c;
+        if ((c >= 0x01DE && c < 0x01F0) || (c >= 0x01F4 && c < 0x01F6) ||
+            (c >= 0x01F8 && c < 0x0220) || c >= 0x0222) return (c & 1) ? c : (WCHAR)(c + 1);
+        if (c == 0x01F1 || c == 0x01F2) return 0x01F3;
+        return c;
+    }
+    
+    if (c >= 0x0386 && c <= 0x03AB) {                            // Greek
+        if (c >= 0x0391 && c != 0x03A2) return (WCHAR)(c + 0x20);
+        if (c == 0x0386) return 0x03AC;
+        if (c >= 0x0388 && c <= 0x038A) return (WCHAR)(c + 0x25);
+        if (c == 0x038C) return 0x03CC;
+        if (c == 0x038E || c == 0x038F) return (WCHAR)(c + 0x3F);
+        return c;
+    }
+    
+    if (c >= 0x0400 && c < 0x0530) {                             // Cyrillic
+        if (c < 0x0410) return (WCHAR)(c + 0x50);
+        if (c < 0x0430) return (WCHAR)(c + 0x20);
+        if ((c >= 0x0460 && c < 0x0482) || (c >= 0x048A && c < 0x04C0) || c >= 0x04D0) {
+            return (c & 1) ? c : (WCHAR)(c + 1);
+        }
+        if (c == 0x04C0) return 0x04CF;
+        if (c > 0x04C0 && c < 0x04CF) return (c & 1) ? (WCHAR)(c + 1) : c;
+        return c;
+    }
+    
+    if (c >= 0x0531 && c <= 0x0556) return (WCHAR)(c + 0x30);    // Armenian
+    
+    // Latin Extended Additional, even upper (U+1E9E, capital sharp s, folds
+    // to a two-byte character and stays)
+    if ((c >= 0x1E00 && c < 0x1E96) || (c >= 0x1EA0 && c < 0x1F00)) return (c & 1) ? c : (WCHAR)(c + 1);
+    return c;
+}
+
+void Tokenizer_FoldUtf8(const char *in, DWORD len, char *out) {
+    const unsigned char *p = (const unsigned char *)in;
+    DWORD i = 0;
+    while (i < len) {
+        unsigned char b = p[i];
+        if (b < 0x80) {
+            out[i] = (char)((b >= 'A' && b <= 'Z') ? b + 0x20 : b);
+            i++;
+        } else if ((b & 0xE0) == 0xC0 && i + 1 < len && (p[i + 1] & 0xC0) == 0x80) {
+            WCHAR c = (WCHAR)(((b & 0x1F) << 6) | (p[i + 1] & 0x3F));
+            WCHAR folded = c >= 0x80 ? Tokenizer_FoldW(c) : c;  // Overlong forms stay as they are
+            out[i] = (char)(0xC0 | (folded >> 6));
+            out[i + 1] = (char)(0x80 | (folded & 0x3F));
+            i += 2;
+        } else if ((b & 0xF0) == 0xE0 && i + 2 < len && (p[i + 1] & 0xC0) == 0x80 && (p[i + 2] & 0xC0) == 0x80) {
+            WCHAR c = (WCHAR)(((b & 0x0F) << 12) | ((p[i + 1] & 0x3F) << 6) | (p[i + 2] & 0x3F));
+            WCHAR folded = c >= 0x800 ? Tokenizer_FoldW(c) : c;
+            out[i] = (char)(0xE0 | (folded >> 12));
+            out[i + 1] = (char)(0x80 | ((folded >> 6) & 0x3F));
+            out[i + 2] = (char)(0x80 | (folded & 0x3F));
+            i += 3;
+        } else {
+            out[i] = (char)b;
+            i++;
+        }
+    }
+}
+
+DWORD Tokenizer_ToUtf8(const WCHAR *text, DWORD len, BOOL fold, char *out, DWORD outSize) {
+    DWORD used = 0;
+    for (DWORD i = 0; i < len; i++) {
+        WCHAR c = fold ? Tokenizer_FoldW(text[i]) : text[i];
+        if (c < 0x80) {
+            if (used + 1 > outSize) return 0;
+            out[used++] = (char)c;
+        } else if (c < 0x800) {
+            if (used + 2 > outSize) return 0;
+            out[used++] = (char)(0xC0 | (c >> 6));
+            out[used++] = (char)(0x80 | (c & 0x3F));
+        } else {
+            // Words never hold surrogates, so each unit is one character
+            if (used + 3 > outSize) return 0;
+            out[used++] = (char)(0xE0 | (c >> 12));
+            out[used++] = (char)(0x80 | ((c >> 6) & 0x3F));
+            out[used++] = (char)(0x80 | (c & 0x3F));
+        }
+    }
+    return used;
+}
+
+int Tokenizer_FindWordsW(const WCHAR *text, DWORD len, TokenSpan *spans, int maxSpans, DWORD *scanned) {
+    DWORD ignored;
+    if (!scanned) scanned = &ignored;
+    *scanned = 0;
+    if (!text || !spans || maxSpans <= 0) return 0;
+    
+    int count = 0;
+    BOOL inWord = FALSE;
+    DWORD wordStart = 0;
+    for (DWORD pos = 0; pos < len; pos++) {
+        BOOL letter = Tokenizer_IsLetterW(text[pos]);
+        if (letter && !inWord) {
+            if (count >= maxSpans) {
+                *scanned = pos;
+                return count;
+            }
+            wordStart = pos;
+            inWord = TRUE;
+        } else if (!letter && inWord) {
+            spans[count].start = wordStart;
+            spans[count].length = pos - wordStart;
+            count++;
+            inWord = FALSE;
+        }
+    }
+    
+    if (inWord) {
+        spans[count].start = wordStart;
+        spans[count].length = len - wordStart;
+        count++;
+    }
+    *scanned = len;
+    return count;
+}
@@ -0,0 +1,71 @@
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <windows.h>
+
+// Word boundary scanner for the spell checker. Words are runs of ASCII
+// letters, matching isalpha() in the "C" locale the checker always used.
+// Bytes are classified 16 (SSE2) or 32 (AVX2) at a time into letter masks;
+// the variant is picked once from CPUID, with a scalar loop for other CPUs.
+//
+// The UTF-16 scanner (Tokenizer_FindWordsW) takes text straight from a
+// Unicode edit control. Its words are runs of letters from a range table
+// of the alphabetic scripts plus combining marks, so accented names stay
+// one word whether precomposed or not.
+
+typedef struct {
+    DWORD start;    // Offset from the start of the scanned buffer
+    DWORD length;
+} TokenSpan;
+
+typedef enum {
+    TOKENIZER_SCALAR,
+    TOKENIZER_SSE2,
+    TOKENIZER_AVX2
+} TokenizerKind;
+
+// Pick the best variant for this CPU; idempotent. Call before starting
+// threads that tokenize (Tokenizer_FindWords also does it lazily).
+void Tokenizer_Init(void);
+
+TokenizerKind Tokenizer_GetKind(void);
+
+// Force a variant (for benchmarks); FALSE if the CPU lacks it
+BOOL Tokenizer_SetKind(TokenizerKind kind);
+
+// Find the words in text[0, len). Writes at most maxSpans spans and returns
+// how many; *scanned is where scanning stopped, so a full spans array is
+// resumed by calling again at text + *scanned. A word running into len is
+// reported up to len.
+int Tokenizer_FindWords(const char *text, DWORD len, TokenSpan *spans, int maxSpans, DWORD *scanned);
+
+// Tokenizer_FindWords over UTF-16; offsets and lengths count WCHARs,
+// matching edit control character indexes
+int Tokenizer_FindWordsW(const WCHAR *text, DWORD len, TokenSpan *spans, int maxSpans, DWORD *scanned);
+
+// Letter test for characters outside ASCII
+BOOL Tokenizer_IsWideLetter(WCHAR c);
+
+// Simple lowercase mapping for the scripts Tokenizer_IsWideLetter covers.
+// Only pairs whose UTF-8 forms have the same length are mapped, so folding
+// UTF-8 never changes its length.
+WCHAR Tokenizer_FoldW(WCHAR c);
+
+// Lowercase UTF-8 from in[0, len) into out (same length; may equal in).
+// Bytes that don't decode are copied unchanged.
+void Tokenizer_FoldUtf8(const char *in, DWORD len, char *out);
+
+// UTF-8 for text[0, len), lowercased with Tokenizer_FoldW when fold is
+// set. Returns the bytes written, or 0 if they don't fit in outSize;
+// 3 * len bytes always do.
+DWORD Tokenizer_ToUtf8(const WCHAR *text, DWORD len, BOOL fold, char *out, DWORD outSize);
+
+static __inline BOOL Tokenizer_IsLetter(char c) {
+    return (unsigned char)((c | 0x20) - 'a') < 26;
+}
+
+static __inline BOOL Tokenizer_IsLetterW(WCHAR c) {
+    return c < 0x80 ? Tokenizer_IsLetter((char)c) : Tokenizer_IsWideLetter(c);
+}
+
+#endif // TOKENIZER_H
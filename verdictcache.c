@@ -0,0 +1,50 @@
+#include "verdictcache.h"
+#include <string.h>
+
+static __inline unsigned char FoldCase(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') ? (unsigned char)(c + ('a' - 'A')) : c;
+}
+
+DWORD VerdictCache_Hash(const char *word, size_t len) {
+    DWORD hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= FoldCase((unsigned char)word[i]);
+        hash *= 16777619u;
+    }
+    return hash ? hash : 1;
+}
+
+static BOOL KeyMatches(const VerdictCacheEntry *entry, const char *word, size_t len) {
+    if (entry->len != len) return FALSE;
+    for (size_t i = 0; i < len; i++) {
+        if ((unsigned char)entry->key[i] != FoldCase((unsigned char)word[i])) return FALSE;
+    }
+    return TRUE;
+}
+
+BOOL VerdictCache_Find(VerdictCache *cache, const char *word, size_t len, DWORD hash, BOOL *correct) {
+    const VerdictCacheEntry *entry = &cache->entries[hash & (VERDICT_CACHE_SIZE - 1)];
+    if (len <= VERDICT_CACHE_KEY_MAX && entry->hash == hash && KeyMatches(entry, word, len)) {
+        cache->hits++;
+        *correct = entry->correct;
+        return TRUE;
+    }
+    cache->misses++;
+    return FALSE;
+}
+
+void VerdictCache_Store(VerdictCache *cache, const char *word, size_t len, DWORD hash, BOOL correct) {
+    if (len == 0 || len > VERDICT_CACHE_KEY_MAX) return;
+    
+    VerdictCacheEntry *entry = &cache->entries[hash & (VERDICT_CACHE_SIZE - 1)];
+    entry->hash = hash;
+    entry->len = (BYTE)len;
+    entry->correct = correct ? 1 : 0;
+    for (size_t i = 0; i < len; i++) {
+        entry->key[i] = (char)FoldCase((unsigned char)word[i]);
+    }
+}
+
+void VerdictCache_Clear(VerdictCache *cache) {
+    memset(cache->entries, 0, sizeof(cache->entries));
+}
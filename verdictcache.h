@@ -0,0 +1,38 @@
+#ifndef VERDICTCACHE_H
+#define VERDICTCACHE_H
+
+#include <windows.h>
+
+#define VERDICT_CACHE_SIZE 1024     // Slots; a power of two
+#define VERDICT_CACHE_KEY_MAX 26    // Longer words are always looked up
+
+// One 32-byte slot: the lowercased word is kept so a hash collision can
+// never return another word's verdict
+typedef struct {
+    DWORD hash;          // 0 = empty
+    BYTE len;
+    BYTE correct;
+    char key[VERDICT_CACHE_KEY_MAX];
+} VerdictCacheEntry;
+
+// Direct-mapped memo of recent IsWordCorrect answers. A colliding word just
+// replaces the slot. No lock of its own; SpellChecker serializes access.
+typedef struct {
+    VerdictCacheEntry entries[VERDICT_CACHE_SIZE];
+    DWORD hits;
+    DWORD misses;
+    DWORD version;       // Owner's word-list version the verdicts were given for
+} VerdictCache;
+
+// Hash of the lowercased first len bytes of word (never 0)
+DWORD VerdictCache_Hash(const char *word, size_t len);
+
+// Cached verdict for word/hash: TRUE with *correct set on a hit
+BOOL VerdictCache_Find(VerdictCache *cache, const char *word, size_t len, DWORD hash, BOOL *correct);
+
+void VerdictCache_Store(VerdictCache *cache, const char *word, size_t len, DWORD hash, BOOL correct);
+
+// Forget every verdict (the word lists changed); counters are kept
+void VerdictCache_Clear(VerdictCache *cache);
+
+#endif // VERDICTCACHE_H
@@ -0,0 +1,157 @@
+#include "wordtable.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define WORDTABLE_MIN_CAPACITY 256
+
+// ASCII lowercase table so hashing and comparison avoid per-byte tolower calls
+static unsigned char g_lowerTable[256];
+static BOOL g_lowerTableReady = FALSE;
+
+static void InitLowerTable(void) {
+    if (g_lowerTableReady) return;
+    for (int i = 0; i < 256; i++) {
+        g_lowerTable[i] = (i >= 'A' && i <= 'Z') ? (unsigned char)(i + ('a' - 'A')) : (unsigned char)i;
+    }
+    g_lowerTableReady = TRUE;
+}
+
+// FNV-1a over the lowercased bytes; never returns 0 (reserved for empty slots)
+static DWORD HashLower(const char *word, size_t len) {
+    DWORD hash = 2166136261u;
+    const unsigned char *p = (const unsigned char *)word;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= g_lowerTable[p[i]];
+        hash *= 16777619u;
+    }
+    return hash ? hash : 1;
+}
+
+// Compare a stored lowercase key against len bytes of a word of any case
+static BOOL KeyEquals(const char *key, const char *word, size_t len) {
+    const unsigned char *k = (const unsigned char *)key;
+    const unsigned char *w = (const unsigned char *)word;
+    for (size_t i = 0; i < len; i++) {
+        if (k[i] != g_lowerTable[w[i]]) return FALSE;
+    }
+    return k[len] == '\0';
+}
+
+// Locate the slot holding word, or the empty slot where it would go
+static WordTableEntry *FindSlot(WordTableEntry *entries, DWORD capacity, DWORD hash, const char *word, size_t len) {
+    DWORD mask = capacity - 1;
+    DWORD i = hash & mask;
+    while (entries[i].hash != 0) {
+        if (entries[i].hash == hash && KeyEquals(entries[i].key, word, len)) {
+            return &entries[i];
+        }
+        i = (i + 1) & mask;
+    }
+    return &entries[i];
+}
+
+// Rehash into newCapacity slots; stored hashes are reused so no key is rehashed
+static BOOL Resize(WordTable *table, DWORD newCapacity) {
+    WordTableEntry *newEntries = (WordTableEntry *)calloc(newCapacity, sizeof(WordTableEntry));
+    if (!newEntries) return FALSE;
+    
+    DWORD mask = newCapacity - 1;
+    for (DWORD i = 0; i < table->capacity; i++) {
+        WordTableEntry *e = &table->entries[i];
+        if (e->hash == 0) continue;
+        DWORD j = e->hash & mask;
+        while (newEntries[j].hash != 0) {
+            j = (j + 1) & mask;
+        }
+        newEntries[j] = *e;
+    }
+    
+    free(table->entries);
+    table->entries = newEntries;
+    table->capacity = newCapacity;
+    return TRUE;
+}
+
+BOOL WordTable_Init(WordTable *table, DWORD initialCapacity) {
+    if (!table) return FALSE;
+    InitLowerTable();
+    
+    DWORD capacity = WORDTABLE_MIN_CAPACITY;
+    while (capacity < initialCapacity) capacity *= 2;
+    
+    table->entries = (WordTableEntry *)calloc(capacity, sizeof(WordTableEntry));
+    table->capacity = table->entries ? capacity : 0;
+    table->count = 0;
+    return table->entries != NULL;
+}
+
+void WordTable_Free(WordTable *table) {
+    if (!table || !table->entries) return;
+    free(table->entries);
+    table->entries = NULL;
+    table->capacity = 0;
+    table->count = 0;
+}
+
+BOOL WordTable_Reserve(WordTable *table, DWORD count) {
+    if (!table || !table->entries) return FALSE;
+    
+    DWORD capacity = table->capacity;
+    while ((table->count + count) * 10 > capacity * 7) capacity *= 2;
+    return capacity == table->capacity || Resize(table, capacity);
+}
+
+DWORD WordTable_Hash(const char *word) {
+    InitLowerTable();
+    return HashLower(word, strlen(word));
+}
+
+DWORD WordTable_HashView(const char *word, size_t len) {
+    InitLowerTable();
+    return HashLower(word, len);
+}
+
+BOOL WordTable_KeyEquals(const char *key, const char *word, size_t len) {
+    return KeyEquals(key, word, len);
+}
+
+BOOL WordTable_Add(WordTable *table, const char *key, DWORD tag) {
+    if (!table || !table->entries || !key || !*key) return FALSE;
+    return WordTable_AddHashed(table, key, HashLower(key, strlen(key)), tag);
+}
+
+BOOL WordTable_AddHashed(WordTable *table, const char *key, DWORD hash, DWORD tag) {
+    if (!table || !table->entries || !key || !*key || hash == 0) return FALSE;
+    
+    // Keep load factor under 70% so probe chains stay short
+    if ((table->count + 1) * 10 > table->capacity * 7) {
+        if (!Resize(table, table->capacity * 2)) return FALSE;
+    }
+    
+    WordTableEntry *slot = FindSlot(table->entries, table->capacity, hash, key, strlen(key));
+    if (slot->hash != 0) {
+        slot->tags |= tag;
+        return TRUE;
+    }
+    
+    slot->hash = hash;
+    slot->tags = tag;
+    slot->key = key;
+    table->count++;
+    return TRUE;
+}
+
+DWORD WordTable_Lookup(const WordTable *table, const char *word, size_t len) {
+    if (!table || !table->entries || !word || len == 0) return 0;
+    
+    DWORD hash = HashLower(word, len);
+    WordTableEntry *slot = FindSlot(table->entries, table->capacity, hash, word, len);
+    return slot->hash != 0 ? slot->tags : 0;
+}
+
+void WordTable_ClearTag(WordTable *table, DWORD tag) {
+    if (!table || !table->entries) return;
+    for (DWORD i = 0; i < table->capacity; i++) {
+        table->entries[i].tags &= ~tag;
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef WORDTABLE_H
+#define WORDTABLE_H
+
+#include <windows.h>
+
+// List tags stored on each entry so a single probe answers
+// "is this word in any of the dictionaries"
+#define DICT_TAG_MAIN    0x01
+#define DICT_TAG_USER    0x02
+#define DICT_TAG_IGNORED 0x04
+
+typedef struct {
+    DWORD hash;     // Precomputed hash of the lowercased key (0 = empty slot)
+    DWORD tags;     // Bitmask of DICT_TAG_* lists containing the word
+    const char *key; // Lowercased word, owned by the caller
+} WordTableEntry;
+
+// Open-addressing (linear probing) hash set keyed on lowercased words
+typedef struct {
+    WordTableEntry *entries;
+    DWORD capacity; // Always a power of two
+    DWORD count;
+} WordTable;
+
+BOOL WordTable_Init(WordTable *table, DWORD initialCapacity);
+void WordTable_Free(WordTable *table);
+
+// Add a lowercased key under the given tag. The table stores the pointer,
+// so the key must outlive it. Returns FALSE only on allocation failure.
+BOOL WordTable_Add(WordTable *table, const char *key, DWORD tag);
+
+// Same as WordTable_Add with a hash from WordTable_Hash (e.g. stored in a
+// compiled dictionary), skipping the hashing pass
+BOOL WordTable_AddHashed(WordTable *table, const char *key, DWORD hash, DWORD tag);
+
+// Make room for count more keys so the next count adds cannot fail
+BOOL WordTable_Reserve(WordTable *table, DWORD count);
+
+// Hash used for keys; stable across runs so it may be persisted
+DWORD WordTable_Hash(const char *word);
+
+// WordTable_Hash of the first len bytes of word, folded as a lookup folds
+// them, and the matching key comparison; for tables stored elsewhere (e.g.
+// in a compiled dictionary)
+DWORD WordTable_HashView(const char *word, size_t len);
+BOOL WordTable_KeyEquals(const char *key, const char *word, size_t len);
+
+// Tags of the lists containing the first len bytes of word (case-insensitive),
+// 0 if none. word need not be NUL-terminated, so callers can pass a view
+// into a larger buffer.
+DWORD WordTable_Lookup(const WordTable *table, const char *word, size_t len);
+
+// Remove a tag from every entry (e.g. when the ignore list is cleared)
+void WordTable_ClearTag(WordTable *table, DWORD tag);
+
+#endif // WORDTABLE_H